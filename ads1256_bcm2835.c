@@ -0,0 +1,154 @@
+/*
+ * ads1256_bcm2835.c:
+ *	ADS1256 transport for the Waveshare High-Precision AD/DA board on the Raspberry Pi,
+ *	using the bcm2835 library for SPI and GPIO
+ *
+ */
+
+#ifndef ADS1256_NO_BCM2835
+
+#include <bcm2835.h>
+#include "ads1256_transport.h"
+
+//CS      -----   SPICS
+//DIN     -----   MOSI
+//DOUT  -----   MISO
+//SCLK   -----   SCLK
+//DRDY  -----   ctl_IO     data  starting
+//RST     -----   ctl_IO     reset
+//DAC CS  -----   ctl_IO     DAC8552 SYNC
+
+#define  DRDY  RPI_GPIO_P1_11         //P0
+#define  RST  RPI_GPIO_P1_12     //P1
+#define	SPICS	RPI_GPIO_P1_15	//P3
+#define	DACCS	RPI_GPIO_P1_16	//P4
+
+static int s_Users;		/* Boards opened: the library is closed with the last one */
+
+#ifndef BCM2835_CORE_CLK_HZ
+#define BCM2835_CORE_CLK_HZ	250000000	/* SPI0 is clocked from the 250 MHz core clock */
+#endif
+
+/*
+*********************************************************************************************************
+*	name: Bcm2835_Init
+*	function: Open the bcm2835 library and the SPI interface for the first board, then configure
+*			  the CS and DRDY pins of this one
+*	parameter: _cs : CS pin, an RPI_GPIO_P1_xx / BCM GPIO number
+*			   _drdy : DRDY pin
+*	The return value: 0 ok, 1 bcm2835_init failed (not running as root?)
+*********************************************************************************************************
+*/
+static int Bcm2835_Init(int _cs, int _drdy)
+{
+	if (s_Users == 0)
+	{
+		if (!bcm2835_init())
+		{
+			return 1;
+		}
+
+		bcm2835_spi_begin();
+		bcm2835_spi_setBitOrder(BCM2835_SPI_BIT_ORDER_LSBFIRST );     // The default
+		bcm2835_spi_setDataMode(BCM2835_SPI_MODE1);                   // The default
+		bcm2835_spi_setClockDivider(BCM2835_SPI_CLOCK_DIVIDER_1024);  // The default
+	}
+	s_Users++;
+
+	bcm2835_gpio_fsel(_cs, BCM2835_GPIO_FSEL_OUTP);//
+	bcm2835_gpio_write(_cs, HIGH);
+	bcm2835_gpio_fsel(_drdy, BCM2835_GPIO_FSEL_INPT);
+	bcm2835_gpio_set_pud(_drdy, BCM2835_GPIO_PUD_UP);
+	return 0;
+}
+
+static void Bcm2835_Close(int _cs, int _drdy)
+{
+	(void)_drdy;
+
+	bcm2835_gpio_write(_cs, HIGH);	/* Leave the board off the bus */
+	if (--s_Users == 0)
+	{
+		bcm2835_spi_end();
+		bcm2835_close();
+	}
+}
+
+/*
+*********************************************************************************************************
+*	name: Bcm2835_SetClock
+*	function: Program the SPI0 clock divider. The divider must be even; it is rounded up so that
+*			  SCLK never exceeds the requested frequency.
+*	parameter: _hz : highest acceptable SCLK frequency
+*	The return value: SCLK frequency actually set, Hz
+*********************************************************************************************************
+*/
+static uint32_t Bcm2835_SetClock(uint32_t _hz)
+{
+	uint32_t div;
+
+	div = (BCM2835_CORE_CLK_HZ + _hz - 1) / _hz;
+	div = (div + 1) & ~1u;
+	if (div < 2)
+	{
+		div = 2;
+	}
+	if (div > 65536)
+	{
+		div = 65536;	/* Written as 0 to the CDIV register */
+	}
+
+	bcm2835_spi_setClockDivider((uint16_t)div);
+	return BCM2835_CORE_CLK_HZ / div;
+}
+
+static uint8_t Bcm2835_Transfer(uint8_t _data)
+{
+	return bcm2835_spi_transfer(_data);
+}
+
+static void Bcm2835_Transfern(uint8_t *_buf, uint32_t _len)
+{
+	bcm2835_spi_transfern((char *)_buf, _len);
+}
+
+static void Bcm2835_SetCS(int _pin, uint8_t _level)
+{
+	bcm2835_gpio_write(_pin, _level ? HIGH : LOW);
+}
+
+static void Bcm2835_SetupCS(int _pin)
+{
+	bcm2835_gpio_fsel(_pin, BCM2835_GPIO_FSEL_OUTP);
+	bcm2835_gpio_write(_pin, HIGH);
+}
+
+static uint8_t Bcm2835_DrdyLevel(int _pin)
+{
+	return bcm2835_gpio_lev(_pin);
+}
+
+static void Bcm2835_DelayUS(uint64_t _micros)
+{
+	bcm2835_delayMicroseconds(_micros);
+}
+
+const ADS1256_TRANSPORT_T g_tTransportBcm2835 =
+{
+	"bcm2835",
+	SPICS,
+	DRDY,
+	1,			/* bcm2835 pin numbers are the BCM GPIO line offsets */
+	DACCS,
+	Bcm2835_Init,
+	Bcm2835_Close,
+	Bcm2835_SetClock,
+	Bcm2835_Transfer,
+	Bcm2835_Transfern,
+	Bcm2835_SetCS,
+	Bcm2835_SetupCS,
+	Bcm2835_DrdyLevel,
+	Bcm2835_DelayUS,
+};
+
+#endif
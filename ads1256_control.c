@@ -0,0 +1,288 @@
+/*
+ * ads1256_control.c:
+ *	Control loop of the acquisition thread: a PID or a difference equation given by its
+ *	coefficients, from the error of one scan list entry to a DAC code. The thread never waits
+ *	on the caller: new parameters are taken with a trylock on the next value that gets it,
+ *	the setpoint is a single atomic store.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include "ads1256_control.h"
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_ControlCheck
+*	function: Check a set of parameters: finite values, the output limits within the DAC codes
+*			  and at most ADS1256_CONTROL_ORDER_MAX + 1 coefficients B, ADS1256_CONTROL_ORDER_MAX A
+*	parameter: _param : parameters
+*	The return value: 0 ok, EINVAL
+*********************************************************************************************************
+*/
+int ADS1256_ControlCheck(const ADS1256_CONTROL_PARAM_T *_param)
+{
+	uint8_t k;
+
+	if ((_param->NB > ADS1256_CONTROL_ORDER_MAX + 1) || (_param->NA > ADS1256_CONTROL_ORDER_MAX))
+	{
+		return EINVAL;
+	}
+	if (!isfinite(_param->Kp) || !isfinite(_param->Ki) || !isfinite(_param->Kd) || !isfinite(_param->Bias))
+	{
+		return EINVAL;
+	}
+	for (k = 0; k < _param->NB; k++)
+	{
+		if (!isfinite(_param->B[k]))
+		{
+			return EINVAL;
+		}
+	}
+	for (k = 1; k <= _param->NA; k++)
+	{
+		if (!isfinite(_param->A[k]))
+		{
+			return EINVAL;
+		}
+	}
+	if (!(_param->OutMin >= 0) || !(_param->OutMax <= 65535) || !(_param->OutMin <= _param->OutMax))
+	{
+		return EINVAL;
+	}
+	return 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_ControlInit
+*	function: Set up the loop. _c must be zeroed or previously initialised; the old setup is freed.
+*	parameter: _c : control loop
+*			   _kind : ADS1256_CONTROL_*, NONE turns it off
+*			   _entry : scan list entry measured
+*			   _channel : ADS1256_DAC_A or _B
+*			   _setpoint : counts
+*			   _param : gains or coefficients and the output limits
+*	The return value: 0 ok, EINVAL
+*********************************************************************************************************
+*/
+int ADS1256_ControlInit(ADS1256_CONTROL_T *_c, uint8_t _kind, uint8_t _entry, uint8_t _channel, int32_t _setpoint,
+						const ADS1256_CONTROL_PARAM_T *_param)
+{
+	ADS1256_ControlFree(_c);
+
+	if (_kind == ADS1256_CONTROL_NONE)
+	{
+		return 0;
+	}
+	if ((_kind > ADS1256_CONTROL_FILTER) || ((_channel != ADS1256_DAC_A) && (_channel != ADS1256_DAC_B)))
+	{
+		return EINVAL;
+	}
+	if (ADS1256_ControlCheck(_param) != 0)
+	{
+		return EINVAL;
+	}
+	if (pthread_mutex_init(&_c->Lock, NULL) != 0)
+	{
+		return ENOMEM;
+	}
+	_c->HaveLock = 1;
+
+	_c->Kind = _kind;
+	_c->Entry = _entry;
+	_c->Channel = _channel;
+	_c->Setpoint = _setpoint;
+	_c->Param = *_param;
+	ADS1256_ControlReset(_c);
+	return 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_ControlReset
+*	function: Clear the state of the loop and its counters, and take pending parameters.
+*			  Called while the acquisition thread is stopped, when it starts.
+*	parameter: _c : control loop
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_ControlReset(ADS1256_CONTROL_T *_c)
+{
+	pthread_mutex_lock(&_c->Lock);
+	if (_c->Update)
+	{
+		_c->Param = _c->Pending;
+		_c->Update = 0;
+	}
+	pthread_mutex_unlock(&_c->Lock);
+
+	_c->Integral = 0;
+	_c->HavePrev = 0;
+	memset(_c->E, 0, sizeof(_c->E));
+	memset(_c->U, 0, sizeof(_c->U));
+	_c->Iterations = 0;
+	_c->Saturated = 0;
+	_c->Measured = 0;
+	_c->Error = 0;
+	_c->Output = 0;
+	_c->TimeNs = 0;
+	_c->LatencyNs = 0;
+	_c->LatencyMaxNs = 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_ControlFree
+*	function: Turn the loop off
+*	parameter: _c : control loop
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_ControlFree(ADS1256_CONTROL_T *_c)
+{
+	if (_c->HaveLock)
+	{
+		pthread_mutex_destroy(&_c->Lock);
+	}
+	memset(_c, 0, sizeof(*_c));
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_ControlSetpoint
+*	function: Change the setpoint, from any thread: the next value of the entry uses it
+*	parameter: _c : control loop
+*			   _setpoint : counts
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_ControlSetpoint(ADS1256_CONTROL_T *_c, int32_t _setpoint)
+{
+	__atomic_store_n(&_c->Setpoint, _setpoint, __ATOMIC_RELAXED);
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_ControlTune
+*	function: Change the parameters, from any thread. They are taken by the next value of the
+*			  entry; the state carries over, so the output does not jump with a new gain.
+*	parameter: _c : control loop
+*			   _param : parameters, checked with ADS1256_ControlCheck
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_ControlTune(ADS1256_CONTROL_T *_c, const ADS1256_CONTROL_PARAM_T *_param)
+{
+	pthread_mutex_lock(&_c->Lock);
+	_c->Pending = *_param;
+	_c->Update = 1;
+	pthread_mutex_unlock(&_c->Lock);
+}
+
+/* Limit _v to [_lo, _hi], counting it in Saturated when it had to be */
+static double Control_Clamp(ADS1256_CONTROL_T *_c, double _v, double _lo, double _hi)
+{
+	if (_v < _lo)
+	{
+		_c->Saturated++;
+		return _lo;
+	}
+	if (_v > _hi)
+	{
+		_c->Saturated++;
+		return _hi;
+	}
+	return _v;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_ControlRun
+*	function: One step of the loop on a new value of the entry.
+*			  PID: u = Bias + Kp e + Ki sum(e dt) - Kd dy/dt, with dt from the DRDY times, the
+*			  derivative on the measurement so that a setpoint step does not kick the output, and
+*			  the integral kept within the output limits (anti-windup).
+*			  Filter: u = Bias + sum(b[k] e[n-k]) - sum(a[k] (u[n-k] - Bias)), the past outputs
+*			  as they were written, limits applied.
+*	parameter: _c : control loop, not ADS1256_CONTROL_NONE
+*			   _value : value of the entry
+*			   _timeNs : its DRDY time
+*	The return value: DAC code to write
+*********************************************************************************************************
+*/
+uint16_t ADS1256_ControlRun(ADS1256_CONTROL_T *_c, int32_t _value, int64_t _timeNs)
+{
+	const ADS1256_CONTROL_PARAM_T *p = &_c->Param;
+	double e, u, dt;
+	int k;
+
+	/* Never wait for the caller: if it holds the lock the next value takes the parameters */
+	if (_c->Update && (pthread_mutex_trylock(&_c->Lock) == 0))
+	{
+		_c->Param = _c->Pending;
+		_c->Update = 0;
+		pthread_mutex_unlock(&_c->Lock);
+	}
+
+	e = (double)__atomic_load_n(&_c->Setpoint, __ATOMIC_RELAXED) - _value;
+
+	if (_c->Kind == ADS1256_CONTROL_PID)
+	{
+		dt = _c->HavePrev ? (_timeNs - _c->PrevTimeNs) / 1e9 : 0;
+		_c->Integral += p->Ki * e * dt;
+		if (_c->Integral < p->OutMin - p->Bias)
+		{
+			_c->Integral = p->OutMin - p->Bias;
+		}
+		if (_c->Integral > p->OutMax - p->Bias)
+		{
+			_c->Integral = p->OutMax - p->Bias;
+		}
+
+		u = p->Bias + p->Kp * e + _c->Integral;
+		if (dt > 0)
+		{
+			u -= p->Kd * ((double)_value - _c->PrevMeas) / dt;
+		}
+		u = Control_Clamp(_c, u, p->OutMin, p->OutMax);
+
+		_c->PrevMeas = _value;
+		_c->PrevTimeNs = _timeNs;
+		_c->HavePrev = 1;
+	}
+	else
+	{
+		for (k = ADS1256_CONTROL_ORDER_MAX; k > 0; k--)
+		{
+			_c->E[k] = _c->E[k - 1];
+		}
+		_c->E[0] = e;
+
+		u = 0;
+		for (k = 0; k < p->NB; k++)
+		{
+			u += p->B[k] * _c->E[k];
+		}
+		for (k = 1; k <= p->NA; k++)
+		{
+			u -= p->A[k] * _c->U[k];
+		}
+		u = Control_Clamp(_c, u + p->Bias, p->OutMin, p->OutMax);
+
+		for (k = ADS1256_CONTROL_ORDER_MAX; k > 1; k--)
+		{
+			_c->U[k] = _c->U[k - 1];
+		}
+		_c->U[1] = u - p->Bias;
+	}
+
+	_c->Measured = _value;
+	_c->Error = (e > INT32_MAX) ? INT32_MAX : (e < INT32_MIN) ? INT32_MIN : (int32_t)e;
+	_c->Output = (uint16_t)lround(u);
+	_c->TimeNs = _timeNs;
+	_c->Iterations++;
+	return _c->Output;
+}
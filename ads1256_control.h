@@ -0,0 +1,57 @@
+/*
+ * ads1256_control.h:
+ *	Closed loop from one scan list entry to one DAC8552 output. The acquisition thread hands
+ *	every value of the entry to ADS1256_ControlRun and writes the code it returns to the DAC
+ *	right away, so the loop runs once per conversion of the entry without Python in it. The
+ *	setpoint and the parameters may change while it runs.
+ *
+ */
+
+#ifndef ADS1256_CONTROL_H
+#define ADS1256_CONTROL_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "wrapper.h"
+
+#define ADS1256_CONTROL_NONE	0
+#define ADS1256_CONTROL_PID		1		/* Kp, Ki, Kd; derivative on the measurement */
+#define ADS1256_CONTROL_FILTER	2		/* Difference equation on the error: B and A */
+
+typedef struct
+{
+	uint8_t Kind;				/* ADS1256_CONTROL_* */
+	uint8_t Entry;				/* Scan list entry measured */
+	uint8_t Channel;			/* ADS1256_DAC_A or _B driven */
+	volatile int32_t Setpoint;	/* Counts, stored by ADS1256_ControlSetpoint from any thread */
+	ADS1256_CONTROL_PARAM_T Param;		/* In use, only the acquisition thread changes it once started */
+	ADS1256_CONTROL_PARAM_T Pending;	/* Set by ADS1256_ControlTune under Lock ... */
+	volatile uint8_t Update;	/* ... and taken by the next ADS1256_ControlRun that gets Lock */
+	pthread_mutex_t Lock;
+	uint8_t HaveLock;			/* Lock was initialised */
+	double Integral;			/* PID: Ki part of the output, codes */
+	int32_t PrevMeas;			/* PID: last value of the entry ... */
+	int64_t PrevTimeNs;			/* ... and its DRDY time */
+	uint8_t HavePrev;			/* There was one since the reset */
+	double E[ADS1256_CONTROL_ORDER_MAX + 1];	/* Filter: last errors, E[0] the newest */
+	double U[ADS1256_CONTROL_ORDER_MAX + 1];	/* Filter: last outputs less Bias, U[1] the newest */
+	uint32_t Iterations;		/* Outputs written */
+	uint32_t Saturated;			/* Outputs held at OutMin or OutMax */
+	int32_t Measured;			/* Last value of the entry */
+	int32_t Error;				/* Last error, counts */
+	uint16_t Output;			/* Last code written */
+	int64_t TimeNs;				/* DRDY time of the last value */
+	int64_t LatencyNs;			/* DRDY to the DAC write of the last value ... */
+	int64_t LatencyMaxNs;		/* ... and the longest one */
+}ADS1256_CONTROL_T;
+
+int ADS1256_ControlInit(ADS1256_CONTROL_T *_c, uint8_t _kind, uint8_t _entry, uint8_t _channel, int32_t _setpoint,
+						const ADS1256_CONTROL_PARAM_T *_param);
+void ADS1256_ControlReset(ADS1256_CONTROL_T *_c);
+void ADS1256_ControlFree(ADS1256_CONTROL_T *_c);
+int ADS1256_ControlCheck(const ADS1256_CONTROL_PARAM_T *_param);
+void ADS1256_ControlSetpoint(ADS1256_CONTROL_T *_c, int32_t _setpoint);
+void ADS1256_ControlTune(ADS1256_CONTROL_T *_c, const ADS1256_CONTROL_PARAM_T *_param);
+uint16_t ADS1256_ControlRun(ADS1256_CONTROL_T *_c, int32_t _value, int64_t _timeNs);
+
+#endif
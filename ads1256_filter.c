@@ -0,0 +1,406 @@
+/*
+ * ads1256_filter.c:
+ *	Per-channel filters of the acquisition stream. Moving average and CIC work on integers
+ *	in O(1) and O(order) per input. FIR and IIR work in double precision. The FIR is only
+ *	evaluated when an output is due (polyphase decimation); its dot product is vectorised like
+ *	the volts kernels, the widest one the CPU supports is chosen on the first call.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include "ads1256_filter.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FILTER_X86
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define FILTER_NEON
+#endif
+
+typedef double (*FILTER_DOT_T)(const double *_a, const double *_b, uint32_t _n);
+
+static FILTER_DOT_T s_pfFilterDot;
+
+static double Filter_Dot_Scalar(const double *_a, const double *_b, uint32_t _n)
+{
+	double acc = 0;
+	uint32_t i;
+
+	for (i = 0; i < _n; i++)
+	{
+		acc += _a[i] * _b[i];
+	}
+	return acc;
+}
+
+#ifdef FILTER_X86
+__attribute__((target("sse2")))
+static double Filter_Dot_Sse2(const double *_a, const double *_b, uint32_t _n)
+{
+	__m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+	double lane[2];
+	uint32_t i;
+
+	for (i = 0; i + 4 <= _n; i += 4)
+	{
+		acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(_a + i), _mm_loadu_pd(_b + i)));
+		acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(_a + i + 2), _mm_loadu_pd(_b + i + 2)));
+	}
+	_mm_storeu_pd(lane, _mm_add_pd(acc0, acc1));
+	return lane[0] + lane[1] + Filter_Dot_Scalar(_a + i, _b + i, _n - i);
+}
+
+__attribute__((target("avx")))
+static double Filter_Dot_Avx(const double *_a, const double *_b, uint32_t _n)
+{
+	__m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+	double lane[4];
+	uint32_t i;
+
+	for (i = 0; i + 8 <= _n; i += 8)
+	{
+		acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(_a + i), _mm256_loadu_pd(_b + i)));
+		acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(_a + i + 4), _mm256_loadu_pd(_b + i + 4)));
+	}
+	_mm256_storeu_pd(lane, _mm256_add_pd(acc0, acc1));
+	return lane[0] + lane[1] + lane[2] + lane[3] + Filter_Dot_Scalar(_a + i, _b + i, _n - i);
+}
+#endif
+
+#ifdef FILTER_NEON
+/* 32 bit NEON has no double precision lanes, the scalar kernel is used there */
+static double Filter_Dot_Neon(const double *_a, const double *_b, uint32_t _n)
+{
+	float64x2_t acc0 = vdupq_n_f64(0), acc1 = vdupq_n_f64(0);
+	uint32_t i;
+
+	for (i = 0; i + 4 <= _n; i += 4)
+	{
+		acc0 = vfmaq_f64(acc0, vld1q_f64(_a + i), vld1q_f64(_b + i));
+		acc1 = vfmaq_f64(acc1, vld1q_f64(_a + i + 2), vld1q_f64(_b + i + 2));
+	}
+	return vaddvq_f64(vaddq_f64(acc0, acc1)) + Filter_Dot_Scalar(_a + i, _b + i, _n - i);
+}
+#endif
+
+/*
+*********************************************************************************************************
+*	name: Filter_Select
+*	function: Choose the dot product kernel for this CPU, once
+*	parameter: NULL
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+static void Filter_Select(void)
+{
+	FILTER_DOT_T dot = Filter_Dot_Scalar;
+
+	if (__atomic_load_n(&s_pfFilterDot, __ATOMIC_ACQUIRE) != 0)
+	{
+		return;
+	}
+
+#if defined(FILTER_X86)
+	if (__builtin_cpu_supports("avx"))
+	{
+		dot = Filter_Dot_Avx;
+	}
+	else if (__builtin_cpu_supports("sse2"))
+	{
+		dot = Filter_Dot_Sse2;
+	}
+#elif defined(FILTER_NEON)
+	dot = Filter_Dot_Neon;
+#endif
+
+	__atomic_store_n(&s_pfFilterDot, dot, __ATOMIC_RELEASE);
+}
+
+/*
+*********************************************************************************************************
+*	name: Filter_Output
+*	function: Round a filter result to a count, saturating to the int32 range
+*	parameter: _v : result
+*	The return value:  count
+*********************************************************************************************************
+*/
+static int32_t Filter_Output(double _v)
+{
+	if (!(_v > INT32_MIN + 1.0))	/* INT32_MIN is ADS1256_LOG_MISSING, NaN ends up here too */
+	{
+		return INT32_MIN + 1;
+	}
+	if (_v > INT32_MAX)
+	{
+		return INT32_MAX;
+	}
+	return (int32_t)lrint(_v);
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_FilterInit
+*	function: Set up a filter. _f must be zeroed or previously initialised; the old setup is freed.
+*	parameter: _f : filter
+*			   _kind : ADS1256_FILTER_*
+*			   _len : moving average window, CIC order, FIR taps or IIR sections
+*			   _decim : inputs per output, 1 to keep every input
+*			   _coef : FIR taps in the usual order (h[0] weighs the newest input), or b0 b1 b2 a1 a2
+*					   of each IIR section with a0 = 1. NULL for the other kinds.
+*	The return value: 0 ok, EINVAL, ENOMEM
+*********************************************************************************************************
+*/
+int ADS1256_FilterInit(ADS1256_FILTER_T *_f, uint8_t _kind, uint32_t _len, uint32_t _decim, const double *_coef)
+{
+	uint64_t gain = 1;
+	uint32_t i;
+
+	ADS1256_FilterFree(_f);
+
+	if ((_decim < 1) || (_decim > ADS1256_FILTER_DECIM_MAX))
+	{
+		return EINVAL;
+	}
+	switch (_kind)
+	{
+	case ADS1256_FILTER_NONE:
+		return 0;
+
+	case ADS1256_FILTER_MAVG:
+		if ((_len < 1) || (_len > ADS1256_FILTER_MAVG_MAX))
+		{
+			return EINVAL;
+		}
+		_f->Win = calloc(_len, sizeof(int32_t));
+		if (_f->Win == NULL)
+		{
+			return ENOMEM;
+		}
+		break;
+
+	case ADS1256_FILTER_CIC:
+		if ((_len < 1) || (_len > ADS1256_FILTER_CIC_ORDER_MAX) || (_decim < 2))
+		{
+			return EINVAL;
+		}
+		/* 30 bit inputs (auto-ranged) times the gain Decim^Len must fit in 63 bits */
+		for (i = 0; i < _len; i++)
+		{
+			gain *= _decim;
+		}
+		if (gain > ((uint64_t)1 << 32))
+		{
+			return EINVAL;
+		}
+		break;
+
+	case ADS1256_FILTER_FIR:
+		if ((_len < 1) || (_len > ADS1256_FILTER_FIR_MAX) || (_coef == NULL))
+		{
+			return EINVAL;
+		}
+		_f->Coef = malloc(_len * sizeof(double));
+		_f->Hist = calloc(2 * _len, sizeof(double));
+		if ((_f->Coef == NULL) || (_f->Hist == NULL))
+		{
+			ADS1256_FilterFree(_f);
+			return ENOMEM;
+		}
+		for (i = 0; i < _len; i++)
+		{
+			_f->Coef[i] = _coef[_len - 1 - i];	/* Oldest input first, as in Hist */
+		}
+		break;
+
+	case ADS1256_FILTER_IIR:
+		if ((_len < 1) || (_len > ADS1256_FILTER_IIR_MAX) || (_coef == NULL))
+		{
+			return EINVAL;
+		}
+		_f->Coef = malloc(5 * _len * sizeof(double));
+		if (_f->Coef == NULL)
+		{
+			return ENOMEM;
+		}
+		memcpy(_f->Coef, _coef, 5 * _len * sizeof(double));
+		break;
+
+	default:
+		return EINVAL;
+	}
+
+	_f->Kind = _kind;
+	_f->Len = _len;
+	_f->Decim = _decim;
+	ADS1256_FilterReset(_f);
+	Filter_Select();
+	return 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_FilterReset
+*	function: Forget the past inputs, as before the first one. Called when an acquisition starts.
+*	parameter: _f : filter
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_FilterReset(ADS1256_FILTER_T *_f)
+{
+	_f->Sum = 0;
+	_f->Pos = 0;
+	_f->Phase = 0;
+	memset(_f->Integ, 0, sizeof(_f->Integ));
+	memset(_f->Comb, 0, sizeof(_f->Comb));
+	memset(_f->State, 0, sizeof(_f->State));
+
+	switch (_f->Kind)
+	{
+	case ADS1256_FILTER_MAVG:
+		memset(_f->Win, 0, _f->Len * sizeof(int32_t));
+		_f->Fill = _f->Len;
+		break;
+	case ADS1256_FILTER_CIC:
+		_f->Fill = _f->Len * _f->Decim;		/* The combs see Len outputs of garbage history */
+		break;
+	case ADS1256_FILTER_FIR:
+		memset(_f->Hist, 0, 2 * _f->Len * sizeof(double));
+		_f->Fill = _f->Len;
+		break;
+	default:
+		_f->Fill = 0;
+		break;
+	}
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_FilterFree
+*	function: Release the buffers of a filter and turn it off
+*	parameter: _f : filter
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_FilterFree(ADS1256_FILTER_T *_f)
+{
+	free(_f->Coef);
+	free(_f->Hist);
+	free(_f->Win);
+	memset(_f, 0, sizeof(*_f));
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_FilterRun
+*	function: Feed one input. Every Decim inputs, once the filter has seen enough inputs to fill
+*			  its memory, an output is produced.
+*	parameter: _f : filter, not ADS1256_FILTER_NONE
+*			   _in : result of the entry
+*			   _out : filtered result, rounded to counts, written when the return value is 1
+*	The return value:  1 if _out holds an output, 0 otherwise
+*********************************************************************************************************
+*/
+int ADS1256_FilterRun(ADS1256_FILTER_T *_f, int32_t _in, int32_t *_out)
+{
+	uint64_t v, prev;
+	double x, y, *c, *z;
+	uint32_t i;
+	int due;
+
+	if (++_f->Phase >= _f->Decim)
+	{
+		_f->Phase = 0;
+	}
+	due = (_f->Phase == 0);
+
+	switch (_f->Kind)
+	{
+	case ADS1256_FILTER_MAVG:
+		_f->Sum += (int64_t)_in - _f->Win[_f->Pos];
+		_f->Win[_f->Pos] = _in;
+		if (++_f->Pos >= _f->Len)
+		{
+			_f->Pos = 0;
+		}
+		if (due)
+		{
+			*_out = Filter_Output((double)_f->Sum / _f->Len);
+		}
+		break;
+
+	case ADS1256_FILTER_CIC:
+		/* Integrators at the input rate; unsigned so that the wrap around is defined */
+		v = (uint64_t)(int64_t)_in;
+		for (i = 0; i < _f->Len; i++)
+		{
+			_f->Integ[i] += v;
+			v = _f->Integ[i];
+		}
+		if (!due)
+		{
+			break;
+		}
+		/* Combs at the output rate, differential delay 1 */
+		for (i = 0; i < _f->Len; i++)
+		{
+			prev = _f->Comb[i];
+			_f->Comb[i] = v;
+			v -= prev;
+		}
+		y = (double)(int64_t)v;
+		for (i = 0; i < _f->Len; i++)
+		{
+			y /= _f->Decim;
+		}
+		*_out = Filter_Output(y);
+		break;
+
+	case ADS1256_FILTER_FIR:
+		/* Each input is stored at Pos and Pos + Len: Hist[Pos + 1 .. Pos + Len] are the last Len inputs */
+		_f->Hist[_f->Pos] = _f->Hist[_f->Pos + _f->Len] = _in;
+		if (due)
+		{
+			*_out = Filter_Output(s_pfFilterDot(_f->Coef, _f->Hist + _f->Pos + 1, _f->Len));
+		}
+		if (++_f->Pos >= _f->Len)
+		{
+			_f->Pos = 0;
+		}
+		break;
+
+	case ADS1256_FILTER_IIR:
+		/* Transposed direct form II, one section after the other */
+		x = _in;
+		c = _f->Coef;
+		z = _f->State;
+		for (i = 0; i < _f->Len; i++, c += 5, z += 2)
+		{
+			y = c[0] * x + z[0];
+			z[0] = c[1] * x - c[3] * y + z[1];
+			z[1] = c[2] * x - c[4] * y;
+			x = y;
+		}
+		if (due)
+		{
+			*_out = Filter_Output(x);
+		}
+		break;
+
+	default:
+		*_out = _in;
+		return 1;
+	}
+
+	if (_f->Fill > 0)
+	{
+		_f->Fill--;
+	}
+	return due && (_f->Fill == 0);
+}
@@ -0,0 +1,48 @@
+/*
+ * ads1256_filter.h:
+ *	Per-channel digital filters run by the acquisition thread on the stream of one scan list
+ *	entry: moving average, CIC decimator, FIR and IIR (cascaded biquads). Each filter keeps
+ *	one output every Decim inputs, so only the decimated stream reaches the ring and the logger.
+ *
+ */
+
+#ifndef ADS1256_FILTER_H
+#define ADS1256_FILTER_H
+
+#include <stdint.h>
+
+#define ADS1256_FILTER_NONE		0
+#define ADS1256_FILTER_MAVG		1		/* Moving average of Len inputs */
+#define ADS1256_FILTER_CIC		2		/* CIC decimator of order Len, rate change Decim */
+#define ADS1256_FILTER_FIR		3		/* Len taps */
+#define ADS1256_FILTER_IIR		4		/* Len biquad sections b0 b1 b2 a1 a2, a0 = 1 */
+
+#define ADS1256_FILTER_MAVG_MAX		65536
+#define ADS1256_FILTER_CIC_ORDER_MAX	5
+#define ADS1256_FILTER_FIR_MAX		1024
+#define ADS1256_FILTER_IIR_MAX		8
+#define ADS1256_FILTER_DECIM_MAX	65535
+
+typedef struct
+{
+	uint8_t Kind;				/* ADS1256_FILTER_* */
+	uint32_t Len;				/* Window, order, taps or sections, see Kind */
+	uint32_t Decim;				/* Inputs per output */
+	double *Coef;				/* FIR taps, oldest input first, or 5 values per IIR section */
+	double *Hist;				/* FIR: the last Len inputs, stored twice so that they are contiguous */
+	int32_t *Win;				/* Moving average window */
+	int64_t Sum;				/* Moving average: sum of Win */
+	uint64_t Integ[ADS1256_FILTER_CIC_ORDER_MAX];	/* CIC integrators, wrap around on purpose */
+	uint64_t Comb[ADS1256_FILTER_CIC_ORDER_MAX];	/* CIC comb delays */
+	double State[2 * ADS1256_FILTER_IIR_MAX];		/* IIR: z1, z2 of each section */
+	uint32_t Pos;				/* Next slot of Win / Hist */
+	uint32_t Phase;				/* Inputs since the last output */
+	uint32_t Fill;				/* Inputs still needed before the first valid output */
+}ADS1256_FILTER_T;
+
+int ADS1256_FilterInit(ADS1256_FILTER_T *_f, uint8_t _kind, uint32_t _len, uint32_t _decim, const double *_coef);
+void ADS1256_FilterReset(ADS1256_FILTER_T *_f);
+void ADS1256_FilterFree(ADS1256_FILTER_T *_f);
+int ADS1256_FilterRun(ADS1256_FILTER_T *_f, int32_t _in, int32_t *_out);
+
+#endif
@@ -0,0 +1,64 @@
+/*
+ * ads1256_log.h:
+ *	On-disk format of the binary capture files written by the native logger (log_start()).
+ *	A file is an ADS1256_LOG_HEADER_T padded with zeros to HeaderSize (one page), followed by
+ *	fixed-size records up to the end of the file. One record holds one pass over the scan list:
+ *
+ *		int64_t TimeNs[ScanLength];		DRDY falling edge of each conversion, CLOCK_MONOTONIC_RAW
+ *		int32_t Value[ScanLength];		signed 24 bit results, at ValuesOffset
+ *		padding to RecordSize (a multiple of 8)
+ *
+ *	Slot k of a record belongs to the scan list entry obtained by expanding the Scan[] entries
+ *	by their Repeat counts, in order. The layout has no variable part, so a file can be mapped
+ *	and indexed directly: record i starts at HeaderSize + i * RecordSize. Conversions lost to
+ *	an overflow leave their slot at TimeNs 0 and Value ADS1256_LOG_MISSING. Values of an
+ *	auto-ranged entry are normalised to counts at 64x, whatever gain they were converted at.
+ *	Everything is stored in the byte order of the host that wrote it; ByteOrder tells a
+ *	reader on another machine whether it must swap.
+ *
+ */
+
+#ifndef ADS1256_LOG_H
+#define ADS1256_LOG_H
+
+#include <stdint.h>
+
+#define ADS1256_LOG_MAGIC		"ADS1256L"
+#define ADS1256_LOG_VERSION		2
+#define ADS1256_LOG_BYTE_ORDER	0x01020304
+#define ADS1256_LOG_SCAN_MAX	16
+#define ADS1256_LOG_HEADER_SIZE	4096			/* Records start page aligned */
+#define ADS1256_LOG_MISSING		INT32_MIN		/* Never a 24 bit result */
+
+/* Bytes of a record of _len conversions */
+#define ADS1256_LOG_RECORD_SIZE(_len)	(((_len) * 12 + 7) & ~7u)
+
+typedef struct
+{
+	char Magic[8];				/* ADS1256_LOG_MAGIC, not NUL terminated */
+	uint32_t ByteOrder;			/* ADS1256_LOG_BYTE_ORDER */
+	uint16_t Version;			/* ADS1256_LOG_VERSION */
+	uint16_t HeaderSize;		/* Bytes before the first record, ADS1256_LOG_HEADER_SIZE, multiple of 8 */
+	uint32_t RecordSize;		/* ADS1256_LOG_RECORD_SIZE(ScanLength) */
+	uint16_t ScanLength;		/* Conversions per record: sum of the Repeat counts */
+	uint8_t Gain;				/* PGA code given to start(): 0 = 1x ... 6 = 64x */
+	uint8_t Drate;				/* DRATE register value */
+	uint32_t SclkHz;			/* SPI clock of the capture */
+	uint32_t FileIndex;			/* Position of this file in the rotation, from 0 */
+	int64_t TimeBaseRawNs;		/* CLOCK_MONOTONIC_RAW, the clock of the record timestamps ... */
+	int64_t TimeBaseRealNs;		/* ... and CLOCK_REALTIME read at the same moment */
+	float VrefVolts;			/* Reference voltage of the board */
+	uint8_t ScanCount;			/* Valid entries in Scan */
+	uint8_t Reserved1[3];
+	struct
+	{
+		uint8_t Mux;			/* MUX register, AINP << 4 | AINN, 8 = AINCOM */
+		uint8_t Gain;			/* PGA code, 0xFF = the Gain above, 0xFE = auto-ranged */
+		uint8_t Repeat;			/* Conversions per pass */
+		uint8_t Reserved;
+	}Scan[ADS1256_LOG_SCAN_MAX];
+	uint32_t ValuesOffset;		/* Offset of Value[] in a record: 8 * ScanLength */
+	uint32_t Reserved2;
+}ADS1256_LOG_HEADER_T;			/* 128 bytes, then zeros up to HeaderSize */
+
+#endif
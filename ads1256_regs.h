@@ -0,0 +1,48 @@
+/*
+ * ads1256_regs.h:
+ *	ADS1256 register map and command set, shared by the driver and the simulated chip
+ *
+ */
+
+#ifndef ADS1256_REGS_H
+#define ADS1256_REGS_H
+
+/*Register definition: Table 23. Register Map --- ADS1256 datasheet Page 30*/
+enum
+{
+	/*Register address, followed by reset the default values */
+	REG_STATUS = 0,	// x1H
+	REG_MUX    = 1, // 01H
+	REG_ADCON  = 2, // 20H
+	REG_DRATE  = 3, // F0H
+	REG_IO     = 4, // E0H
+	REG_OFC0   = 5, // xxH
+	REG_OFC1   = 6, // xxH
+	REG_OFC2   = 7, // xxH
+	REG_FSC0   = 8, // xxH
+	REG_FSC1   = 9, // xxH
+	REG_FSC2   = 10, // xxH
+
+	REG_COUNT
+};
+
+/* Command definition: Table 24. Command Definitions --- ADS1256 datasheet Page 34 */
+enum
+{
+	CMD_WAKEUP  = 0x00,	// Completes SYNC and Exits Standby Mode 0000  0000 (00h)
+	CMD_RDATA   = 0x01, // Read Data 0000  0001 (01h)
+	CMD_RDATAC  = 0x03, // Read Data Continuously 0000   0011 (03h)
+	CMD_SDATAC  = 0x0F, // Stop Read Data Continuously 0000   1111 (0Fh)
+	CMD_RREG    = 0x10, // Read from REG rrr 0001 rrrr (1xh)
+	CMD_WREG    = 0x50, // Write to REG rrr 0101 rrrr (5xh)
+	CMD_SELFCAL = 0xF0, // Offset and Gain Self-Calibration 1111    0000 (F0h)
+	CMD_SELFOCAL= 0xF1, // Offset Self-Calibration 1111    0001 (F1h)
+	CMD_SELFGCAL= 0xF2, // Gain Self-Calibration 1111    0010 (F2h)
+	CMD_SYSOCAL = 0xF3, // System Offset Calibration 1111   0011 (F3h)
+	CMD_SYSGCAL = 0xF4, // System Gain Calibration 1111    0100 (F4h)
+	CMD_SYNC    = 0xFC, // Synchronize the A/D Conversion 1111   1100 (FCh)
+	CMD_STANDBY = 0xFD, // Begin Standby Mode 1111   1101 (FDh)
+	CMD_RESET   = 0xFE, // Reset to Power-Up Values 1111   1110 (FEh)
+};
+
+#endif
@@ -0,0 +1,853 @@
+/*
+ * ads1256_sim.c:
+ *	Software model of the ADS1256 behind the transport interface. It decodes the SPI command
+ *	stream (WREG/RREG/RDATA/RDATAC/SDATAC/SYNC/WAKEUP/...), keeps the register map, and runs
+ *	conversions in real time at the rate selected in DRATE, so DRDY behaves like the real chip.
+ *	The eight inputs carry synthetic signals: AINx = 0.25 V * x plus a small (x+1) Hz sine.
+ *	Each PGA setting has its own offset and gain error, corrected through OFC and FSC like on
+ *	the chip, so the calibration commands have something to measure.
+ *	Up to SIM_CHIPS chips share the bus: the CS and DRDY pins are chip numbers, CS k selects
+ *	chip k and DRDY k is the DRDY output of chip k.
+ *	Each chip has a DAC8552 beside it on CS SIM_CHIPS + k, like the AD/DA board. Its outputs are
+ *	wired back to AIN6 (A) and AIN7 (B) of the chip once the DAC has been written, so what is
+ *	sent to the DAC can be measured with the ADC.
+ *	ADS1256_SIM_FAULT, read at each start(), injects the faults of a real board:
+ *		"unplugged"			DOUT reads all ones and DRDY stays high
+ *		"stall:<at>[:<for>]"	conversions stop <at> ms after start() for <for> ms (0 or none: for good)
+ *		"slowmux:<us>"		the master stalls <us> us after each WREG of MUX, like a preempted thread
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include "ads1256_regs.h"
+#include "ads1256_transport.h"
+
+#define SIM_VREF			2.5			/* Volts */
+#define SIM_CLKIN_NS		130.2		/* 7.68 MHz master clock */
+#define SIM_T6_CLKIN		50			/* RDATA/RREG to first DOUT edge, Table 6 */
+#define SIM_CHIPS			4
+#define SIM_DAC_VREF		5.0			/* Volts, VREF of the DAC8552 on the board */
+
+/* DRATE code, output data rate and time from WAKEUP to the first DRDY (Table 13, fully settled) */
+typedef struct
+{
+	uint8_t Code;
+	double Sps;
+	uint32_t SettleUs;
+}SIM_DRATE_T;
+
+static const SIM_DRATE_T s_tabRate[] =
+{
+	{0xF0, 30000,    210},
+	{0xE0, 15000,    250},
+	{0xD0,  7500,    310},
+	{0xC0,  3750,    440},
+	{0xB0,  2000,    680},
+	{0xA1,  1000,   1180},
+	{0x92,   500,   2180},
+	{0x82,   100,  10180},
+	{0x72,    60,  16840},
+	{0x63,    50,  20180},
+	{0x53,    30,  33510},
+	{0x43,    25,  40180},
+	{0x33,    15,  66840},
+	{0x23,    10, 100180},
+	{0x13,     5, 200180},
+	{0x03,   2.5, 400180},
+};
+
+/* State of the serial interface */
+enum
+{
+	SIM_IDLE = 0,		/* Waiting for a command byte */
+	SIM_WREG_N,			/* Second byte of WREG: number of registers - 1 */
+	SIM_WREG_DATA,
+	SIM_RREG_N,			/* Second byte of RREG: number of registers - 1 */
+	SIM_RREG_DATA,
+	SIM_RDATA,			/* Shifting out the 3 data bytes */
+};
+
+typedef struct
+{
+	uint8_t Reg[REG_COUNT];
+	uint8_t Powered;		/* Set by the first Sim_Init of the chip */
+	uint8_t Cs;
+
+	uint8_t State;
+	uint8_t Addr;			/* Register pointer of WREG/RREG */
+	uint8_t Left;			/* Registers still to transfer */
+	uint8_t AcalPending;	/* The WREG in progress changed PGA, DR or BUFEN with ACAL set */
+	uint8_t Out[3];			/* Data register latched for readout */
+	uint8_t OutPos;
+	uint8_t Continuous;		/* RDATAC mode */
+	int64_t CmdTime;		/* When the last RDATA/RREG command byte was clocked in */
+
+	uint8_t Running;		/* Converting, cleared by SYNC and STANDBY */
+	uint8_t ConvMux;		/* MUX the conversion in progress was started with */
+	int64_t NextDone;		/* Completion time of the conversion in progress, ns */
+	uint64_t Done;			/* Conversions completed */
+	uint64_t Read;			/* Value of Done when the data register was last read */
+	int32_t Data;			/* Output data register */
+	uint32_t Noise;			/* xorshift state */
+	uint32_t T6Violations;	/* Data read sooner than t6 after RDATA/RREG */
+
+	uint8_t Unplugged;		/* ADS1256_SIM_FAULT: nothing on the bus */
+	int64_t StallFrom;		/* ADS1256_SIM_FAULT: no conversion completes from StallFrom ... */
+	int64_t StallTo;		/* ... to StallTo, CLOCK_MONOTONIC ns; StallTo 0 = never again */
+	uint32_t SlowMuxUs;		/* ADS1256_SIM_FAULT: stall after a WREG of MUX, us */
+}SIM_ADS1256_T;
+
+/* DAC8552: 24 bit frames, control byte then the code, MSB first */
+typedef struct
+{
+	uint8_t Powered;		/* Its CS pin was set up */
+	uint8_t Cs;
+	uint8_t Pos;			/* Bytes of the frame in progress */
+	uint8_t In[3];
+	uint16_t Buf[2];		/* Input buffers A and B */
+	uint16_t Out[2];		/* DAC registers, what the outputs show */
+	uint8_t Written;		/* The outputs have been loaded once: they drive AIN6 and AIN7 */
+}SIM_DAC8552_T;
+
+static SIM_ADS1256_T s_tSimChip[SIM_CHIPS];
+static SIM_DAC8552_T s_tSimDac[SIM_CHIPS];
+static SIM_ADS1256_T *s_pSim = &s_tSimChip[0];	/* Chip the model works on, set under s_SimLock */
+static uint32_t s_SimHoldUs;							/* slowmux stall owed by the transfer in progress */
+static uint32_t s_SclkHz = 1000000;				/* SPI clock of the bus, sets how long each transfer takes */
+static pthread_mutex_t s_SimLock = PTHREAD_MUTEX_INITIALIZER;
+
+#define s_tSim	(*s_pSim)
+
+static int64_t Sim_Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Rate of the DRATE code, NULL for a code outside Table 13: the datasheet leaves those undefined,
+   so the model does not guess one and stops converting instead (DRDY stays high) */
+static const SIM_DRATE_T *Sim_Rate(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < sizeof(s_tabRate) / sizeof(s_tabRate[0]); i++)
+	{
+		if (s_tabRate[i].Code == s_tSim.Reg[REG_DRATE])
+		{
+			return &s_tabRate[i];
+		}
+	}
+	return NULL;
+}
+
+static uint32_t Sim_SettleUs(void)
+{
+	const SIM_DRATE_T *rate = Sim_Rate();
+
+	return (rate != NULL) ? rate->SettleUs : 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: Sim_Input
+*	function: Voltage on an analog input at time _t
+*	parameter: _in : 0-7 AIN0..AIN7, 8 and above AINCOM
+*			   _t : CLOCK_MONOTONIC, ns
+*	The return value: Volts
+*********************************************************************************************************
+*/
+static double Sim_Input(uint8_t _in, int64_t _t)
+{
+	const SIM_DAC8552_T *dac = &s_tSimDac[s_pSim - s_tSimChip];
+
+	if (_in > 7)
+	{
+		return 0.0;		/* AINCOM is the ground reference on the board */
+	}
+	if ((_in >= 6) && dac->Written)
+	{
+		return dac->Out[_in - 6] * SIM_DAC_VREF / 65536;
+	}
+	return 0.25 * _in + 0.05 * sin(2 * M_PI * (_in + 1) * (_t / 1e9));
+}
+
+/* Offset error of the modulator at each PGA setting, in codes: what SELFOCAL measures */
+static double Sim_OffsetError(uint8_t _pga)
+{
+	return 18 + 5 * _pga;
+}
+
+/* FSC value that corrects the gain error at each PGA setting: what SELFGCAL measures */
+static uint32_t Sim_GainError(uint8_t _pga)
+{
+	return 0x44A85C + 0x1000 * _pga;
+}
+
+static int32_t Sim_Ofc(void)
+{
+	int32_t ofc = s_tSim.Reg[REG_OFC0] | (s_tSim.Reg[REG_OFC1] << 8) | (s_tSim.Reg[REG_OFC2] << 16);
+
+	return (ofc & 0x800000) ? ofc - 0x1000000 : ofc;
+}
+
+static uint32_t Sim_Fsc(void)
+{
+	return s_tSim.Reg[REG_FSC0] | (s_tSim.Reg[REG_FSC1] << 8) | (s_tSim.Reg[REG_FSC2] << 16);
+}
+
+static void Sim_SetCal(uint8_t _reg, int32_t _value)
+{
+	s_tSim.Reg[_reg] = _value & 0xFF;
+	s_tSim.Reg[_reg + 1] = (_value >> 8) & 0xFF;
+	s_tSim.Reg[_reg + 2] = (_value >> 16) & 0xFF;
+}
+
+/*
+*********************************************************************************************************
+*	name: Sim_Raw
+*	function: Modulator output for the input pair in _mux with the PGA setting in ADCON, before the
+*			  calibration: the ideal code scaled by the PGA's gain error plus its offset error
+*	parameter: _mux : MUX register value
+*			   _t : conversion time, ns
+*	The return value: uncalibrated code
+*********************************************************************************************************
+*/
+static double Sim_Raw(uint8_t _mux, int64_t _t)
+{
+	double v;
+	uint8_t pga = s_tSim.Reg[REG_ADCON] & 0x07;
+
+	if (pga > 6)
+	{
+		pga = 6;
+	}
+	v = Sim_Input(_mux >> 4, _t) - Sim_Input(_mux & 0x0F, _t);
+	return v * (1 << pga) / (2 * SIM_VREF) * 0x7FFFFF * 0x400000 / Sim_GainError(pga) + Sim_OffsetError(pga);
+}
+
+/*
+*********************************************************************************************************
+*	name: Sim_Convert
+*	function: Result of a conversion of the input pair in _mux: the modulator output corrected
+*			  with OFC and FSC, Output = (Raw - OFC) * FSC / 0x400000 (datasheet, Calibration)
+*	parameter: _mux : MUX register value
+*			   _t : conversion time, ns
+*	The return value: 24 bit two's complement code, sign extended
+*********************************************************************************************************
+*/
+static int32_t Sim_Convert(uint8_t _mux, int64_t _t)
+{
+	double code;
+
+	code = (Sim_Raw(_mux, _t) - Sim_Ofc()) * Sim_Fsc() / 0x400000;
+
+	/* A few LSB of noise so filters and averaging have something to do */
+	s_tSim.Noise ^= s_tSim.Noise << 13;
+	s_tSim.Noise ^= s_tSim.Noise >> 17;
+	s_tSim.Noise ^= s_tSim.Noise << 5;
+	code += (double)(s_tSim.Noise & 0x1F) - 16;
+
+	if (code > 0x7FFFFF)
+	{
+		code = 0x7FFFFF;
+	}
+	if (code < -0x800000)
+	{
+		code = -0x800000;
+	}
+	return (int32_t)code;
+}
+
+/*
+*********************************************************************************************************
+*	name: Sim_Update
+*	function: Bring the conversion engine up to _now: complete every conversion that ended since
+*			  the last call. Only the newest result is kept, like the chip's output register.
+*	parameter: _now : CLOCK_MONOTONIC, ns
+*	The return value: NULL
+*********************************************************************************************************
+*/
+static void Sim_Update(int64_t _now)
+{
+	const SIM_DRATE_T *rate;
+	int64_t period;
+	int64_t k;
+	int64_t t;
+
+	if (!s_tSim.Running || (_now < s_tSim.NextDone))
+	{
+		return;
+	}
+
+	rate = Sim_Rate();
+	if (rate == NULL)
+	{
+		return;		/* Undefined DRATE code: no conversion ever completes */
+	}
+	period = (int64_t)(1e9 / rate->Sps);
+	if (s_tSim.StallFrom && (_now >= s_tSim.StallFrom) && (!s_tSim.StallTo || (_now < s_tSim.StallTo)))
+	{
+		s_tSim.NextDone = _now + period;	/* The modulator stopped, DRDY stays high */
+		return;
+	}
+	k = (_now - s_tSim.NextDone) / period;
+	t = s_tSim.NextDone + k * period;
+
+	/* Conversions after the first one in this step were started with the current MUX. The first
+	   one ran on both inputs if the MUX changed under it: the result is a blend of the two */
+	if ((k == 0) && (s_tSim.ConvMux != s_tSim.Reg[REG_MUX]))
+	{
+		s_tSim.Data = (Sim_Convert(s_tSim.ConvMux, t) + Sim_Convert(s_tSim.Reg[REG_MUX], t)) / 2;
+	}
+	else
+	{
+		s_tSim.Data = Sim_Convert((k == 0) ? s_tSim.ConvMux : s_tSim.Reg[REG_MUX], t);
+	}
+	s_tSim.Done += k + 1;
+	s_tSim.ConvMux = s_tSim.Reg[REG_MUX];
+	s_tSim.NextDone = t + period;
+}
+
+/* (Re)start the digital filter: the next result comes after the settling time */
+static void Sim_Restart(int64_t _now, uint32_t _us)
+{
+	s_tSim.Running = 1;
+	s_tSim.ConvMux = s_tSim.Reg[REG_MUX];
+	s_tSim.NextDone = _now + (int64_t)_us * 1000;
+}
+
+static void Sim_Reset(int64_t _now)
+{
+	static const uint8_t tabReset[REG_COUNT] =
+	{
+		0x30, 0x01, 0x20, 0xF0, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40
+	};
+
+	memcpy(s_tSim.Reg, tabReset, sizeof(tabReset));
+	Sim_SetCal(REG_OFC0, (int32_t)Sim_OffsetError(0));	/* Self-calibrated at power-up */
+	Sim_SetCal(REG_FSC0, Sim_GainError(0));
+	s_tSim.State = SIM_IDLE;
+	s_tSim.Continuous = 0;
+	s_tSim.Read = s_tSim.Done;
+	Sim_Restart(_now, Sim_SettleUs());
+}
+
+/*
+*********************************************************************************************************
+*	name: Sim_Calibrate
+*	function: Run a calibration command. The self-calibrations store the PGA's own errors, the
+*			  system calibrations measure the selected inputs as zero or as positive full scale.
+*			  DRDY stays high for roughly three settling times.
+*	parameter: _cmd : CMD_SELFCAL ... CMD_SYSGCAL
+*			   _now : CLOCK_MONOTONIC, ns
+*	The return value: NULL
+*********************************************************************************************************
+*/
+static void Sim_Calibrate(uint8_t _cmd, int64_t _now)
+{
+	uint8_t pga = s_tSim.Reg[REG_ADCON] & 0x07;
+	double raw;
+
+	if (pga > 6)
+	{
+		pga = 6;
+	}
+
+	if ((_cmd == CMD_SELFCAL) || (_cmd == CMD_SELFOCAL))
+	{
+		Sim_SetCal(REG_OFC0, (int32_t)Sim_OffsetError(pga));
+	}
+	if ((_cmd == CMD_SELFCAL) || (_cmd == CMD_SELFGCAL))
+	{
+		Sim_SetCal(REG_FSC0, Sim_GainError(pga));
+	}
+	if (_cmd == CMD_SYSOCAL)
+	{
+		Sim_SetCal(REG_OFC0, (int32_t)Sim_Raw(s_tSim.Reg[REG_MUX], _now));
+	}
+	if (_cmd == CMD_SYSGCAL)
+	{
+		raw = Sim_Raw(s_tSim.Reg[REG_MUX], _now) - Sim_Ofc();
+		if (raw > 0)
+		{
+			Sim_SetCal(REG_FSC0, (int32_t)(0x7FFFFF * (double)0x400000 / raw) & 0xFFFFFF);
+		}
+	}
+
+	s_tSim.Read = s_tSim.Done;
+	Sim_Restart(_now, 3 * Sim_SettleUs());
+}
+
+/* Latch the output register for a 3 byte readout, DRDY goes back high */
+static void Sim_LatchData(void)
+{
+	s_tSim.Out[0] = (s_tSim.Data >> 16) & 0xFF;
+	s_tSim.Out[1] = (s_tSim.Data >> 8) & 0xFF;
+	s_tSim.Out[2] = s_tSim.Data & 0xFF;
+	s_tSim.OutPos = 0;
+	s_tSim.Read = s_tSim.Done;
+}
+
+static void Sim_Command(uint8_t _cmd, int64_t _now)
+{
+	switch (_cmd & 0xF0)
+	{
+		case CMD_WREG:
+			s_tSim.Addr = _cmd & 0x0F;
+			s_tSim.State = SIM_WREG_N;
+			return;
+
+		case CMD_RREG:
+			s_tSim.Addr = _cmd & 0x0F;
+			s_tSim.State = SIM_RREG_N;
+			return;
+	}
+
+	switch (_cmd)
+	{
+		case CMD_RDATAC:
+			s_tSim.Continuous = 1;
+			/* fall through, the current result follows the command */
+		case CMD_RDATA:
+			Sim_LatchData();
+			s_tSim.CmdTime = _now;
+			s_tSim.State = SIM_RDATA;
+			break;
+
+		case CMD_SDATAC:
+			s_tSim.Continuous = 0;
+			break;
+
+		case CMD_SYNC:
+		case CMD_STANDBY:
+			s_tSim.Running = 0;
+			break;
+
+		case CMD_WAKEUP:
+		case 0xFF:		/* WAKEUP has two encodings */
+			if (!s_tSim.Running)
+			{
+				Sim_Restart(_now, Sim_SettleUs());
+			}
+			break;
+
+		case CMD_SELFCAL:
+		case CMD_SELFOCAL:
+		case CMD_SELFGCAL:
+		case CMD_SYSOCAL:
+		case CMD_SYSGCAL:
+			Sim_Calibrate(_cmd, _now);
+			break;
+
+		case CMD_RESET:
+			Sim_Reset(_now);
+			break;
+	}
+}
+
+/* Register write with the read-only bits kept. Returns 1 if ACAL must start a calibration */
+static int Sim_WriteReg(uint8_t _addr, uint8_t _value)
+{
+	uint8_t old;
+
+	if (_addr >= REG_COUNT)
+	{
+		return 0;
+	}
+	old = s_tSim.Reg[_addr];
+
+	if (_addr == REG_STATUS)
+	{
+		_value = (old & 0xF1) | (_value & 0x0E);		/* ID and DRDY are read only */
+	}
+	s_tSim.Reg[_addr] = _value;
+
+	if (!(s_tSim.Reg[REG_STATUS] & 0x04) || (old == _value))
+	{
+		return 0;
+	}
+	/* ACAL: changing PGA, DR or BUFEN starts a self-calibration */
+	return (_addr == REG_ADCON) || (_addr == REG_DRATE) || (_addr == REG_STATUS);
+}
+
+static uint8_t Sim_ReadReg(uint8_t _addr)
+{
+	if (_addr >= REG_COUNT)
+	{
+		return 0;
+	}
+	if (_addr == REG_STATUS)
+	{
+		return (s_tSim.Reg[REG_STATUS] & 0xFE) | (s_tSim.Done > s_tSim.Read ? 0 : 1);
+	}
+	return s_tSim.Reg[_addr];
+}
+
+/*
+*********************************************************************************************************
+*	name: Sim_DacByte
+*	function: One byte of a frame to the DAC8552. The third byte writes the code to buffer A or B
+*			  (DB18) and loads the DAC registers selected by LDA (DB20) and LDB (DB21).
+*	parameter: _dac : DAC with its CS low
+*			   _data : byte on DIN
+*	The return value: NULL
+*********************************************************************************************************
+*/
+static void Sim_DacByte(SIM_DAC8552_T *_dac, uint8_t _data)
+{
+	uint8_t ctrl;
+
+	_dac->In[_dac->Pos++] = _data;
+	if (_dac->Pos < 3)
+	{
+		return;
+	}
+	_dac->Pos = 0;
+
+	ctrl = _dac->In[0];
+	_dac->Buf[(ctrl & 0x04) ? 1 : 0] = (_dac->In[1] << 8) | _dac->In[2];
+	if (ctrl & 0x10)
+	{
+		_dac->Out[0] = _dac->Buf[0];
+		_dac->Written = 1;
+	}
+	if (ctrl & 0x20)
+	{
+		_dac->Out[1] = _dac->Buf[1];
+		_dac->Written = 1;
+	}
+}
+
+/*
+*********************************************************************************************************
+*	name: Sim_Transfer
+*	function: One byte on the SPI bus: the byte from the master is decoded as command or
+*			  argument, the byte returned is what the chip shifts out on DOUT meanwhile
+*	parameter: _data : byte on DIN
+*	The return value: byte on DOUT
+*********************************************************************************************************
+*/
+static uint8_t Sim_Transfer(uint8_t _data)
+{
+	int64_t now;
+	uint8_t ret = 0xFF;
+	int i;
+
+	pthread_mutex_lock(&s_SimLock);
+	for (i = 0; i < SIM_CHIPS; i++)
+	{
+		if (s_tSimDac[i].Powered && !s_tSimDac[i].Cs)
+		{
+			Sim_DacByte(&s_tSimDac[i], _data);
+			pthread_mutex_unlock(&s_SimLock);
+			return 0xFF;	/* The DAC has no DOUT */
+		}
+	}
+	for (i = 0; (i < SIM_CHIPS) && (s_tSimChip[i].Cs || !s_tSimChip[i].Powered); i++);
+	if (i == SIM_CHIPS)
+	{
+		pthread_mutex_unlock(&s_SimLock);
+		return 0xFF;	/* Nothing selected, DOUT is high impedance */
+	}
+	s_pSim = &s_tSimChip[i];
+	now = Sim_Now();
+	Sim_Update(now);
+
+	if (s_tSim.Unplugged)
+	{
+		pthread_mutex_unlock(&s_SimLock);
+		return 0xFF;
+	}
+
+	switch (s_tSim.State)
+	{
+		case SIM_IDLE:
+			if (!s_tSim.Continuous)
+			{
+				Sim_Command(_data, now);
+				break;
+			}
+			/* RDATAC: only SDATAC and RESET are decoded, other clocks shift data out */
+			if ((_data == CMD_SDATAC) || (_data == CMD_RESET))
+			{
+				Sim_Command(_data, now);
+				break;
+			}
+			if (s_tSim.OutPos == 0)
+			{
+				Sim_LatchData();
+			}
+			ret = s_tSim.Out[s_tSim.OutPos];
+			s_tSim.OutPos = (s_tSim.OutPos + 1) % 3;
+			break;
+
+		case SIM_WREG_N:
+			s_tSim.Left = (_data & 0x0F) + 1;
+			s_tSim.State = SIM_WREG_DATA;
+			break;
+
+		case SIM_WREG_DATA:
+			if ((s_tSim.Addr == REG_MUX) && s_tSim.SlowMuxUs)
+			{
+				s_SimHoldUs = s_tSim.SlowMuxUs;
+			}
+			s_tSim.AcalPending |= Sim_WriteReg(s_tSim.Addr++, _data);
+			if (--s_tSim.Left == 0)
+			{
+				if (s_tSim.AcalPending)
+				{
+					Sim_Calibrate(CMD_SELFCAL, now);	/* At the end of the WREG, like the chip */
+				}
+				s_tSim.AcalPending = 0;
+				s_tSim.State = SIM_IDLE;
+			}
+			break;
+
+		case SIM_RREG_N:
+			s_tSim.Left = (_data & 0x0F) + 1;
+			s_tSim.CmdTime = now;
+			s_tSim.State = SIM_RREG_DATA;
+			break;
+
+		case SIM_RREG_DATA:
+			if (now - s_tSim.CmdTime < (int64_t)(SIM_T6_CLKIN * SIM_CLKIN_NS))
+			{
+				s_tSim.T6Violations++;
+			}
+			s_tSim.CmdTime = 0;
+			ret = Sim_ReadReg(s_tSim.Addr++);
+			if (--s_tSim.Left == 0)
+			{
+				s_tSim.State = SIM_IDLE;
+			}
+			break;
+
+		case SIM_RDATA:
+			if ((s_tSim.OutPos == 0) && (now - s_tSim.CmdTime < (int64_t)(SIM_T6_CLKIN * SIM_CLKIN_NS)))
+			{
+				s_tSim.T6Violations++;
+			}
+			ret = s_tSim.Out[s_tSim.OutPos++];
+			if (s_tSim.OutPos == 3)
+			{
+				s_tSim.OutPos = 0;
+				s_tSim.State = SIM_IDLE;
+			}
+			break;
+	}
+
+	pthread_mutex_unlock(&s_SimLock);
+	return ret;
+}
+
+/* Hold the caller for as long as _len bytes take on the wire at the current SCLK */
+static void Sim_Wire(int64_t _start, uint32_t _len)
+{
+	int64_t end;
+
+	end = _start + (int64_t)_len * 8 * 1000000000 / s_SclkHz;
+	while (Sim_Now() < end);
+}
+
+/* ADS1256_SIM_FAULT slowmux: the master goes on that much later after a WREG of MUX */
+static void Sim_Hold(void)
+{
+	int64_t end;
+	uint32_t us;
+
+	pthread_mutex_lock(&s_SimLock);
+	us = s_SimHoldUs;
+	s_SimHoldUs = 0;
+	pthread_mutex_unlock(&s_SimLock);
+
+	end = Sim_Now() + (int64_t)us * 1000;
+	while (Sim_Now() < end);
+}
+
+static uint8_t Sim_TransferTimed(uint8_t _data)
+{
+	int64_t start = Sim_Now();
+	uint8_t ret;
+
+	ret = Sim_Transfer(_data);
+	Sim_Wire(start, 1);
+	Sim_Hold();
+	return ret;
+}
+
+static void Sim_Transfern(uint8_t *_buf, uint32_t _len)
+{
+	int64_t start = Sim_Now();
+	uint32_t i;
+
+	for (i = 0; i < _len; i++)
+	{
+		_buf[i] = Sim_Transfer(_buf[i]);
+	}
+	Sim_Wire(start, _len);
+	Sim_Hold();
+}
+
+static uint32_t Sim_SetClock(uint32_t _hz)
+{
+	s_SclkHz = _hz;
+	return _hz;
+}
+
+/* Taking CS high resets the serial interface, RDATAC mode survives it. Pins from SIM_CHIPS up
+   are the DAC8552s, where CS low starts a new frame. */
+static void Sim_SetCS(int _pin, uint8_t _level)
+{
+	pthread_mutex_lock(&s_SimLock);
+	if (_pin >= 2 * SIM_CHIPS)
+	{
+		pthread_mutex_unlock(&s_SimLock);
+		return;
+	}
+	if (_pin >= SIM_CHIPS)
+	{
+		s_tSimDac[_pin - SIM_CHIPS].Pos = 0;
+		s_tSimDac[_pin - SIM_CHIPS].Cs = _level ? 1 : 0;
+		pthread_mutex_unlock(&s_SimLock);
+		return;
+	}
+	s_pSim = &s_tSimChip[_pin];
+	if (_level && !s_tSim.Cs)
+	{
+		s_tSim.State = SIM_IDLE;
+	}
+	if (!_level && s_tSim.Cs)
+	{
+		s_tSim.OutPos = 0;
+	}
+	s_tSim.Cs = _level ? 1 : 0;
+	pthread_mutex_unlock(&s_SimLock);
+}
+
+/* Power up the DAC8552 on _pin, outputs at zero and not yet wired to the ADC inputs */
+static void Sim_SetupCS(int _pin)
+{
+	if ((_pin < SIM_CHIPS) || (_pin >= 2 * SIM_CHIPS))
+	{
+		return;
+	}
+	pthread_mutex_lock(&s_SimLock);
+	memset(&s_tSimDac[_pin - SIM_CHIPS], 0, sizeof(SIM_DAC8552_T));
+	s_tSimDac[_pin - SIM_CHIPS].Powered = 1;
+	s_tSimDac[_pin - SIM_CHIPS].Cs = 1;
+	pthread_mutex_unlock(&s_SimLock);
+}
+
+static uint8_t Sim_DrdyLevel(int _pin)
+{
+	uint8_t level;
+
+	pthread_mutex_lock(&s_SimLock);
+	s_pSim = &s_tSimChip[_pin];
+	Sim_Update(Sim_Now());
+	level = ((s_tSim.Done > s_tSim.Read) && !s_tSim.Unplugged) ? 0 : 1;
+	pthread_mutex_unlock(&s_SimLock);
+	return level;
+}
+
+/* Short delays spin like bcm2835_delayMicroseconds, long ones sleep */
+static void Sim_DelayUS(uint64_t _micros)
+{
+	struct timespec ts;
+	int64_t end;
+
+	if (_micros >= 100)
+	{
+		ts.tv_sec = _micros / 1000000;
+		ts.tv_nsec = (_micros % 1000000) * 1000;
+		nanosleep(&ts, NULL);
+		return;
+	}
+	end = Sim_Now() + (int64_t)_micros * 1000;
+	while (Sim_Now() < end);
+}
+
+/* ADS1256_SIM_FAULT, see the top of the file */
+static void Sim_Faults(int64_t _now)
+{
+	const char *s = getenv("ADS1256_SIM_FAULT");
+	char *p;
+	long at, len;
+
+	if ((s == NULL) || (*s == 0))
+	{
+		return;
+	}
+	if (strcmp(s, "unplugged") == 0)
+	{
+		s_tSim.Unplugged = 1;
+	}
+	else if (strncmp(s, "stall:", 6) == 0)
+	{
+		at = strtol(s + 6, &p, 10);
+		len = (*p == ':') ? strtol(p + 1, NULL, 10) : 0;
+		s_tSim.StallFrom = _now + (int64_t)at * 1000000 + 1;
+		s_tSim.StallTo = len ? s_tSim.StallFrom + (int64_t)len * 1000000 : 0;
+	}
+	else if (strncmp(s, "slowmux:", 8) == 0)
+	{
+		s_tSim.SlowMuxUs = (uint32_t)strtoul(s + 8, NULL, 10);
+	}
+}
+
+/* Power up chip _cs. Its DRDY can only be read on the pin of the same number. */
+static int Sim_Init(int _cs, int _drdy)
+{
+	int64_t now;
+
+	if ((_cs < 0) || (_cs >= SIM_CHIPS) || (_drdy < 0) || (_drdy >= SIM_CHIPS))
+	{
+		return 1;
+	}
+
+	pthread_mutex_lock(&s_SimLock);
+	s_pSim = &s_tSimChip[_cs];
+	now = Sim_Now();
+	memset(&s_tSim, 0, sizeof(s_tSim));
+	s_tSim.Powered = 1;
+	s_tSim.Cs = 1;
+	s_tSim.Noise = 0x12345678 + _cs;
+	Sim_Faults(now);
+	Sim_Reset(now);
+	pthread_mutex_unlock(&s_SimLock);
+	return 0;
+}
+
+static void Sim_Close(int _cs, int _drdy)
+{
+	(void)_drdy;
+
+	pthread_mutex_lock(&s_SimLock);
+	s_tSimChip[_cs].Cs = 1;
+	pthread_mutex_unlock(&s_SimLock);
+}
+
+const ADS1256_TRANSPORT_T g_tTransportSim =
+{
+	"sim",
+	0,
+	0,
+	0,			/* No gpiochip behind the simulated DRDY */
+	SIM_CHIPS,	/* DAC8552 of chip 0 */
+	Sim_Init,
+	Sim_Close,
+	Sim_SetClock,
+	Sim_TransferTimed,
+	Sim_Transfern,
+	Sim_SetCS,
+	Sim_SetupCS,
+	Sim_DrdyLevel,
+	Sim_DelayUS,
+};
@@ -1,1042 +1,5252 @@
-/*
- * ADS1256_test.c:
- *	Very simple program to test the serial port. Expects
- *	the port to be looped back to itself
- *
- */
- 
-/*
-             define from bcm2835.h                       define from Board DVK511
-                 3.3V | | 5V               ->                 3.3V | | 5V
-    RPI_V2_GPIO_P1_03 | | 5V               ->                  SDA | | 5V 
-    RPI_V2_GPIO_P1_05 | | GND              ->                  SCL | | GND
-       RPI_GPIO_P1_07 | | RPI_GPIO_P1_08   ->                  IO7 | | TX
-                  GND | | RPI_GPIO_P1_10   ->                  GND | | RX
-       RPI_GPIO_P1_11 | | RPI_GPIO_P1_12   ->                  IO0 | | IO1
-    RPI_V2_GPIO_P1_13 | | GND              ->                  IO2 | | GND
-       RPI_GPIO_P1_15 | | RPI_GPIO_P1_16   ->                  IO3 | | IO4
-                  VCC | | RPI_GPIO_P1_18   ->                  VCC | | IO5
-       RPI_GPIO_P1_19 | | GND              ->                 MOSI | | GND
-       RPI_GPIO_P1_21 | | RPI_GPIO_P1_22   ->                 MISO | | IO6
-       RPI_GPIO_P1_23 | | RPI_GPIO_P1_24   ->                  SCK | | CE0
-                  GND | | RPI_GPIO_P1_26   ->                  GND | | CE1
-
-::if your raspberry Pi is version 1 or rev 1 or rev A
-RPI_V2_GPIO_P1_03->RPI_GPIO_P1_03
-RPI_V2_GPIO_P1_05->RPI_GPIO_P1_05
-RPI_V2_GPIO_P1_13->RPI_GPIO_P1_13
-::
-*/
-
-#include <bcm2835.h>  
-#include <stdio.h>
-#include <unistd.h>
-#include <string.h>
-#include <math.h>
-#include <errno.h>
-#include "wrapper.h"
-//CS      -----   SPICS  
-//DIN     -----   MOSI
-//DOUT  -----   MISO
-//SCLK   -----   SCLK
-//DRDY  -----   ctl_IO     data  starting
-//RST     -----   ctl_IO     reset
-
-
-
-#define  DRDY  RPI_GPIO_P1_11         //P0
-#define  RST  RPI_GPIO_P1_12     //P1
-#define	SPICS	RPI_GPIO_P1_15	//P3
-
-#define CS_1() bcm2835_gpio_write(SPICS,HIGH)
-#define CS_0()  bcm2835_gpio_write(SPICS,LOW)
-
-#define DRDY_IS_LOW()	((bcm2835_gpio_lev(DRDY)==0))
-
-#define RST_1() 	bcm2835_gpio_write(RST,HIGH);
-#define RST_0() 	bcm2835_gpio_write(RST,LOW);
-
-
-
-/* Unsigned integer types  */
-#define uint8_t unsigned char
-#define uint16_t unsigned short    
-#define uint32_t unsigned long     
-
-
-
-
-typedef enum {FALSE = 0, TRUE = !FALSE} bool;
-
-
-/* gain channel */
-typedef enum
-{
-	ADS1256_GAIN_1			= (0),	/* GAIN   1 */
-	ADS1256_GAIN_2			= (1),	/*GAIN   2 */
-	ADS1256_GAIN_4			= (2),	/*GAIN   4 */
-	ADS1256_GAIN_8			= (3),	/*GAIN   8 */
-	ADS1256_GAIN_16			= (4),	/* GAIN  16 */
-	ADS1256_GAIN_32			= (5),	/*GAIN    32 */
-	ADS1256_GAIN_64			= (6),	/*GAIN    64 */
-}ADS1256_GAIN_E;
-
-/* Sampling speed choice*/
-/* 
-	11110000 = 30,000SPS (default)
-	11100000 = 15,000SPS
-	11010000 = 7,500SPS
-	11000000 = 3,750SPS
-	10110000 = 2,000SPS
-	10100001 = 1,000SPS
-	10010010 = 500SPS
-	10000010 = 100SPS
-	01110010 = 60SPS
-	01100011 = 50SPS
-	01010011 = 30SPS
-	01000011 = 25SPS
-	00110011 = 15SPS
-	00100011 = 10SPS
-	00010011 = 5SPS
-	00000011 = 2.5SPS
-*/
-typedef enum
-{
-	ADS1256_30000SPS = 0,
-	ADS1256_15000SPS = 1,
-	ADS1256_7500SPS = 2,
-	ADS1256_3750SPS = 3,
-	ADS1256_2000SPS = 4,
-	ADS1256_1000SPS = 5,
-	ADS1256_500SPS = 6,
-	ADS1256_100SPS = 7,
-	ADS1256_60SPS = 8,
-	ADS1256_50SPS = 9,
-	ADS1256_30SPS = 10,
-	ADS1256_25SPS = 11,
-	ADS1256_15SPS = 12,
-	ADS1256_10SPS = 13,
-	ADS1256_5SPS = 14,
-	ADS1256_2d5SPS = 15,
-
-	ADS1256_DRATE_MAX
-}ADS1256_DRATE_E;
-
-#define ADS1256_DRAE_COUNT = 15;
-
-typedef struct
-{
-	ADS1256_GAIN_E Gain;		/* GAIN  */
-	ADS1256_DRATE_E DataRate;	/* DATA output  speed*/
-	int32_t AdcNow[8];			/* ADC  Conversion value */
-	uint8_t Channel;			/* The current channel*/
-	uint8_t ScanMode;	/*Scanning mode,   0  Single-ended input  8 channel 1 Differential input  4 channel*/
-}ADS1256_VAR_T;
-
-
-
-/*Register definition Table 23. Register Map --- ADS1256 datasheet Page 30*/
-enum
-{
-	/*Register address, followed by reset the default values */
-	REG_STATUS = 0,	// x1H
-	REG_MUX    = 1, // 01H
-	REG_ADCON  = 2, // 20H
-	REG_DRATE  = 3, // F0H
-	REG_IO     = 4, // E0H
-	REG_OFC0   = 5, // xxH
-	REG_OFC1   = 6, // xxH
-	REG_OFC2   = 7, // xxH
-	REG_FSC0   = 8, // xxH
-	REG_FSC1   = 9, // xxH
-	REG_FSC2   = 10, // xxH
-};
-
-/* Command definition TTable 24. Command Definitions --- ADS1256 datasheet Page 34 */
-enum
-{
-	CMD_WAKEUP  = 0x00,	// Completes SYNC and Exits Standby Mode 0000  0000 (00h)
-	CMD_RDATA   = 0x01, // Read Data 0000  0001 (01h)
-	CMD_RDATAC  = 0x03, // Read Data Continuously 0000   0011 (03h)
-	CMD_SDATAC  = 0x0F, // Stop Read Data Continuously 0000   1111 (0Fh)
-	CMD_RREG    = 0x10, // Read from REG rrr 0001 rrrr (1xh)
-	CMD_WREG    = 0x50, // Write to REG rrr 0101 rrrr (5xh)
-	CMD_SELFCAL = 0xF0, // Offset and Gain Self-Calibration 1111    0000 (F0h)
-	CMD_SELFOCAL= 0xF1, // Offset Self-Calibration 1111    0001 (F1h)
-	CMD_SELFGCAL= 0xF2, // Gain Self-Calibration 1111    0010 (F2h)
-	CMD_SYSOCAL = 0xF3, // System Offset Calibration 1111   0011 (F3h)
-	CMD_SYSGCAL = 0xF4, // System Gain Calibration 1111    0100 (F4h)
-	CMD_SYNC    = 0xFC, // Synchronize the A/D Conversion 1111   1100 (FCh)
-	CMD_STANDBY = 0xFD, // Begin Standby Mode 1111   1101 (FDh)
-	CMD_RESET   = 0xFE, // Reset to Power-Up Values 1111   1110 (FEh)
-};
-
-
-ADS1256_VAR_T g_tADS1256;
-static const uint8_t s_tabDataRate[ADS1256_DRATE_MAX] =
-{
-	0xF0,		/*reset the default values  */
-	0xE0,
-	0xD0,
-	0xC0,
-	0xB0,
-	0xA1,
-	0x92,
-	0x82,
-	0x72,
-	0x63,
-	0x53,
-	0x43,
-	0x33,
-	0x20,
-	0x13,
-	0x03
-};
-
-
-
-
-
-
-
-void  bsp_DelayUS(uint64_t micros);
-void ADS1256_StartScan(uint8_t _ucScanMode);
-static void ADS1256_Send8Bit(uint8_t _data);
-void ADS1256_CfgADC(ADS1256_GAIN_E _gain, ADS1256_DRATE_E _drate);
-static void ADS1256_DelayDATA(void);
-static uint8_t ADS1256_Recive8Bit(void);
-static void ADS1256_WriteReg(uint8_t _RegID, uint8_t _RegValue);
-static uint8_t ADS1256_ReadReg(uint8_t _RegID);
-static void ADS1256_WriteCmd(uint8_t _cmd);
-uint8_t ADS1256_ReadChipID(void);
-static void ADS1256_SetChannal(uint8_t _ch);
-static void ADS1256_SetDiffChannal(uint8_t _ch);
-static void ADS1256_WaitDRDY(void);
-static int32_t ADS1256_ReadData(void);
-
-int32_t ADS1256_GetAdc(uint8_t _ch);
-void ADS1256_ISR(void);
-uint8_t ADS1256_Scan(void);
-
-
-
-
-void  bsp_DelayUS(uint64_t micros)
-{
-		bcm2835_delayMicroseconds (micros);
-}
-
-
-/*
-*********************************************************************************************************
-*	name: bsp_InitADS1256
-*	function: Configuration of the STM32 GPIO and SPI interfaceThe connection ADS1256
-*	parameter: NULL
-*	The return value: NULL
-*********************************************************************************************************
-*/
-
-
-void bsp_InitADS1256(void)
-{
-#ifdef SOFT_SPI
-	CS_1();
-	SCK_0();
-	DI_0();
-#endif
-
-//ADS1256_CfgADC(ADS1256_GAIN_1, ADS1256_1000SPS);	/* ADC 1:1,  1KHz */
-}
-
-
-
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_StartScan
-*	function: Configuration DRDY PIN for external interrupt is triggered
-*	parameter: _ucDiffMode : 0  Single-ended input  8 channel 1 Differential input  4 channe
-*	The return value: NULL
-*********************************************************************************************************
-*/
-void ADS1256_StartScan(uint8_t _ucScanMode)
-{
-	g_tADS1256.ScanMode = _ucScanMode;
-	/* ʼɨǰ,  */
-	{
-		uint8_t i;
-
-		g_tADS1256.Channel = 0;
-
-		for (i = 0; i < 8; i++)
-		{
-			g_tADS1256.AdcNow[i] = 0;
-		}
-	}
-
-}
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_Send8Bit
-*	function: SPI bus to send 8 bit data
-*	parameter: _data:  data
-*	The return value: NULL
-*********************************************************************************************************
-*/
-static void ADS1256_Send8Bit(uint8_t _data)
-{
-
-	bsp_DelayUS(2);
-	bcm2835_spi_transfer(_data);
-}
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_CfgADC
-*	function: The configuration parameters of ADC, gain and data rate
-*	parameter: _gain:gain 1-64
-*                      _drate:  data  rate
-*	The return value: NULL
-*********************************************************************************************************
-*/
-void ADS1256_CfgADC(ADS1256_GAIN_E _gain, ADS1256_DRATE_E _drate)
-{
-	g_tADS1256.Gain = _gain;
-	g_tADS1256.DataRate = _drate;
-
-	ADS1256_WaitDRDY();
-
-	{
-		uint8_t buf[4];		/* Storage ads1256 register configuration parameters */
-
-		/*Status register define
-			Bits 7-4 ID3, ID2, ID1, ID0  Factory Programmed Identification Bits (Read Only)
-
-			Bit 3 ORDER: Data Output Bit Order
-				0 = Most Significant Bit First (default)
-				1 = Least Significant Bit First
-			Input data  is always shifted in most significant byte and bit first. Output data is always shifted out most significant
-			byte first. The ORDER bit only controls the bit order of the output data within the byte.
-
-			Bit 2 ACAL : Auto-Calibration
-				0 = Auto-Calibration Disabled (default)
-				1 = Auto-Calibration Enabled
-			When Auto-Calibration is enabled, self-calibration begins at the completion of the WREG command that changes
-			the PGA (bits 0-2 of ADCON register), DR (bits 7-0 in the DRATE register) or BUFEN (bit 1 in the STATUS register)
-			values.
-
-			Bit 1 BUFEN: Analog Input Buffer Enable
-				0 = Buffer Disabled (default)
-				1 = Buffer Enabled
-
-			Bit 0 DRDY :  Data Ready (Read Only)
-				This bit duplicates the state of the DRDY pin.
-
-			ACAL=1  enable  calibration
-		*/
-		//buf[0] = (0 << 3) | (1 << 2) | (1 << 1);//enable the internal buffer
-        buf[0] = (0 << 3) | (1 << 2) | (0 << 1);  // The internal buffer is prohibited
-
-        //ADS1256_WriteReg(REG_STATUS, (0 << 3) | (1 << 2) | (1 << 1));
-
-		buf[1] = 0x08;	
-
-		/*	ADCON: A/D Control Register (Address 02h)
-			Bit 7 Reserved, always 0 (Read Only)
-			Bits 6-5 CLK1, CLK0 : D0/CLKOUT Clock Out Rate Setting
-				00 = Clock Out OFF
-				01 = Clock Out Frequency = fCLKIN (default)
-				10 = Clock Out Frequency = fCLKIN/2
-				11 = Clock Out Frequency = fCLKIN/4
-				When not using CLKOUT, it is recommended that it be turned off. These bits can only be reset using the RESET pin.
-
-			Bits 4-3 SDCS1, SCDS0: Sensor Detect Current Sources
-				00 = Sensor Detect OFF (default)
-				01 = Sensor Detect Current = 0.5  A
-				10 = Sensor Detect Current = 2  A
-				11 = Sensor Detect Current = 10 A
-				The Sensor Detect Current Sources can be activated to verify  the integrity of an external sensor supplying a signal to the
-				ADS1255/6. A shorted sensor produces a very small signal while an open-circuit sensor produces a very large signal.
-
-			Bits 2-0 PGA2, PGA1, PGA0: Programmable Gain Amplifier Setting
-				000 = 1 (default)
-				001 = 2
-				010 = 4
-				011 = 8
-				100 = 16
-				101 = 32
-				110 = 64
-				111 = 64
-		*/
-		buf[2] = (0 << 5) | (0 << 3) | (_gain << 0);
-		//ADS1256_WriteReg(REG_ADCON, (0 << 5) | (0 << 2) | (GAIN_1 << 1));	/*choose 1: gain 1 ;input 5V/
-		buf[3] = s_tabDataRate[_drate];	// DRATE_10SPS;	
-
-		CS_0();	/* SPIƬѡ = 0 */
-		ADS1256_Send8Bit(CMD_WREG | 0);	/* Write command register, send the register address */
-		ADS1256_Send8Bit(0x03);			/* Register number 4,Initialize the number  -1*/
-
-		ADS1256_Send8Bit(buf[0]);	/* Set the status register */
-		ADS1256_Send8Bit(buf[1]);	/* Set the input channel parameters */
-		ADS1256_Send8Bit(buf[2]);	/* Set the ADCON control register,gain */
-		ADS1256_Send8Bit(buf[3]);	/* Set the output rate */
-
-		CS_1();	/* SPI  cs = 1 */
-	}
-
-	bsp_DelayUS(50);
-}
-
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_DelayDATA
-*	function: delay
-*	parameter: NULL
-*	The return value: NULL
-*********************************************************************************************************
-*/
-static void ADS1256_DelayDATA(void)
-{
-	/*
-		Delay from last SCLK edge for DIN to first SCLK rising edge for DOUT: RDATA, RDATAC,RREG Commands
-		min  50   CLK = 50 * 0.13uS = 6.5uS
-	*/
-	bsp_DelayUS(10);	/* The minimum time delay 6.5us */
-}
-
-
-
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_Recive8Bit
-*	function: SPI bus receive function
-*	parameter: NULL
-*	The return value: NULL
-*********************************************************************************************************
-*/
-static uint8_t ADS1256_Recive8Bit(void)
-{
-	uint8_t read = 0;
-	read = bcm2835_spi_transfer(0xff);
-	return read;
-}
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_WriteReg
-*	function: Write the corresponding register
-*	parameter: _RegID: register  ID
-*			 _RegValue: register Value
-*	The return value: NULL
-*********************************************************************************************************
-*/
-static void ADS1256_WriteReg(uint8_t _RegID, uint8_t _RegValue)
-{
-	CS_0();	/* SPI  cs  = 0 */
-	ADS1256_Send8Bit(CMD_WREG | _RegID);	/*Write command register */
-	ADS1256_Send8Bit(0x00);		/*Write the register number */
-
-	ADS1256_Send8Bit(_RegValue);	/*send register value */
-	CS_1();	/* SPI   cs = 1 */
-}
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_ReadReg
-*	function: Read  the corresponding register
-*	parameter: _RegID: register  ID
-*	The return value: read register value
-*********************************************************************************************************
-*/
-static uint8_t ADS1256_ReadReg(uint8_t _RegID)
-{
-	uint8_t read;
-
-	CS_0();	/* SPI  cs  = 0 */
-	ADS1256_Send8Bit(CMD_RREG | _RegID);	/* Write command register */
-	ADS1256_Send8Bit(0x00);	/* Write the register number */
-
-	ADS1256_DelayDATA();	/*delay time */
-
-	read = ADS1256_Recive8Bit();	/* Read the register values */
-	CS_1();	/* SPI   cs  = 1 */
-
-	return read;
-}
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_WriteCmd
-*	function: Sending a single byte order
-*	parameter: _cmd : command
-*	The return value: NULL
-*********************************************************************************************************
-*/
-static void ADS1256_WriteCmd(uint8_t _cmd)
-{
-	CS_0();	/* SPI   cs = 0 */
-	ADS1256_Send8Bit(_cmd);
-	CS_1();	/* SPI  cs  = 1 */
-}
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_ReadChipID
-*	function: Read the chip ID
-*	parameter: _cmd : NULL
-*	The return value: four high status register
-*********************************************************************************************************
-*/
-uint8_t ADS1256_ReadChipID(void)
-{
-	uint8_t id;
-
-	ADS1256_WaitDRDY();
-	id = ADS1256_ReadReg(REG_STATUS);
-	return (id >> 4);
-}
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_SetChannal
-*	function: Configuration channel number
-*	parameter:  _ch:  channel number  0--7
-*	The return value: NULL
-*********************************************************************************************************
-*/
-static void ADS1256_SetChannal(uint8_t _ch)
-{
-	/*
-	Bits 7-4 PSEL3, PSEL2, PSEL1, PSEL0: Positive Input Channel (AINP) Select
-		0000 = AIN0 (default)
-		0001 = AIN1
-		0010 = AIN2 (ADS1256 only)
-		0011 = AIN3 (ADS1256 only)
-		0100 = AIN4 (ADS1256 only)
-		0101 = AIN5 (ADS1256 only)
-		0110 = AIN6 (ADS1256 only)
-		0111 = AIN7 (ADS1256 only)
-		1xxx = AINCOM (when PSEL3 = 1, PSEL2, PSEL1, PSEL0 are dont care)
-
-		NOTE: When using an ADS1255 make sure to only select the available inputs.
-
-	Bits 3-0 NSEL3, NSEL2, NSEL1, NSEL0: Negative Input Channel (AINN)Select
-		0000 = AIN0
-		0001 = AIN1 (default)
-		0010 = AIN2 (ADS1256 only)
-		0011 = AIN3 (ADS1256 only)
-		0100 = AIN4 (ADS1256 only)
-		0101 = AIN5 (ADS1256 only)
-		0110 = AIN6 (ADS1256 only)
-		0111 = AIN7 (ADS1256 only)
-		1xxx = AINCOM (when NSEL3 = 1, NSEL2, NSEL1, NSEL0 are dont care)
-	*/
-	if (_ch > 7)
-	{
-		return;
-	}
-	ADS1256_WriteReg(REG_MUX, (_ch << 4) | (1 << 3));	/* Bit3 = 1, AINN connection AINCOM */
-}
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_SetDiffChannal
-*	function: The configuration difference channel
-*	parameter:  _ch:  channel number  0--3
-*	The return value:  four high status register
-*********************************************************************************************************
-*/
-static void ADS1256_SetDiffChannal(uint8_t _ch)
-{
-	/*
-	Bits 7-4 PSEL3, PSEL2, PSEL1, PSEL0: Positive Input Channel (AINP) Select
-		0000 = AIN0 (default)
-		0001 = AIN1
-		0010 = AIN2 (ADS1256 only)
-		0011 = AIN3 (ADS1256 only)
-		0100 = AIN4 (ADS1256 only)
-		0101 = AIN5 (ADS1256 only)
-		0110 = AIN6 (ADS1256 only)
-		0111 = AIN7 (ADS1256 only)
-		1xxx = AINCOM (when PSEL3 = 1, PSEL2, PSEL1, PSEL0 are dont care)
-
-		NOTE: When using an ADS1255 make sure to only select the available inputs.
-
-	Bits 3-0 NSEL3, NSEL2, NSEL1, NSEL0: Negative Input Channel (AINN)Select
-		0000 = AIN0
-		0001 = AIN1 (default)
-		0010 = AIN2 (ADS1256 only)
-		0011 = AIN3 (ADS1256 only)
-		0100 = AIN4 (ADS1256 only)
-		0101 = AIN5 (ADS1256 only)
-		0110 = AIN6 (ADS1256 only)
-		0111 = AIN7 (ADS1256 only)
-		1xxx = AINCOM (when NSEL3 = 1, NSEL2, NSEL1, NSEL0 are dont care)
-	*/
-	if (_ch == 0)
-	{
-		ADS1256_WriteReg(REG_MUX, (0 << 4) | 1);	/* DiffChannal  AIN0 AIN1 */
-	}
-	else if (_ch == 1)
-	{
-		ADS1256_WriteReg(REG_MUX, (2 << 4) | 3);	/*DiffChannal   AIN2 AIN3 */
-	}
-	else if (_ch == 2)
-	{
-		ADS1256_WriteReg(REG_MUX, (4 << 4) | 5);	/*DiffChannal    AIN4 AIN5 */
-	}
-	else if (_ch == 3)
-	{
-		ADS1256_WriteReg(REG_MUX, (6 << 4) | 7);	/*DiffChannal   AIN6 AIN7 */
-	}
-}
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_WaitDRDY
-*	function: delay time  wait for automatic calibration
-*	parameter:  NULL
-*	The return value:  NULL
-*********************************************************************************************************
-*/
-static void ADS1256_WaitDRDY(void)
-{
-	uint32_t i;
-
-	for (i = 0; i < 400000; i++)
-	{
-		if (DRDY_IS_LOW())
-		{
-			break;
-		}
-	}
-	if (i >= 400000)
-	{
-		printf("ADS1256_WaitDRDY() Time Out ...\r\n");		
-	}
-}
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_ReadData
-*	function: read ADC value
-*	parameter: NULL
-*	The return value:  NULL
-*********************************************************************************************************
-*/
-static int32_t ADS1256_ReadData(void)
-{
-	uint32_t read = 0;
-    static uint8_t buf[3];
-
-	CS_0();	/* SPI   cs = 0 */
-
-	ADS1256_Send8Bit(CMD_RDATA);	/* read ADC command  */
-
-	ADS1256_DelayDATA();	/*delay time  */
-
-	/*Read the sample results 24bit*/
-    buf[0] = ADS1256_Recive8Bit();
-    buf[1] = ADS1256_Recive8Bit();
-    buf[2] = ADS1256_Recive8Bit();
-
-    read = ((uint32_t)buf[0] << 16) & 0x00FF0000;
-    read |= ((uint32_t)buf[1] << 8);  /* Pay attention to It is wrong   read |= (buf[1] << 8) */
-    read |= buf[2];
-
-	CS_1();	/* SPIƬѡ = 1 */
-
-	/* Extend a signed number*/
-    if (read & 0x800000)
-    {
-	    read |= 0xFF000000;
-    }
-
-	return (int32_t)read;
-}
-
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_GetAdc
-*	function: read ADC value
-*	parameter:  channel number 0--7
-*	The return value:  ADC vaule (signed number)
-*********************************************************************************************************
-*/
-int32_t ADS1256_GetAdc(uint8_t _ch)
-{
-	int32_t iTemp;
-
-	if (_ch > 7)
-	{
-		return 0;
-	}
-
-	iTemp = g_tADS1256.AdcNow[_ch];
-
-	return iTemp;
-}
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_ISR
-*	function: Collection procedures
-*	parameter: NULL
-*	The return value:  NULL
-*********************************************************************************************************
-*/
-void ADS1256_ISR(void)
-{
-	if (g_tADS1256.ScanMode == 0)	/*  0  Single-ended input  8 channel 1 Differential input  4 channe */
-	{
-
-		ADS1256_SetChannal(g_tADS1256.Channel);	/*Switch channel mode */
-		bsp_DelayUS(5);
-
-		ADS1256_WriteCmd(CMD_SYNC);
-		bsp_DelayUS(5);
-
-		ADS1256_WriteCmd(CMD_WAKEUP);
-		bsp_DelayUS(25);
-
-		if (g_tADS1256.Channel == 0)
-		{
-			g_tADS1256.AdcNow[7] = ADS1256_ReadData();	
-		}
-		else
-		{
-			g_tADS1256.AdcNow[g_tADS1256.Channel-1] = ADS1256_ReadData();	
-		}
-
-		if (++g_tADS1256.Channel >= 8)
-		{
-			g_tADS1256.Channel = 0;
-		}
-	}
-	else	/*DiffChannal*/
-	{
-		
-		ADS1256_SetDiffChannal(g_tADS1256.Channel);	/* change DiffChannal */
-		bsp_DelayUS(5);
-
-		ADS1256_WriteCmd(CMD_SYNC);
-		bsp_DelayUS(5);
-
-		ADS1256_WriteCmd(CMD_WAKEUP);
-		bsp_DelayUS(25);
-
-		if (g_tADS1256.Channel == 0)
-		{
-			g_tADS1256.AdcNow[3] = ADS1256_ReadData();	
-		}
-		else
-		{
-			g_tADS1256.AdcNow[g_tADS1256.Channel-1] = ADS1256_ReadData();	
-		}
-
-		if (++g_tADS1256.Channel >= 4)
-		{
-			g_tADS1256.Channel = 0;
-		}
-	}
-}
-
-/*
-*********************************************************************************************************
-*	name: ADS1256_Scan
-*	function: 
-*	parameter:NULL
-*	The return value:  1
-*********************************************************************************************************
-*/
-uint8_t ADS1256_Scan(void)
-{
-	if (DRDY_IS_LOW())
-	{
-		ADS1256_ISR();
-		return 1;
-	}
-
-	return 0;
-}
-/*
-*********************************************************************************************************
-*	name: Write_DAC8552
-*	function:  DAC send data 
-*	parameter: channel : output channel number 
-*			   data : output DAC value 
-*	The return value:  NULL
-*********************************************************************************************************
-*/
-void Write_DAC8552(uint8_t channel, uint16_t Data)
-{
-	uint8_t i;
-
-	 CS_1() ;
-	 CS_0() ;
-      bcm2835_spi_transfer(channel);
-      bcm2835_spi_transfer((Data>>8));
-      bcm2835_spi_transfer((Data&0xff));  
-      CS_1() ;
-}
-/*
-*********************************************************************************************************
-*	name: Voltage_Convert
-*	function:  Voltage value conversion function
-*	parameter: Vref : The reference voltage 3.3V or 5V
-*			   voltage : output DAC value 
-*	The return value:  NULL
-*********************************************************************************************************
-*/
-uint16_t Voltage_Convert(float Vref, float voltage)
-{
-	uint16_t _D_;
-	_D_ = (uint16_t)(65536 * voltage / Vref);
-    
-	return _D_;
-}
-
-/*
-*********************************************************************************************************
-*	name: main
-*	function:  
-*	parameter: NULL
-*	The return value:  NULL
-*********************************************************************************************************
-*
-*   Desta parte para baixo, o codigo foi modificado por Fabio Franco de Oliveira. Email: fabioti6@gmail.com
-*   Foi necessaria a eliminacao do laco principal para leitura de todos os ADCs, sendo
-*   modificado para leitura de somente 1 ADC por vez mediante a passagem de parametros especificando qual 
-*   o canal, ganho e sample rate. Problemas envolvendo a sincronizacao do protocolo SPI precisaram ser 
-*   resolvidos para viabilizar a execuo do "ads1256_test" fora do loop. 
-*   Ultima alteracao: 21/05/2016
-*
-*********************************************************************************************************
-*/
-
-int  adcStart(int argc, char *par1, char *par2, char *par3)
-{
-    uint8_t id;
-    uint8_t i,x,y;
-
-    int ads_gain;
-    int ads_channel;
-    int ads_sps;
-
-
-    if (!bcm2835_init())
-        return 1;
-    
-    bcm2835_spi_begin();
-    bcm2835_spi_setBitOrder(BCM2835_SPI_BIT_ORDER_LSBFIRST );     // The default
-    bcm2835_spi_setDataMode(BCM2835_SPI_MODE1);                   // The default
-    bcm2835_spi_setClockDivider(BCM2835_SPI_CLOCK_DIVIDER_1024);  // The default
-    bcm2835_gpio_fsel(SPICS, BCM2835_GPIO_FSEL_OUTP);//
-    bcm2835_gpio_write(SPICS, HIGH);
-    bcm2835_gpio_fsel(DRDY, BCM2835_GPIO_FSEL_INPT);
-    bcm2835_gpio_set_pud(DRDY, BCM2835_GPIO_PUD_UP);    	
-    
-    id = ADS1256_ReadChipID();
-   
-	if (id != 3)
-	{
-		printf("Error, ASD1256 Chip ID = 0x%d\r\n", (int)id);
-	}
-	else
-	{
-		//printf("Ok, ASD1256 Chip ID = 0x%d\r\n", (int)id);    // Linha comentada propositalmente
-	}
-
-
-   
-   // Nao faz nada se passar poucos argumentos
-   if( argc != 4 ) {                                
-      printf("Este programa requer 3 parametros: canal, ganho e datarate.\n");  
-   }
-
-
-   
-   // Somente executa caso tenham sido passados os 3 argumentos necessarios
-   else									   
-   { 
-        
- 		// Analisa o primeiro argumento: o canal
-        if (strcmp((par1), "0") == 0) 
-			{  ads_channel=0;  } 
-		else if (strcmp((par1), "1") == 0) 
-			{  ads_channel=1;  }
-		else if (strcmp((par1), "2") == 0) 
-		    {  ads_channel=2;  }
-		else if (strcmp((par1), "3") == 0) 
-			{  ads_channel=3;  }
-		else if (strcmp((par1), "4") == 0) 
-			{  ads_channel=4;  } 
-		else if (strcmp((par1), "5") == 0) 
-			{  ads_channel=5;  }
-		else if (strcmp((par1), "6") == 0) 
-			{  ads_channel=6;  } 
-		else if (strcmp((par1), "7") == 0) 
-		    {  ads_channel=7;  }
-
-		// Se no for nenhum destes parametros, ento foi setado errado atribuindo portanto '666' para a variavel ads_channel
-		else  
-		{ 
-			printf ("Incorrectly set channel: %s\n", par1);      
-			printf ("CHANNEL setting must be either of the following: 0, 1, 2, 3, 4, 5, 6, 7\n\n");  
-			ads_channel=666;  
-		}
-
-
-		// Analisa o segundo argumento: o ganho
-        if (strcmp((par2), "1") == 0) 
-			{  ads_gain=0;  } 
-		else if (strcmp((par2), "2") == 0) 
-	    	{  ads_gain=1;  } 
-		else if (strcmp((par2), "4") == 0) 
-	    	{  ads_gain=2;  } 
-		else if (strcmp((par2), "8") == 0) 
-			{  ads_gain=3;  }  
-		else if (strcmp((par2), "16") == 0) 
-			{  ads_gain=4;  }  
-		else if (strcmp((par2), "32") == 0) 
-	    	{  ads_gain=5;  } 
-		else if (strcmp((par2), "64") == 0) 
-			{  ads_gain=6;  }  
-		
-		// Se no for nenhum destes parametros, ento foi setado errado atribuindo portanto '666' para a variavel ads_gain
-		else  
-		{ 
-			printf ("Incorrectly set GAIN: %s\n", par2);   
-			printf ("GAIN setting must be either of the following: 1, 2, 4, 8, 16, 32, 64\n\n");        
-			ads_gain=666;  
-		}
-
-
- 	    // Analisa o terceiro argumento: o sps
-        if (strcmp((par3), "2d5") == 0) 
-			{  ads_sps=15;  } 
-		else if (strcmp((par3), "5") == 0) 
-	    	{  ads_sps=14;  } 
-		else if (strcmp((par3), "10") == 0) 
-	    	{  ads_sps=13;  } 
-		else if (strcmp((par3), "15") == 0) 
-			{  ads_sps=12;  }  
-		else if (strcmp((par3), "25") == 0) 
-			{  ads_sps=11;  }  
-		else if (strcmp((par3), "30") == 0) 
-	    	{  ads_sps=10;  } 
-		else if (strcmp((par3), "50") == 0) 
-			{  ads_sps=9;  }  
-		else if (strcmp((par3), "60") == 0) 
-			{  ads_sps=8;  }  
-		else if (strcmp((par3), "100") == 0) 
-			{  ads_sps=7;  }  
-		else if (strcmp((par3), "500") == 0) 
-			{  ads_sps=6;  }  
-		else if (strcmp((par3), "1000") == 0) 
-			{  ads_sps=5;  }  
-		else if (strcmp((par3), "2000") == 0) 
-			{  ads_sps=4;  }  
-		else if (strcmp((par3), "3750") == 0) 
-			{  ads_sps=3;  }  
-		else if (strcmp((par3), "7500") == 0) 
-			{  ads_sps=2;  }  
-		else if (strcmp((par3), "15000") == 0) 
-			{  ads_sps=1;  }  
-		else if (strcmp((par3), "30000") == 0) 
-			{  ads_sps=0;  } 
-		
-		// Se no for nenhum destes parametros, ento foi setado errado atribuindo portanto '666' para a variavel ads_sps
-		else  
-		{ 
-			printf ("Incorrectly set channel SPS: %s\n", par3); 
-			printf ("SPS setting must be either of the following: 2d5, 5, 10, 15, 25, 30, 50, 60, 100, 500, 1000, 2000, 3750, 7500, 15000, 30000\n\n");     
-			ads_sps=666;  
-		}
-
-
-		// Se um dos parametros ficou marcado como '666', ento h erros e portanto exibe a mensagem de erro.
-        if ((ads_channel==666) || (ads_gain==666) || (ads_sps==666))
-        	{
-        		printf ("Please Review ADC settings! Exiting...\n\n");
-        	}
-
-        else
-        {
-
-            ADS1256_CfgADC(ads_gain, ads_sps);
-            ADS1256_StartScan(0);
-
-            // Loop de inicializao 
-            for (x = 0; x < 9; x++)
-            {
-                for (y = 0; y < 8000; y++)
-                {
-
-                     if (bcm2835_gpio_lev(DRDY)==0)
-                 {
-                    ADS1256_ISR();
-                    break;
-                     }      
-                }
-            }
-
-            return 0; // retorna zero para dizer iniciou ok
-        }
-   }
-
-    return 1; // problema, parametros errados etc...
-}
-
-
-
- // Funcao a qual o nome precisa bater com o wrapper
-long int readChannels(long int *valorCanal){
-    int i;
-    uint32_t adc[8];
-    uint8_t buf[3];
-
-	for (i = 0; i < 8; i++)
-	{
-        while((ADS1256_Scan() == 0));
-
-        adc[i] = ADS1256_GetAdc(i);
-        buf[0] = ((uint32_t)adc[i] >> 16) & 0xFF;
-        buf[1] = ((uint32_t)adc[i] >> 8) & 0xFF;
-        buf[2] = ((uint32_t)adc[i] >> 0) & 0xFF;
-        valorCanal[i]=  (long)adc[i]; 
-        bsp_DelayUS(1);	
-	}
-    return 0;
-}
-
-
-long int readChannel(long int ch){
-    long int ChValue;
-    uint32_t adc[0];
-    uint8_t buf[3];
-
-	 
-        while((ADS1256_Scan() == 0));
-
-        adc[ch] = ADS1256_GetAdc(ch);
-        buf[0] = ((uint32_t)adc[ch] >> 16) & 0xFF;
-        buf[1] = ((uint32_t)adc[ch] >> 8) & 0xFF;
-        buf[2] = ((uint32_t)adc[ch] >> 0) & 0xFF;
-        ChValue =  (long)adc[ch]; 
-        bsp_DelayUS(1);	
-	 
-    return ChValue;
-}
-
-
-
-int adcStop(void){
-    bcm2835_spi_end();
-    bcm2835_close();
-    return 0;
-}
+/*
+ * ADS1256_test.c:
+ *	Very simple program to test the serial port. Expects
+ *	the port to be looped back to itself
+ *
+ */
+ 
+/*
+             define from bcm2835.h                       define from Board DVK511
+                 3.3V | | 5V               ->                 3.3V | | 5V
+    RPI_V2_GPIO_P1_03 | | 5V               ->                  SDA | | 5V 
+    RPI_V2_GPIO_P1_05 | | GND              ->                  SCL | | GND
+       RPI_GPIO_P1_07 | | RPI_GPIO_P1_08   ->                  IO7 | | TX
+                  GND | | RPI_GPIO_P1_10   ->                  GND | | RX
+       RPI_GPIO_P1_11 | | RPI_GPIO_P1_12   ->                  IO0 | | IO1
+    RPI_V2_GPIO_P1_13 | | GND              ->                  IO2 | | GND
+       RPI_GPIO_P1_15 | | RPI_GPIO_P1_16   ->                  IO3 | | IO4
+                  VCC | | RPI_GPIO_P1_18   ->                  VCC | | IO5
+       RPI_GPIO_P1_19 | | GND              ->                 MOSI | | GND
+       RPI_GPIO_P1_21 | | RPI_GPIO_P1_22   ->                 MISO | | IO6
+       RPI_GPIO_P1_23 | | RPI_GPIO_P1_24   ->                  SCK | | CE0
+                  GND | | RPI_GPIO_P1_26   ->                  GND | | CE1
+
+::if your raspberry Pi is version 1 or rev 1 or rev A
+RPI_V2_GPIO_P1_03->RPI_GPIO_P1_03
+RPI_V2_GPIO_P1_05->RPI_GPIO_P1_05
+RPI_V2_GPIO_P1_13->RPI_GPIO_P1_13
+::
+*/
+
+#define _GNU_SOURCE		/* ppoll() */
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include "wrapper.h"
+#include "ads1256_regs.h"
+#include "ads1256_transport.h"
+#include "ads1256_log.h"
+#include "ads1256_volts.h"
+#include "ads1256_filter.h"
+#include "ads1256_trigger.h"
+#include "ads1256_control.h"
+
+/* The pins and the SPI bus are reached through the selected transport, see ads1256_bcm2835.c.
+   Each frame on the ADS1256 is one transaction on the shared bus: CS_0 takes it, CS_1 gives it back */
+#define CS_1()	do { g_tADS1256.Transport->SetCS(g_tADS1256.CsPin, 1); BUS_UNLOCK(); } while (0)
+#define CS_0()	do { BUS_LOCK(); g_tADS1256.Transport->SetCS(g_tADS1256.CsPin, 0); } while (0)
+
+#define DAC_CS_1()	g_tADS1256.Transport->SetCS(g_tDac.CsPin, 1)
+#define DAC_CS_0()	g_tADS1256.Transport->SetCS(g_tDac.CsPin, 0)
+
+#define DRDY_IS_LOW()	((g_tADS1256.Transport->DrdyLevel(g_tADS1256.DrdyPin)==0))
+
+
+
+/* Unsigned integer types  */
+#define uint8_t unsigned char
+#define uint16_t unsigned short    
+#define uint32_t unsigned long     
+
+
+
+
+typedef enum {FALSE = 0, TRUE = !FALSE} bool;
+
+
+/* gain channelî */
+typedef enum
+{
+	ADS1256_GAIN_1			= (0),	/* GAIN   1 */
+	ADS1256_GAIN_2			= (1),	/*GAIN   2 */
+	ADS1256_GAIN_4			= (2),	/*GAIN   4 */
+	ADS1256_GAIN_8			= (3),	/*GAIN   8 */
+	ADS1256_GAIN_16			= (4),	/* GAIN  16 */
+	ADS1256_GAIN_32			= (5),	/*GAIN    32 */
+	ADS1256_GAIN_64			= (6),	/*GAIN    64 */
+}ADS1256_GAIN_E;
+
+/* Sampling speed choice*/
+/* 
+	11110000 = 30,000SPS (default)
+	11100000 = 15,000SPS
+	11010000 = 7,500SPS
+	11000000 = 3,750SPS
+	10110000 = 2,000SPS
+	10100001 = 1,000SPS
+	10010010 = 500SPS
+	10000010 = 100SPS
+	01110010 = 60SPS
+	01100011 = 50SPS
+	01010011 = 30SPS
+	01000011 = 25SPS
+	00110011 = 15SPS
+	00100011 = 10SPS
+	00010011 = 5SPS
+	00000011 = 2.5SPS
+*/
+typedef enum
+{
+	ADS1256_30000SPS = 0,
+	ADS1256_15000SPS = 1,
+	ADS1256_7500SPS = 2,
+	ADS1256_3750SPS = 3,
+	ADS1256_2000SPS = 4,
+	ADS1256_1000SPS = 5,
+	ADS1256_500SPS = 6,
+	ADS1256_100SPS = 7,
+	ADS1256_60SPS = 8,
+	ADS1256_50SPS = 9,
+	ADS1256_30SPS = 10,
+	ADS1256_25SPS = 11,
+	ADS1256_15SPS = 12,
+	ADS1256_10SPS = 13,
+	ADS1256_5SPS = 14,
+	ADS1256_2d5SPS = 15,
+
+	ADS1256_DRATE_MAX
+}ADS1256_DRATE_E;
+
+#define ADS1256_DRAE_COUNT = 15;
+
+/* Master clock of the ADS1256 on the AD/DA board. Every delay of the serial interface is a number
+   of tCLKIN periods (Table 6 --- ADS1256 datasheet Page 6) */
+#define ADS1256_CLKIN_HZ		7680000
+#define ADS1256_CLKIN_US(n)		(((n) * 1000000UL + ADS1256_CLKIN_HZ - 1) / ADS1256_CLKIN_HZ)	/* rounded up */
+
+#define ADS1256_SCLK_MAX_HZ		(ADS1256_CLKIN_HZ / 4)	/* t1: SCLK period at least 4 tCLKIN, 1.92 MHz */
+#define ADS1256_SCLK_MIN_HZ		4000					/* Largest bcm2835 divider is 65536 */
+#define ADS1256_SCLK_DEFAULT_HZ	ADS1256_SCLK_MAX_HZ		/* The MUX switch of a scan then fits in a conversion up to 15000 SPS */
+
+/* Delays between SPI transactions, derived from CLKIN once the SPI clock is known */
+typedef struct
+{
+	uint32_t SclkHz;			/* SPI clock actually running */
+	uint32_t T6Us;				/* RDATA, RDATAC, RREG to the first DOUT clock: 50 tCLKIN */
+	uint32_t T11Us;				/* After WREG, RREG, RDATA, WAKEUP to the next command: 4 tCLKIN */
+	uint32_t T11SyncUs;			/* After SYNC, RDATAC, RESET to the next command: 24 tCLKIN */
+}ADS1256_TIMING_T;
+
+/* One entry of the scan list: an input pair converted Repeat times in a row */
+typedef struct
+{
+	uint8_t Mux;				/* MUX register, AINP << 4 | AINN */
+	uint8_t Gain;				/* ADS1256_GAIN_E, ADS1256_GAIN_DEFAULT for the gain of ADS1256_CfgADC, or ADS1256_GAIN_AUTO */
+	uint8_t Repeat;				/* Conversions per pass, at least 1 */
+}ADS1256_SCAN_ENTRY_T;
+
+#define ADS1256_AINCOM			8		/* PSEL3 / NSEL3 set */
+#define ADS1256_GAIN_DEFAULT	0xFF
+#define ADS1256_GAIN_AUTO		0xFE	/* Auto-ranged: results are normalised to counts at 64x */
+
+/* Auto-ranging thresholds on the magnitude of a result */
+#define ADS1256_AUTO_CLIP		0x7FFFFF	/* Clipped: the input is out of range, restart from 1x */
+#define ADS1256_AUTO_HIGH		0x780000	/* Above 15/16 of full scale: one gain step down */
+#define ADS1256_AUTO_UP			0x600000	/* A step up is taken while the doubled result stays below 3/4 */
+
+/* Bus and chip errors, for get_stats() */
+typedef struct
+{
+	uint32_t Timeouts;			/* DRDY waits that gave up */
+	uint32_t Resyncs;			/* Calls to ADS1256_Resync */
+	uint32_t DeviceErrors;		/* Chip ID checks that failed: the chip does not answer */
+	uint32_t Late;				/* Conversions dropped by ADS1256_CycleMux: the frame was held up */
+	int LastError;				/* errno of the last of them, 0 if none */
+}ADS1256_STATS_T;
+
+typedef struct
+{
+	ADS1256_GAIN_E Gain;		/* GAIN  */
+	ADS1256_DRATE_E DataRate;	/* DATA output  speed*/
+	int32_t AdcNow[ADS1256_SCAN_MAX];	/* ADC  Conversion value, one per scan list entry */
+	uint8_t AdcPga[ADS1256_SCAN_MAX];	/* PGA each AdcNow value was converted at */
+	uint8_t AutoPga[ADS1256_SCAN_MAX];	/* PGA of the next conversion of each auto-ranged entry */
+	uint8_t ConvPga;			/* PGA of the conversion in progress */
+	int64_t AdcTime[ADS1256_SCAN_MAX];	/* DRDY falling edge of each AdcNow value, CLOCK_MONOTONIC_RAW ns */
+	int64_t DrdyTime;			/* Last DRDY falling edge seen by ADS1256_WaitDRDYTimeout */
+	int64_t DrdySince;			/* That edge came after this (DRDY read high), 0 if it was low from the start */
+	uint8_t Channel;			/* The current channel (scan list entry) */
+	uint8_t ScanMode;	/*Scanning mode,   0  Single-ended input  8 channel£¬ 1 Differential input  4 channel, 2 scan list */
+	ADS1256_SCAN_ENTRY_T ScanList[ADS1256_SCAN_MAX];
+	uint8_t ScanCount;			/* Entries in ScanList */
+	uint8_t Repeat;				/* Conversions already started on the current entry */
+	uint8_t Pga;				/* PGA setting currently written in ADCON */
+	uint8_t Continuous;	/* 1 while the chip is in Read Data Continuously (RDATAC) mode */
+	uint8_t DrdyMode;			/* ADS1256_DRDY_POLL or ADS1256_DRDY_EVENT */
+	int DrdyFd;					/* gpiochip line-event fd for the DRDY falling edge, -1 if none */
+	uint32_t DrdyTimeoutUs;		/* How long ADS1256_WaitDRDY waits before giving up */
+	const ADS1256_TRANSPORT_T *Transport;	/* SPI, CS, DRDY and delays */
+	int CsPin;					/* Pins of this board, in the numbering of the transport */
+	int DrdyPin;
+	uint8_t Opened;				/* 1 between a successful Transport->Init and adcStop */
+	ADS1256_TIMING_T Timing;	/* Set by ADS1256_SetClock */
+	uint8_t Converting;			/* Channel ID of the conversion in progress, ADS1256_CH_NONE if unknown */
+	float Vref;					/* Reference voltage, for the conversion to volts */
+	uint8_t CalPga;				/* PGA whose coefficients are in OFC/FSC, ADS1256_GAIN_DEFAULT if unknown */
+	uint8_t Status;				/* STATUS register as last written: ACAL and BUFEN */
+	uint8_t Buffer;				/* 1 to enable the analog input buffer (BUFEN) */
+	uint8_t Adcon;				/* ADCON bits above the PGA: clock out rate (CLK1-0) and sensor detect (SDCS1-0) */
+	uint8_t DrdyLate;			/* 1 after a DRDY wait timed out, until DRDY is seen low again */
+	int Fault;					/* First error since the glue last cleared it, 0 if none */
+	ADS1256_STATS_T Stats;
+}ADS1256_VAR_T;
+
+#define ADS1256_CH_NONE		0xFF	/* MUX was changed outside the cycling engine */
+
+/* How ADS1256_WaitDRDY waits for the falling edge of DRDY */
+enum
+{
+	ADS1256_DRDY_POLL  = 0,		/* Spin on the GPIO level register (default) */
+	ADS1256_DRDY_EVENT = 1,		/* Sleep in poll() on a gpiochip line-event fd */
+};
+
+#define ADS1256_DRDY_TIMEOUT_US		2000000		/* Long enough for a self-calibration at 2.5 SPS */
+#define ADS1256_DRDY_NAP_US			200			/* Poll mode: sleep between level checks once DRDY is overdue */
+#define ADS1256_WARMUP_US			10000		/* start(): longest wait for each conversion filling the pipeline */
+
+#define ADS1256_WINDOW_MAX		64		/* Trigger windows waiting to be read, power of two */
+#define ADS1256_RING_MAX		(1UL << 24)	/* Largest ring capacity, samples or group frames */
+
+/* Single producer / single consumer sample ring, filled by the acquisition thread */
+typedef struct
+{
+	ADS1256_SAMPLE_T *Buf;
+	uint32_t Size;				/* Number of slots, power of two */
+	uint32_t Head;				/* Next slot to write, only the producer stores it */
+	uint32_t Tail;				/* Next slot to read, only the consumer stores it */
+	uint32_t Dropped;			/* Samples lost because the ring was full */
+}ADS1256_RING_T;
+
+typedef struct
+{
+	ADS1256_RING_T Ring;
+	pthread_t Thread;
+	volatile int Running;		/* Cleared to ask the thread to exit */
+	uint8_t Active;				/* 1 while the thread owns the SPI bus */
+	ADS1256_FILTER_T Filter[ADS1256_SCAN_MAX];	/* Per scan list entry, only changed while the thread is stopped */
+	ADS1256_GROUP_T *Group;		/* Group the device converts in, its thread stands in for this one */
+	ADS1256_TRIGGER_T Trigger;	/* Only changed while the thread is stopped, except ADS1256_TriggerArm */
+	ADS1256_WINDOW_T Win[ADS1256_WINDOW_MAX];	/* Trigger windows complete in the ring, oldest first */
+	uint32_t WinHead;			/* Next window to store, only the thread stores it */
+	uint32_t WinTail;			/* Next window to read, only the consumer stores it */
+	ADS1256_WINDOW_T WinNow;	/* Window being filled */
+	ADS1256_CONTROL_T Control;	/* Only set up while the thread is stopped; setpoint and tuning at any time */
+}ADS1256_ACQ_T;
+
+/* Boards converting in step (ADS1256_GroupThread). Every board runs the same number of
+   conversions per pass; a frame holds one pass of each, board after board. */
+struct ADS1256_GROUP
+{
+	ADS1256_DEV_T *Dev[ADS1256_GROUP_MAX];
+	uint8_t Count;
+	uint32_t Slots;				/* Conversions per pass, the same on every board */
+	uint32_t Width;				/* Values per frame, Count * Slots */
+	int32_t *Values;			/* Frame ring: Size frames of Width values ... */
+	int64_t *Times;				/* ... and their DRDY timestamps */
+	uint32_t Size;				/* Number of frames, power of two */
+	uint32_t Head;				/* Next frame to fill, only the group thread stores it */
+	uint32_t Tail;				/* Next frame to read, only the consumer stores it */
+	uint32_t Dropped;			/* Frames lost because the ring was full */
+	uint32_t Frames;			/* Frames completed, dropped ones included */
+	uint32_t Restarts;			/* Boards brought back after a DRDY timeout, the partial frame is lost */
+	int64_t SkewNs;				/* Widest spread of the DRDY times of one step */
+	pthread_t Thread;
+	volatile int Running;		/* Cleared to ask the thread to exit */
+	uint8_t Active;				/* 1 while the thread owns the boards */
+};
+
+#define ADS1256_VREF_VOLTS		2.5f	/* Reference on the AD/DA board */
+#define ADS1256_VREF_MIN		0.5		/* VREFP - VREFN accepted by the ADS1256 */
+#define ADS1256_VREF_MAX		2.6
+#define ADS1256_LOG_ALIGN		4096	/* O_DIRECT buffer, offset and length alignment */
+
+/* Native binary logger: a writer thread fed by the acquisition thread through its own ring */
+typedef struct
+{
+	ADS1256_RING_T Ring;		/* Filled by the acquisition thread, drained by the writer */
+	pthread_t Thread;
+	volatile int Running;		/* Cleared to ask the writer to drain the ring and exit */
+	uint8_t Active;				/* 1 while the acquisition thread feeds the ring */
+	char Path[240];				/* Base name, files are <Path>-NNNNNN.ads */
+	int Fd;
+	int Direct;					/* Files are opened with O_DIRECT */
+	uint64_t RotateBytes;		/* Start a new file past this size, 0 = never */
+	int64_t RotateNs;			/* Start a new file after this much sample time, 0 = never */
+	uint8_t *Buf;				/* Write buffer, ADS1256_LOG_ALIGN aligned */
+	uint32_t BufSize;			/* Multiple of ADS1256_LOG_ALIGN */
+	uint32_t BufLen;
+	uint64_t FileBytes;			/* Bytes of the current file already written */
+	int64_t FileStartNs;		/* Timestamp of the first record of the current file, 0 if none yet */
+	uint64_t Written;			/* Bytes written over all files */
+	uint32_t Files;				/* Files opened */
+	uint32_t Errors;			/* Failed open/write calls */
+	int LastErrno;
+	uint32_t Dropped;			/* Samples not written: no open file, plus the ring overflows once stopped */
+	ADS1256_LOG_HEADER_T Header;	/* Written at the start of every file */
+	uint8_t Seq[ADS1256_SLOT_MAX];	/* Scan list entry of each record slot */
+	uint32_t SeqLen;			/* Slots per record, Header.ScanLength */
+	uint32_t SeqPos;			/* Slot the next sample is expected in */
+	uint8_t *Rec;				/* Record being filled, Header.RecordSize bytes */
+	uint32_t RecFill;			/* Samples stored in Rec */
+	int64_t RecStartNs;			/* Timestamp of the first of them */
+}ADS1256_LOG_T;
+
+/* Offset and full-scale calibration coefficients of one (PGA, DRATE) setting */
+typedef struct
+{
+	uint8_t Valid;
+	uint8_t Reg[6];				/* OFC0, OFC1, OFC2, FSC0, FSC1, FSC2 as the chip stores them, LSB first */
+}ADS1256_CAL_T;
+
+/* Calibration cache: every setting calibrated so far, kept in a text file so that start() can
+   write the coefficients back instead of running a self-calibration */
+typedef struct
+{
+	char Path[240];				/* Cache file, empty if the cache is not kept on disk */
+	ADS1256_CAL_T Entry[ADS1256_GAIN_64 + 1][ADS1256_DRATE_MAX];
+}ADS1256_CAL_CACHE_T;
+
+#define ADS1256_DAC_SCLK_HZ		10000000	/* The DAC8552 takes up to 30 MHz, the ADS1256 clock is put back after it */
+#define ADS1256_DAC_VREF_VOLTS	5.0f		/* DAC8552 reference on the AD/DA board */
+#define ADS1256_DAC_SPIN_US		50			/* Playback: sleep until this close to a frame, then spin */
+
+/* DAC8552 control byte: buffer B instead of A, load DAC A and/or B from their buffers */
+#define DAC_BUF_B	0x04
+#define DAC_LDA		0x10
+#define DAC_LDB		0x20
+
+/* DAC8552 of the board and its playback thread. The thread writes Cur frame after frame at a fixed
+   rate; the next buffer waits in Next and takes over at the end of a pass (double buffering). */
+typedef struct
+{
+	int CsPin;					/* In the numbering of the transport, -1 if the board has no DAC */
+	float Vref;
+	uint16_t Code[2];			/* Last codes loaded in DAC A and B */
+	pthread_mutex_t Lock;		/* Guards the buffers and starting and stopping the thread. Before s_BusLock */
+	pthread_cond_t Cond;		/* Signalled when Next is taken or the thread stops */
+	pthread_t Thread;
+	volatile int Running;		/* Cleared to ask the thread to exit */
+	uint8_t Active;				/* 1 from the start of the thread until it is joined */
+	uint8_t Channels;			/* ADS1256_DAC_A, _B or _AB: codes per frame 1, 1 or 2 */
+	uint8_t Loop;				/* Repeat Cur until a buffer is queued */
+	uint8_t Starved;			/* Not looping and nothing queued: the outputs hold the last frame */
+	uint8_t Realtime;			/* The thread got SCHED_FIFO */
+	int64_t PeriodNs;
+	uint16_t *Cur;				/* Buffer playing, CurLen frames */
+	uint32_t CurLen;
+	uint16_t *Next;				/* Buffer queued, NULL if none */
+	uint32_t NextLen;
+	uint16_t *Spent;			/* Buffer played out, freed by the next caller that queues one */
+	uint32_t Frames;			/* Frames written */
+	uint32_t Late;				/* Frames left out because the thread woke up after they were due */
+	uint32_t Underruns;			/* Ends of a buffer with nothing queued, not looping */
+	uint32_t Buffers;			/* Queued buffers taken over */
+}ADS1256_DAC_T;
+
+
+
+#ifdef ADS1256_NO_BCM2835
+#define ADS1256_DEFAULT_TRANSPORT	g_tTransportSim
+#else
+#define ADS1256_DEFAULT_TRANSPORT	g_tTransportBcm2835
+#endif
+
+/* One board: the driver state, its acquisition and log threads and its calibration cache.
+   Several boards share the SPI bus, each on its own CS and DRDY pins. */
+struct ADS1256_DEV
+{
+	ADS1256_VAR_T Var;
+	ADS1256_ACQ_T Acq;
+	ADS1256_LOG_T Log;
+	ADS1256_CAL_CACHE_T Cal;
+	ADS1256_DAC_T Dac;
+	pthread_mutex_t AcqLock;	/* See ACQ_LOCK */
+	pthread_mutex_t DevLock;	/* See DEV_LOCK */
+};
+
+/* The device the calling thread works on: set by each glue function from its first argument and
+   by the acquisition and log threads when they start. The driver reaches its state through it. */
+static __thread ADS1256_DEV_T *s_pDev;
+
+#define g_tADS1256	(s_pDev->Var)
+#define g_tAcq		(s_pDev->Acq)
+#define g_tLog		(s_pDev->Log)
+#define g_tCal		(s_pDev->Cal)
+#define g_tDac		(s_pDev->Dac)
+
+/* Serialises the SPI transactions of all the devices and of the DACs, and the transport itself. It is
+   held for one frame (CS_0 to CS_1) at a time, never across a DRDY wait, so the boards and the DAC
+   playback interleave frame by frame. A thread may take it again while it holds it. */
+static pthread_mutex_t s_BusLock = PTHREAD_MUTEX_INITIALIZER;
+static __thread uint32_t s_BusDepth;	/* How many times the calling thread holds s_BusLock */
+static ADS1256_DEV_T *s_pBusOwner;		/* Device whose SPI clock the bus runs at */
+static uint8_t s_BusDac;				/* 1 while it runs at ADS1256_DAC_SCLK_HZ, s_pBusOwner is then NULL */
+
+#define BUS_LOCK()		ADS1256_BusLock()
+#define BUS_UNLOCK()	ADS1256_BusUnlock()
+
+/* Serialises the conversion sequences of a device and guards its state. The Python wrapper releases
+   the GIL around blocking reads, so Python threads and the acquisition threads may call in at once;
+   a read holds it through its DRDY waits, which stalls that board only. */
+#define DEV_LOCK()		pthread_mutex_lock(&s_pDev->DevLock)
+#define DEV_UNLOCK()	pthread_mutex_unlock(&s_pDev->DevLock)
+
+/* Guards starting and stopping the acquisition thread of a device against the ring consumer. It is
+   never held by the acquisition thread itself, so the producer side of the ring stays lock free.
+   Lock order: AcqLock before DevLock. */
+#define ACQ_LOCK()		pthread_mutex_lock(&s_pDev->AcqLock)
+#define ACQ_UNLOCK()	pthread_mutex_unlock(&s_pDev->AcqLock)
+
+/* Serialises starting, stopping and reading the groups.
+   Lock order: AcqLock, s_GroupLock, g_tDac.Lock, DevLock (in group order), s_BusLock */
+static pthread_mutex_t s_GroupLock = PTHREAD_MUTEX_INITIALIZER;
+
+/* The SPI clock is shared: each device gets its own back when it takes the bus after another one.
+   ADS1256_BusOwn does the same for a thread that moves to another device with the bus held. */
+static void ADS1256_BusOwn(void)
+{
+	if ((s_pBusOwner != s_pDev) && g_tADS1256.Opened)
+	{
+		g_tADS1256.Transport->SetClock(g_tADS1256.Timing.SclkHz);
+		s_pBusOwner = s_pDev;
+		s_BusDac = 0;
+	}
+}
+
+static void ADS1256_BusLock(void)
+{
+	if (s_BusDepth++ == 0)
+	{
+		pthread_mutex_lock(&s_BusLock);
+	}
+	ADS1256_BusOwn();
+}
+
+static void ADS1256_BusUnlock(void)
+{
+	if (--s_BusDepth == 0)
+	{
+		pthread_mutex_unlock(&s_BusLock);
+	}
+}
+static const uint8_t s_tabDataRate[ADS1256_DRATE_MAX] =
+{
+	0xF0,		/*reset the default values  */
+	0xE0,
+	0xD0,
+	0xC0,
+	0xB0,
+	0xA1,
+	0x92,
+	0x82,
+	0x72,
+	0x63,
+	0x53,
+	0x43,
+	0x33,
+	0x23,
+	0x13,
+	0x03
+};
+
+/* start() settings in the units the user gives them, indexed by their register code. Filled in
+   by the compiler, so a setting is checked with a table lookup and nothing is parsed at run time */
+static const uint32_t s_tabSpsTenths[ADS1256_DRATE_MAX] =	/* SPS x 10, by ADS1256_DRATE_E */
+{
+	300000, 150000, 75000, 37500, 20000, 10000, 5000, 1000, 600, 500, 300, 250, 150, 100, 50, 25
+};
+
+static const uint32_t s_tabSettleUs[ADS1256_DRATE_MAX] =	/* Settling time after WAKEUP in us, datasheet Table 13 */
+{
+	210, 250, 310, 440, 680, 1180, 2180, 10180, 16840, 20180, 33510, 40180, 66840, 100180, 200180, 400180
+};
+
+static const uint8_t s_tabGainPga[64 + 1] =		/* ADS1256_GAIN_E + 1 by gain, 0 = not a gain */
+{
+	[1] = ADS1256_GAIN_1 + 1, [2] = ADS1256_GAIN_2 + 1, [4] = ADS1256_GAIN_4 + 1, [8] = ADS1256_GAIN_8 + 1,
+	[16] = ADS1256_GAIN_16 + 1, [32] = ADS1256_GAIN_32 + 1, [64] = ADS1256_GAIN_64 + 1
+};
+
+static const uint32_t s_tabClkOut[4] =			/* D0/CLKOUT frequency in Hz, by CLK1-0 */
+{
+	0, ADS1256_CLKIN_HZ, ADS1256_CLKIN_HZ / 2, ADS1256_CLKIN_HZ / 4
+};
+
+static const uint32_t s_tabSdcsTenths[4] =		/* Sensor detect current in uA x 10, by SDCS1-0 */
+{
+	0, 5, 20, 100
+};
+
+
+
+
+
+
+
+void  bsp_DelayUS(uint64_t micros);
+void ADS1256_StartScan(uint8_t _ucScanMode);
+static uint8_t ADS1256_MixedGains(uint8_t _gain);
+static uint8_t ADS1256_EntryPga(uint8_t _entry);
+static int32_t ADS1256_AutoRange(uint8_t _entry, int32_t _value, uint8_t _pga);
+int ADS1256_Configure(ADS1256_GAIN_E _gain, ADS1256_DRATE_E _drate, uint8_t _buffer);
+static void ADS1256_Send8Bit(uint8_t _data);
+static void ADS1256_SendBurst(uint8_t *_buf, uint32_t _len);
+void ADS1256_CfgADC(ADS1256_GAIN_E _gain, ADS1256_DRATE_E _drate);
+static void ADS1256_DelayDATA(void);
+uint32_t ADS1256_SetClock(uint32_t _hz);
+static uint8_t ADS1256_Recive8Bit(void);
+static void ADS1256_WriteReg(uint8_t _RegID, uint8_t _RegValue);
+static uint8_t ADS1256_ReadReg(uint8_t _RegID);
+static void ADS1256_WriteCmd(uint8_t _cmd);
+uint8_t ADS1256_ReadChipID(void);
+void ADS1256_ReadCal(uint8_t *_reg);
+static void ADS1256_WriteCal(const uint8_t *_reg);
+static void ADS1256_CalLoad(uint8_t _gain);
+int ADS1256_Calibrate(uint8_t _cmd, uint8_t _entry);
+int ADS1256_CalCacheLoad(const char *_path);
+static int ADS1256_CalCacheSave(void);
+static uint8_t ADS1256_MuxPair(uint8_t _ainp, uint8_t _ainn);
+static uint8_t ADS1256_MuxWrite(uint8_t *_buf, uint8_t _mux, uint8_t _gain);
+void ADS1256_SetScanList(const ADS1256_SCAN_ENTRY_T *_list, uint8_t _count);
+static int32_t ADS1256_Decode24(const uint8_t *_buf);
+static int32_t ADS1256_CycleHold(uint8_t *_buf, uint8_t _len, uint8_t _gain);
+static int32_t ADS1256_CycleMux(uint8_t _mux, uint8_t _gain);
+static int ADS1256_WaitDRDY(void);
+int ADS1256_Resync(void);
+static int ADS1256_WaitDRDYTimeout(uint32_t _us);
+int64_t ADS1256_NowRaw(void);
+static int64_t ADS1256_EventToRaw(uint64_t _ts);
+int ADS1256_SetDrdyWait(uint8_t _mode, uint32_t _timeoutUs, const char *_chip);
+void ADS1256_StartContinuous(uint8_t _ch);
+int32_t ADS1256_ReadContinuous(void);
+void ADS1256_StopContinuous(void);
+
+int32_t ADS1256_GetAdc(uint8_t _ch);
+int ADS1256_ISR(void);
+static int ADS1256_ScanNext(int32_t _value, uint8_t _pga);
+uint8_t ADS1256_Scan(void);
+uint32_t ADS1256_ScanLength(void);
+uint32_t ADS1256_RingSize(uint32_t _size);
+int ADS1256_RingInit(ADS1256_RING_T *_ring, uint32_t _size);
+void ADS1256_RingFree(ADS1256_RING_T *_ring);
+static int ADS1256_RingPush(ADS1256_RING_T *_ring, const ADS1256_SAMPLE_T *_s);
+uint32_t ADS1256_RingRead(ADS1256_RING_T *_ring, ADS1256_SAMPLE_T *_out, uint32_t _max, int _consume);
+uint32_t ADS1256_RingCount(ADS1256_RING_T *_ring);
+int ADS1256_StartAcq(uint32_t _size);
+void ADS1256_StopAcq(void);
+static uint32_t ADS1256_AcqPush(const ADS1256_SAMPLE_T *_s, uint32_t _n);
+static void ADS1256_AcqTrigger(const ADS1256_SAMPLE_T *_s);
+static void ADS1256_AcqControl(const ADS1256_SAMPLE_T *_s);
+int ADS1256_StartLog(const char *_path, uint64_t _rotBytes, int64_t _rotNs, int _direct, uint32_t _bufSize, uint32_t _size);
+void ADS1256_StopLog(void);
+static int32_t ADS1256_SyncHold(uint8_t _mux, uint8_t _gain);
+int ADS1256_GroupStart(ADS1256_GROUP_T *_g, uint32_t _size);
+void ADS1256_GroupStop(ADS1256_GROUP_T *_g);
+static void ADS1256_GroupHalt(ADS1256_GROUP_T *_g);
+void Write_DAC8552(uint8_t channel, uint16_t Data);
+uint16_t Voltage_Convert(float Vref, float voltage);
+static void ADS1256_DacOut(uint8_t _channels, const uint16_t *_codes);
+int ADS1256_DacStart(uint16_t *_codes, uint32_t _frames, uint8_t _channels, int64_t _periodNs, uint8_t _loop);
+int ADS1256_DacQueue(uint16_t *_codes, uint32_t _frames, int _wait);
+void ADS1256_DacStop(void);
+
+
+
+
+void  bsp_DelayUS(uint64_t micros)
+{
+		g_tADS1256.Transport->DelayUS(micros);
+}
+
+
+/*
+*********************************************************************************************************
+*	name: bsp_InitADS1256
+*	function: Configuration of the STM32 GPIO and SPI interface£¬The connection ADS1256
+*	parameter: NULL
+*	The return value: NULL
+*********************************************************************************************************
+*/
+
+
+void bsp_InitADS1256(void)
+{
+#ifdef SOFT_SPI
+	CS_1();
+	SCK_0();
+	DI_0();
+#endif
+
+//ADS1256_CfgADC(ADS1256_GAIN_1, ADS1256_1000SPS);	/* ÅäÖÃADC²ÎÊý£º ÔöÒæ1:1, Êý¾ÝÊä³öËÙÂÊ 1KHz */
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_StartScan
+*	function: Configuration DRDY PIN for external interrupt is triggered
+*	parameter: _ucDiffMode : 0  Single-ended input  8 channel£¬ 1 Differential input  4 channe,
+*			  2  the list set with ADS1256_SetScanList
+*	The return value: NULL
+*********************************************************************************************************
+*/
+void ADS1256_StartScan(uint8_t _ucScanMode)
+{
+	uint8_t i;
+
+	g_tADS1256.ScanMode = _ucScanMode;
+
+	if (_ucScanMode == 0)
+	{
+		for (i = 0; i < 8; i++)	/* AIN0..AIN7 against AINCOM */
+		{
+			g_tADS1256.ScanList[i].Mux = ADS1256_MuxPair(i, ADS1256_AINCOM);
+			g_tADS1256.ScanList[i].Gain = ADS1256_GAIN_DEFAULT;
+			g_tADS1256.ScanList[i].Repeat = 1;
+		}
+		g_tADS1256.ScanCount = 8;
+	}
+	else if (_ucScanMode == 1)
+	{
+		for (i = 0; i < 4; i++)	/* AIN0-AIN1, AIN2-AIN3, AIN4-AIN5, AIN6-AIN7 */
+		{
+			g_tADS1256.ScanList[i].Mux = ADS1256_MuxPair(2 * i, 2 * i + 1);
+			g_tADS1256.ScanList[i].Gain = ADS1256_GAIN_DEFAULT;
+			g_tADS1256.ScanList[i].Repeat = 1;
+		}
+		g_tADS1256.ScanCount = 4;
+	}
+
+	/* ¿ªÊ¼É¨ÃèÇ°, ÇåÁã½á¹û»º³åÇø */
+	g_tADS1256.Channel = 0;
+	g_tADS1256.Repeat = 0;
+	g_tADS1256.Converting = ADS1256_CH_NONE;
+
+	for (i = 0; i < ADS1256_SCAN_MAX; i++)
+	{
+		g_tADS1256.AdcNow[i] = 0;
+		g_tADS1256.AdcTime[i] = 0;
+		g_tADS1256.AdcPga[i] = ADS1256_GAIN_1;
+		g_tADS1256.AutoPga[i] = ADS1256_GAIN_1;	/* Auto-ranging starts where nothing clips */
+	}
+
+	/* With ACAL on, every PGA change of a mixed-gain list would start a self-calibration */
+	if (ADS1256_MixedGains(g_tADS1256.Gain) && g_tADS1256.Opened && (g_tADS1256.Status & (1 << 2)))
+	{
+		ADS1256_WaitDRDY();
+		g_tADS1256.Status &= ~(1 << 2);		/* ACAL off, buffer unchanged */
+		ADS1256_WriteReg(REG_STATUS, g_tADS1256.Status);
+	}
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_MixedGains
+*	function: Whether the scan list switches the PGA between entries
+*	parameter: _gain : gain of the entries that use the default
+*	The return value: 1 if some entry has a gain other than _gain
+*********************************************************************************************************
+*/
+static uint8_t ADS1256_MixedGains(uint8_t _gain)
+{
+	uint8_t i;
+
+	for (i = 0; i < g_tADS1256.ScanCount; i++)
+	{
+		if ((g_tADS1256.ScanList[i].Gain != ADS1256_GAIN_DEFAULT) && (g_tADS1256.ScanList[i].Gain != _gain))
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_EntryPga
+*	function: PGA the next conversion of a scan list entry is made at
+*	parameter: _entry : scan list entry
+*	The return value: ADS1256_GAIN_E
+*********************************************************************************************************
+*/
+static uint8_t ADS1256_EntryPga(uint8_t _entry)
+{
+	uint8_t gain = g_tADS1256.ScanList[_entry].Gain;
+
+	if (gain == ADS1256_GAIN_DEFAULT)
+	{
+		return g_tADS1256.Gain;
+	}
+	if (gain == ADS1256_GAIN_AUTO)
+	{
+		return g_tADS1256.AutoPga[_entry];
+	}
+	return gain;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_AutoRange
+*	function: Choose the PGA of the next conversion of an auto-ranged entry from a result, and
+*			  normalise the result to counts at 64x so that results taken at different gains compare
+*			  directly. A clipped result goes back to 1x, a result near full scale steps one gain
+*			  down, a small one steps up as far as it stays clear of the step down (hysteresis).
+*			  With Repeat > 1 the conversion after this one has already started at the old PGA,
+*			  so the new PGA takes effect one conversion later.
+*	parameter: _entry : scan list entry
+*			   _value : signed 24 bit result
+*			   _pga : PGA _value was converted at
+*	The return value: _value * 2^(6 - _pga), at most 30 bits
+*********************************************************************************************************
+*/
+static int32_t ADS1256_AutoRange(uint8_t _entry, int32_t _value, uint8_t _pga)
+{
+	int32_t mag = (_value < 0) ? -_value : _value;
+	uint8_t pga = _pga;
+
+	if (mag >= ADS1256_AUTO_CLIP)
+	{
+		pga = ADS1256_GAIN_1;
+	}
+	else if (mag >= ADS1256_AUTO_HIGH)
+	{
+		if (pga > ADS1256_GAIN_1)
+		{
+			pga--;
+		}
+	}
+	else
+	{
+		while ((pga < ADS1256_GAIN_64) && ((mag << 1) < ADS1256_AUTO_UP))
+		{
+			pga++;
+			mag <<= 1;
+		}
+	}
+	g_tADS1256.AutoPga[_entry] = pga;
+
+	return _value * (1 << (ADS1256_GAIN_64 - _pga));
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_Configure
+*	function: Change the gain, data rate and input buffer of a running chip, writing only the
+*			  registers whose value changes. ACAL is turned off while they are written so that each
+*			  WREG does not start its own calibration. Then the cached coefficients of the new
+*			  setting are written, or one SELFCAL is run and waited for. ACAL is left as
+*			  ADS1256_CfgADC would set it. Without a calibration, SYNC and WAKEUP restart the
+*			  conversion, so the next result is settled at the new setting.
+*	parameter: _gain : ADS1256_GAIN_E
+*			   _drate : ADS1256_DRATE_E
+*			   _buffer : 1 enables the analog input buffer
+*	The return value: 0 ok, ETIMEDOUT if the self-calibration did not finish
+*********************************************************************************************************
+*/
+int ADS1256_Configure(ADS1256_GAIN_E _gain, ADS1256_DRATE_E _drate, uint8_t _buffer)
+{
+	const ADS1256_CAL_T *cal = &g_tCal.Entry[_gain][_drate];
+	const ADS1256_TIMING_T *t = &g_tADS1256.Timing;
+	uint8_t acal, status;
+	int ret = 0;
+
+	acal = !cal->Valid && !ADS1256_MixedGains(_gain);
+	status = (0 << 3) | (acal << 2) | (_buffer << 1);
+
+	g_tADS1256.Gain = _gain;
+	g_tADS1256.Buffer = _buffer;
+	if ((_gain == g_tADS1256.Pga) && (_drate == g_tADS1256.DataRate) && (status == g_tADS1256.Status))
+	{
+		return 0;
+	}
+	g_tADS1256.Converting = ADS1256_CH_NONE;
+
+	/* BUFEN changes here, with ACAL off */
+	if ((g_tADS1256.Status & (1 << 2)) || ((status ^ g_tADS1256.Status) & (1 << 1)))
+	{
+		g_tADS1256.Status = status & ~(1 << 2);
+		ADS1256_WriteReg(REG_STATUS, g_tADS1256.Status);
+		bsp_DelayUS(t->T11Us);
+	}
+	if (_gain != g_tADS1256.Pga)
+	{
+		ADS1256_WriteReg(REG_ADCON, g_tADS1256.Adcon | (_gain << 0));	/* ADCON as in ADS1256_CfgADC */
+		g_tADS1256.Pga = _gain;
+		bsp_DelayUS(t->T11Us);
+	}
+	if (_drate != g_tADS1256.DataRate)
+	{
+		ADS1256_WriteReg(REG_DRATE, s_tabDataRate[_drate]);
+		g_tADS1256.DataRate = _drate;
+		bsp_DelayUS(t->T11Us);
+	}
+
+	if (cal->Valid)
+	{
+		if (g_tADS1256.CalPga != _gain)
+		{
+			ADS1256_WriteCal(cal->Reg);
+			bsp_DelayUS(t->T11Us);
+		}
+		ADS1256_WriteCmd(CMD_SYNC);
+		bsp_DelayUS(t->T11SyncUs);
+		ADS1256_WriteCmd(CMD_WAKEUP);
+	}
+	else
+	{
+		/* What the auto-calibration would have done, once for all the changes */
+		ADS1256_WriteCmd(CMD_SELFCAL);
+		bsp_DelayUS(t->T11SyncUs);
+		ret = ADS1256_WaitDRDY();
+	}
+	g_tADS1256.CalPga = (ret == 0) ? _gain : ADS1256_GAIN_DEFAULT;
+
+	/* ACAL back on: STATUS changes only in ACAL, which does not start a calibration */
+	if (status != g_tADS1256.Status)
+	{
+		ADS1256_WriteReg(REG_STATUS, status);
+		g_tADS1256.Status = status;
+	}
+	return ret;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_SetScanList
+*	function: Replace the scan with a list of input pairs, each with its own gain and repeat count
+*	parameter: _list : entries, converted in order
+*			   _count : number of entries, 1--ADS1256_SCAN_MAX; 0 goes back to the 8 single-ended inputs
+*	The return value: NULL
+*********************************************************************************************************
+*/
+void ADS1256_SetScanList(const ADS1256_SCAN_ENTRY_T *_list, uint8_t _count)
+{
+	if (_count == 0)
+	{
+		ADS1256_StartScan(0);
+		return;
+	}
+
+	memcpy(g_tADS1256.ScanList, _list, _count * sizeof(ADS1256_SCAN_ENTRY_T));
+	g_tADS1256.ScanCount = _count;
+	ADS1256_StartScan(2);
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_Send8Bit
+*	function: SPI bus to send 8 bit data
+*	parameter: _data:  data
+*	The return value: NULL
+*********************************************************************************************************
+*/
+static void ADS1256_Send8Bit(uint8_t _data)
+{
+	g_tADS1256.Transport->Transfer(_data);
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_SendBurst
+*	function: Clock a whole command (or a run of data bytes) over SPI in one transfer, without gaps
+*			  between the bytes. The datasheet only asks for delays between commands (t11) and
+*			  before DOUT (t6); the callers insert those explicitly.
+*	parameter: _buf:  bytes to send, replaced by the bytes received
+*			   _len:  number of bytes
+*	The return value: NULL
+*********************************************************************************************************
+*/
+static void ADS1256_SendBurst(uint8_t *_buf, uint32_t _len)
+{
+	g_tADS1256.Transport->Transfern(_buf, _len);
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_CfgADC
+*	function: The configuration parameters of ADC, gain and data rate
+*	parameter: _gain:gain 1-64
+*                      _drate:  data  rate
+*	The return value: NULL
+*********************************************************************************************************
+*/
+void ADS1256_CfgADC(ADS1256_GAIN_E _gain, ADS1256_DRATE_E _drate)
+{
+	const ADS1256_CAL_T *cal = &g_tCal.Entry[_gain][_drate];
+
+	g_tADS1256.Gain = _gain;
+	g_tADS1256.Pga = _gain;
+	g_tADS1256.DataRate = _drate;
+	g_tADS1256.Converting = ADS1256_CH_NONE;	/* MUX is rewritten below */
+
+	ADS1256_WaitDRDY();
+
+	{
+		uint8_t buf[6];		/* WREG command, count and the ads1256 register configuration parameters */
+
+		/*Status register define
+			Bits 7-4 ID3, ID2, ID1, ID0  Factory Programmed Identification Bits (Read Only)
+
+			Bit 3 ORDER: Data Output Bit Order
+				0 = Most Significant Bit First (default)
+				1 = Least Significant Bit First
+			Input data  is always shifted in most significant byte and bit first. Output data is always shifted out most significant
+			byte first. The ORDER bit only controls the bit order of the output data within the byte.
+
+			Bit 2 ACAL : Auto-Calibration
+				0 = Auto-Calibration Disabled (default)
+				1 = Auto-Calibration Enabled
+			When Auto-Calibration is enabled, self-calibration begins at the completion of the WREG command that changes
+			the PGA (bits 0-2 of ADCON register), DR (bits 7-0 in the DRATE register) or BUFEN (bit 1 in the STATUS register)
+			values.
+
+			Bit 1 BUFEN: Analog Input Buffer Enable
+				0 = Buffer Disabled (default)
+				1 = Buffer Enabled
+
+			Bit 0 DRDY :  Data Ready (Read Only)
+				This bit duplicates the state of the DRDY pin.
+
+			ACAL=1  enable  calibration
+		*/
+		//buf[0] = (0 << 3) | (1 << 2) | (1 << 1);//enable the internal buffer
+        buf[2] = (0 << 3) | (1 << 2) | (0 << 1);  // The internal buffer is prohibited
+		buf[2] |= g_tADS1256.Buffer << 1;
+		if (cal->Valid)
+		{
+			buf[2] &= ~(1 << 2);	/* Calibrated before: ACAL off, the cached coefficients follow */
+		}
+		g_tADS1256.Status = buf[2];
+
+        //ADS1256_WriteReg(REG_STATUS, (0 << 3) | (1 << 2) | (1 << 1));
+
+		buf[3] = 0x08;	
+
+		/*	ADCON: A/D Control Register (Address 02h)
+			Bit 7 Reserved, always 0 (Read Only)
+			Bits 6-5 CLK1, CLK0 : D0/CLKOUT Clock Out Rate Setting
+				00 = Clock Out OFF
+				01 = Clock Out Frequency = fCLKIN (default)
+				10 = Clock Out Frequency = fCLKIN/2
+				11 = Clock Out Frequency = fCLKIN/4
+				When not using CLKOUT, it is recommended that it be turned off. These bits can only be reset using the RESET pin.
+
+			Bits 4-3 SDCS1, SCDS0: Sensor Detect Current Sources
+				00 = Sensor Detect OFF (default)
+				01 = Sensor Detect Current = 0.5 ¦Ì A
+				10 = Sensor Detect Current = 2 ¦Ì A
+				11 = Sensor Detect Current = 10¦Ì A
+				The Sensor Detect Current Sources can be activated to verify  the integrity of an external sensor supplying a signal to the
+				ADS1255/6. A shorted sensor produces a very small signal while an open-circuit sensor produces a very large signal.
+
+			Bits 2-0 PGA2, PGA1, PGA0: Programmable Gain Amplifier Setting
+				000 = 1 (default)
+				001 = 2
+				010 = 4
+				011 = 8
+				100 = 16
+				101 = 32
+				110 = 64
+				111 = 64
+		*/
+		buf[4] = g_tADS1256.Adcon | (_gain << 0);	/* Clock out and sensor detect as given to start() */
+		//ADS1256_WriteReg(REG_ADCON, (0 << 5) | (0 << 2) | (GAIN_1 << 1));	/*choose 1: gain 1 ;input 5V/
+		buf[5] = s_tabDataRate[_drate];	// DRATE_10SPS;	
+
+		buf[0] = CMD_WREG | 0;	/* Write command register, send the register address */
+		buf[1] = 0x03;			/* Register number 4,Initialize the number  -1*/
+
+		/* buf[2..5]: status register, input channel, ADCON control register (gain), output rate */
+		CS_0();	/* SPIÆ¬Ñ¡ = 0 */
+		ADS1256_SendBurst(buf, 6);
+		CS_1();	/* SPI  cs = 1 */
+	}
+
+	bsp_DelayUS(50);
+
+	if (cal->Valid)
+	{
+		ADS1256_WriteCal(cal->Reg);
+		bsp_DelayUS(g_tADS1256.Timing.T11Us);
+	}
+	g_tADS1256.CalPga = _gain;	/* Cached, or measured by the auto-calibration */
+}
+
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_DelayDATA
+*	function: delay
+*	parameter: NULL
+*	The return value: NULL
+*********************************************************************************************************
+*/
+static void ADS1256_DelayDATA(void)
+{
+	/*
+		Delay from last SCLK edge for DIN to first SCLK rising edge for DOUT: RDATA, RDATAC,RREG Commands
+		min  50   CLK = 50 * 0.13uS = 6.5uS
+	*/
+	bsp_DelayUS(g_tADS1256.Timing.T6Us);	/* 7us with the 7.68 MHz CLKIN */
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_SetClock
+*	function: Set the SPI clock and derive the interface delays from the ADS1256 master clock.
+*			  The delays do not depend on SCLK, but a faster SCLK shortens every byte, so with
+*			  both the transaction time drops from the old fixed 5/5/25/10 us to what the chip needs.
+*	parameter: _hz : requested SCLK, at most ADS1256_SCLK_MAX_HZ
+*	The return value: SCLK frequency actually set by the transport
+*********************************************************************************************************
+*/
+uint32_t ADS1256_SetClock(uint32_t _hz)
+{
+	ADS1256_TIMING_T *t = &g_tADS1256.Timing;
+
+	if (_hz > ADS1256_SCLK_MAX_HZ)
+	{
+		_hz = ADS1256_SCLK_MAX_HZ;
+	}
+
+	BUS_LOCK();		/* The clock of the transport is shared by all the devices */
+	t->SclkHz = g_tADS1256.Transport->SetClock(_hz);
+	s_pBusOwner = s_pDev;
+	s_BusDac = 0;
+	BUS_UNLOCK();
+	t->T6Us = ADS1256_CLKIN_US(50);
+	t->T11Us = ADS1256_CLKIN_US(4);
+	t->T11SyncUs = ADS1256_CLKIN_US(24);
+
+	return t->SclkHz;
+}
+
+
+
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_Recive8Bit
+*	function: SPI bus receive function
+*	parameter: NULL
+*	The return value: NULL
+*********************************************************************************************************
+*/
+static uint8_t ADS1256_Recive8Bit(void)
+{
+	uint8_t read = 0;
+	read = g_tADS1256.Transport->Transfer(0xff);
+	return read;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_WriteReg
+*	function: Write the corresponding register
+*	parameter: _RegID: register  ID
+*			 _RegValue: register Value
+*	The return value: NULL
+*********************************************************************************************************
+*/
+static void ADS1256_WriteReg(uint8_t _RegID, uint8_t _RegValue)
+{
+	uint8_t buf[3];
+
+	buf[0] = CMD_WREG | _RegID;	/*Write command register */
+	buf[1] = 0x00;				/*Write the register number */
+	buf[2] = _RegValue;			/*send register value */
+
+	CS_0();	/* SPI  cs  = 0 */
+	ADS1256_SendBurst(buf, 3);
+	CS_1();	/* SPI   cs = 1 */
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_ReadReg
+*	function: Read  the corresponding register
+*	parameter: _RegID: register  ID
+*	The return value: read register value
+*********************************************************************************************************
+*/
+static uint8_t ADS1256_ReadReg(uint8_t _RegID)
+{
+	uint8_t read;
+	uint8_t buf[2];
+
+	buf[0] = CMD_RREG | _RegID;	/* Write command register */
+	buf[1] = 0x00;				/* Write the register number */
+
+	CS_0();	/* SPI  cs  = 0 */
+	ADS1256_SendBurst(buf, 2);
+
+	ADS1256_DelayDATA();	/*delay time */
+
+	read = ADS1256_Recive8Bit();	/* Read the register values */
+	CS_1();	/* SPI   cs  = 1 */
+
+	return read;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_WriteCmd
+*	function: Sending a single byte order
+*	parameter: _cmd : command
+*	The return value: NULL
+*********************************************************************************************************
+*/
+static void ADS1256_WriteCmd(uint8_t _cmd)
+{
+	CS_0();	/* SPI   cs = 0 */
+	ADS1256_Send8Bit(_cmd);
+	CS_1();	/* SPI  cs  = 1 */
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_ReadChipID
+*	function: Read the chip ID
+*	parameter: _cmd : NULL
+*	The return value: four high status register
+*********************************************************************************************************
+*/
+uint8_t ADS1256_ReadChipID(void)
+{
+	uint8_t id;
+
+	ADS1256_WaitDRDY();
+	id = ADS1256_ReadReg(REG_STATUS);
+	return (id >> 4);
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_ReadCal
+*	function: Read the offset and full-scale calibration registers, OFC0..FSC2, in one RREG
+*	parameter: _reg : 6 bytes, LSB first as in the register map
+*	The return value: NULL
+*********************************************************************************************************
+*/
+void ADS1256_ReadCal(uint8_t *_reg)
+{
+	uint8_t buf[2];
+	uint8_t i;
+
+	buf[0] = CMD_RREG | REG_OFC0;	/* Read from OFC0 ... */
+	buf[1] = 0x05;					/* ... six registers, up to FSC2 */
+
+	CS_0();	/* SPI  cs  = 0 */
+	ADS1256_SendBurst(buf, 2);
+	ADS1256_DelayDATA();	/*delay time */
+	for (i = 0; i < 6; i++)
+	{
+		_reg[i] = ADS1256_Recive8Bit();
+	}
+	CS_1();	/* SPI   cs  = 1 */
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_WriteCal
+*	function: Write the offset and full-scale calibration registers, OFC0..FSC2, in one WREG
+*	parameter: _reg : 6 bytes, LSB first as in the register map
+*	The return value: NULL
+*********************************************************************************************************
+*/
+static void ADS1256_WriteCal(const uint8_t *_reg)
+{
+	uint8_t buf[8];
+
+	buf[0] = CMD_WREG | REG_OFC0;
+	buf[1] = 0x05;
+	memcpy(&buf[2], _reg, 6);
+
+	CS_0();	/* SPI  cs  = 0 */
+	ADS1256_SendBurst(buf, 8);
+	CS_1();	/* SPI   cs = 1 */
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_CalLoad
+*	function: On a PGA change in a mixed-gain scan, write the cached coefficients of the new PGA
+*			  so that each entry is converted with its own calibration. Called inside a CS frame
+*			  right after the WREG that changed ADCON; does nothing if the coefficients are
+*			  already in place or not cached.
+*	parameter: _gain : PGA of the next conversion
+*	The return value: NULL
+*********************************************************************************************************
+*/
+static void ADS1256_CalLoad(uint8_t _gain)
+{
+	const ADS1256_CAL_T *cal;
+	uint8_t buf[8];
+
+	if (g_tADS1256.CalPga == _gain)
+	{
+		return;
+	}
+	cal = &g_tCal.Entry[_gain][g_tADS1256.DataRate];
+	if (!cal->Valid)
+	{
+		return;
+	}
+
+	buf[0] = CMD_WREG | REG_OFC0;
+	buf[1] = 0x05;
+	memcpy(&buf[2], cal->Reg, 6);
+	ADS1256_SendBurst(buf, 8);
+	bsp_DelayUS(g_tADS1256.Timing.T11Us);
+	g_tADS1256.CalPga = _gain;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_Calibrate
+*	function: Run one of the calibration commands on the input pair and PGA of a scan list entry,
+*			  read back OFC and FSC and store them in the cache for the current (PGA, DRATE).
+*			  Self-calibrations disconnect the inputs internally; the system calibrations measure
+*			  the entry's inputs, which must carry zero (SYSOCAL) or full scale (SYSGCAL).
+*	parameter: _cmd : CMD_SELFCAL, CMD_SELFOCAL, CMD_SELFGCAL, CMD_SYSOCAL or CMD_SYSGCAL
+*			   _entry : scan list entry
+*	The return value: 0 ok, ETIMEDOUT if DRDY never came back, or errno of writing the cache file
+*********************************************************************************************************
+*/
+int ADS1256_Calibrate(uint8_t _cmd, uint8_t _entry)
+{
+	const ADS1256_SCAN_ENTRY_T *e = &g_tADS1256.ScanList[_entry];
+	uint8_t gain = ADS1256_EntryPga(_entry);
+	ADS1256_CAL_T *cal = &g_tCal.Entry[gain][g_tADS1256.DataRate];
+	uint8_t buf[4];
+	uint8_t len;
+
+	if (ADS1256_WaitDRDY() != 0)
+	{
+		return ETIMEDOUT;
+	}
+	len = ADS1256_MuxWrite(buf, e->Mux, gain);
+	CS_0();	/* SPI   cs = 0 */
+	ADS1256_SendBurst(buf, len);
+	CS_1();	/* SPI   cs = 1 */
+	bsp_DelayUS(g_tADS1256.Timing.T11Us);
+	g_tADS1256.Converting = ADS1256_CH_NONE;	/* The calibration restarts the digital filter */
+
+	if (ADS1256_WaitDRDY() != 0)		/* An auto-calibration after the PGA change must finish first */
+	{
+		g_tADS1256.CalPga = ADS1256_GAIN_DEFAULT;
+		return ETIMEDOUT;
+	}
+	ADS1256_WriteCmd(_cmd);
+	bsp_DelayUS(g_tADS1256.Timing.T11SyncUs);
+	if (ADS1256_WaitDRDY() != 0)
+	{
+		g_tADS1256.CalPga = ADS1256_GAIN_DEFAULT;
+		return ETIMEDOUT;
+	}
+
+	ADS1256_ReadCal(cal->Reg);
+	cal->Valid = 1;
+	g_tADS1256.CalPga = gain;
+
+	return ADS1256_CalCacheSave();
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_CalCacheLoad
+*	function: Forget the cached coefficients and read them from a cache file. A missing file is an
+*			  empty cache; it is created by the first calibration.
+*			  Lines: gain (1-64), DRATE register, OFC and FSC as 24 bit hex; '#' starts a comment.
+*	parameter: _path : cache file, NULL or "" to keep the cache in memory only
+*	The return value: number of settings loaded, or -errno
+*********************************************************************************************************
+*/
+int ADS1256_CalCacheLoad(const char *_path)
+{
+	char line[128];
+	unsigned int gain, drate, ofc, fsc;
+	uint8_t g, d;
+	int n = 0;
+	FILE *fp;
+
+	memset(&g_tCal, 0, sizeof(g_tCal));
+	g_tADS1256.CalPga = ADS1256_GAIN_DEFAULT;
+	if ((_path == NULL) || (_path[0] == 0))
+	{
+		return 0;
+	}
+	snprintf(g_tCal.Path, sizeof(g_tCal.Path), "%s", _path);
+
+	fp = fopen(_path, "r");
+	if (fp == NULL)
+	{
+		return (errno == ENOENT) ? 0 : -errno;
+	}
+	while (fgets(line, sizeof(line), fp) != NULL)
+	{
+		if (sscanf(line, "%u %x %x %x", &gain, &drate, &ofc, &fsc) != 4)
+		{
+			continue;	/* Comment or blank line */
+		}
+		for (g = 0; (g <= ADS1256_GAIN_64) && ((1u << g) != gain); g++);
+		for (d = 0; (d < ADS1256_DRATE_MAX) && (s_tabDataRate[d] != drate); d++);
+		if ((g > ADS1256_GAIN_64) || (d == ADS1256_DRATE_MAX))
+		{
+			continue;
+		}
+		g_tCal.Entry[g][d].Reg[0] = ofc & 0xFF;
+		g_tCal.Entry[g][d].Reg[1] = (ofc >> 8) & 0xFF;
+		g_tCal.Entry[g][d].Reg[2] = (ofc >> 16) & 0xFF;
+		g_tCal.Entry[g][d].Reg[3] = fsc & 0xFF;
+		g_tCal.Entry[g][d].Reg[4] = (fsc >> 8) & 0xFF;
+		g_tCal.Entry[g][d].Reg[5] = (fsc >> 16) & 0xFF;
+		g_tCal.Entry[g][d].Valid = 1;
+		n++;
+	}
+	fclose(fp);
+	return n;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_CalCacheSave
+*	function: Write the whole cache to a temporary file and rename it over the cache file, so that
+*			  a crash never leaves a half written cache behind
+*	parameter: NULL
+*	The return value: 0 ok (or no cache file), errno otherwise
+*********************************************************************************************************
+*/
+static int ADS1256_CalCacheSave(void)
+{
+	char tmp[256];
+	const uint8_t *r;
+	uint8_t g, d;
+	FILE *fp;
+	int err = 0;
+
+	if (g_tCal.Path[0] == 0)
+	{
+		return 0;
+	}
+
+	snprintf(tmp, sizeof(tmp), "%s.tmp", g_tCal.Path);
+	fp = fopen(tmp, "w");
+	if (fp == NULL)
+	{
+		return errno;
+	}
+	fprintf(fp, "# ads1256 calibration cache\n# gain drate ofc fsc\n");
+	for (g = 0; g <= ADS1256_GAIN_64; g++)
+	{
+		for (d = 0; d < ADS1256_DRATE_MAX; d++)
+		{
+			if (!g_tCal.Entry[g][d].Valid)
+			{
+				continue;
+			}
+			r = g_tCal.Entry[g][d].Reg;
+			fprintf(fp, "%u 0x%02X 0x%02X%02X%02X 0x%02X%02X%02X\n", 1u << g, s_tabDataRate[d],
+				r[2], r[1], r[0], r[5], r[4], r[3]);
+		}
+	}
+	if (fflush(fp) != 0 || fsync(fileno(fp)) != 0)
+	{
+		err = errno;
+	}
+	if ((fclose(fp) != 0) && (err == 0))
+	{
+		err = errno;
+	}
+	if ((err == 0) && (rename(tmp, g_tCal.Path) != 0))
+	{
+		err = errno;
+	}
+	if (err != 0)
+	{
+		unlink(tmp);
+	}
+	return err;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_MuxPair
+*	function: MUX register value of an input pair
+*	parameter:  _ainp:  positive input 0--7, or ADS1256_AINCOM
+*			   _ainn:  negative input 0--7, or ADS1256_AINCOM
+*	The return value: MUX register value
+*********************************************************************************************************
+*/
+static uint8_t ADS1256_MuxPair(uint8_t _ainp, uint8_t _ainn)
+{
+	/*
+	Bits 7-4 PSEL3, PSEL2, PSEL1, PSEL0: Positive Input Channel (AINP) Select
+		0000 = AIN0 (default)
+		0001 = AIN1
+		0010 = AIN2 (ADS1256 only)
+		0011 = AIN3 (ADS1256 only)
+		0100 = AIN4 (ADS1256 only)
+		0101 = AIN5 (ADS1256 only)
+		0110 = AIN6 (ADS1256 only)
+		0111 = AIN7 (ADS1256 only)
+		1xxx = AINCOM (when PSEL3 = 1, PSEL2, PSEL1, PSEL0 are ¡°don¡¯t care¡±)
+
+		NOTE: When using an ADS1255 make sure to only select the available inputs.
+
+	Bits 3-0 NSEL3, NSEL2, NSEL1, NSEL0: Negative Input Channel (AINN)Select
+		0000 = AIN0
+		0001 = AIN1 (default)
+		0010 = AIN2 (ADS1256 only)
+		0011 = AIN3 (ADS1256 only)
+		0100 = AIN4 (ADS1256 only)
+		0101 = AIN5 (ADS1256 only)
+		0110 = AIN6 (ADS1256 only)
+		0111 = AIN7 (ADS1256 only)
+		1xxx = AINCOM (when NSEL3 = 1, NSEL2, NSEL1, NSEL0 are ¡°don¡¯t care¡±)
+	*/
+	return (_ainp << 4) | _ainn;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_MuxWrite
+*	function: Build the WREG that selects an input pair, and the PGA too when the gain changes
+*			  (MUX and ADCON are adjacent registers, so one WREG covers both)
+*	parameter:  _buf:  at least 4 bytes
+*			   _mux:  MUX register value
+*			   _gain:  ADS1256_GAIN_E
+*	The return value: number of bytes to send
+*********************************************************************************************************
+*/
+static uint8_t ADS1256_MuxWrite(uint8_t *_buf, uint8_t _mux, uint8_t _gain)
+{
+	_buf[0] = CMD_WREG | REG_MUX;
+	_buf[2] = _mux;
+
+	if (_gain == g_tADS1256.Pga)
+	{
+		_buf[1] = 0x00;
+		return 3;
+	}
+
+	_buf[1] = 0x01;
+	_buf[3] = g_tADS1256.Adcon | (_gain << 0);	/* ADCON as in ADS1256_CfgADC */
+	g_tADS1256.Pga = _gain;
+	return 4;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_WaitDRDY
+*	function: Wait for DRDY low, at most g_tADS1256.DrdyTimeoutUs. A time out is counted and latched
+*			  in g_tADS1256.Fault, for the glue to report once the bus operation is over.
+*	parameter:  NULL
+*	The return value:  0 ok, ETIMEDOUT
+*********************************************************************************************************
+*/
+static int ADS1256_WaitDRDY(void)
+{
+	if (ADS1256_WaitDRDYTimeout(g_tADS1256.DrdyTimeoutUs))
+	{
+		return 0;
+	}
+
+	g_tADS1256.Stats.Timeouts++;
+	g_tADS1256.Stats.LastError = ETIMEDOUT;
+	if (g_tADS1256.Fault == 0)
+	{
+		g_tADS1256.Fault = ETIMEDOUT;
+	}
+	return ETIMEDOUT;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_WaitDRDYTimeout
+*	function: Wait until DRDY is low, at most _us microseconds.
+*			  In ADS1256_DRDY_EVENT mode the thread sleeps until the kernel reports the falling edge,
+*			  otherwise the level is polled against CLOCK_MONOTONIC. The poll spins for two conversion
+*			  periods plus 1 ms, then sleeps ADS1256_DRDY_NAP_US between checks: a board that stopped
+*			  converting does not hold a core. After a time out it sleeps from the start.
+*			  The time of the falling edge goes to g_tADS1256.DrdyTime (CLOCK_MONOTONIC_RAW): the
+*			  kernel's event timestamp in event mode, the moment the poll loop sees the low level otherwise.
+*			  g_tADS1256.DrdySince is taken before the last check that still read DRDY high, so the
+*			  edge is known to be later; 0 when DRDY was already low, the result of unknown age.
+*	parameter:  _us : timeout in microseconds
+*	The return value:  1 DRDY is low, 0 time out
+*********************************************************************************************************
+*/
+static int ADS1256_WaitDRDYTimeout(uint32_t _us)
+{
+	struct timespec start, now, end;
+	struct timespec nap = { 0, ADS1256_DRDY_NAP_US * 1000 };
+	int64_t spin;
+	int64_t since;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	end = start;
+	end.tv_sec += _us / 1000000;
+	end.tv_nsec += (_us % 1000000) * 1000;
+	if (end.tv_nsec >= 1000000000)
+	{
+		end.tv_sec++;
+		end.tv_nsec -= 1000000000;
+	}
+
+	if ((g_tADS1256.DrdyMode == ADS1256_DRDY_EVENT) && (g_tADS1256.DrdyFd >= 0))
+	{
+		struct gpioevent_data ev;
+		struct pollfd pfd;
+		struct timespec left;
+		uint64_t edge = 0;
+
+		/* Edges queued before this call are stale, the level check below covers them.
+		   The newest one still dates the result if DRDY is already low. */
+		while (read(g_tADS1256.DrdyFd, &ev, sizeof(ev)) == sizeof(ev))
+		{
+			edge = ev.timestamp;
+		}
+
+		pfd.fd = g_tADS1256.DrdyFd;
+		pfd.events = POLLIN | POLLPRI;
+
+		g_tADS1256.DrdySince = 0;
+		for (;;)
+		{
+			since = ADS1256_NowRaw();
+			if (DRDY_IS_LOW())
+			{
+				break;
+			}
+			g_tADS1256.DrdySince = since;
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			left.tv_sec = end.tv_sec - now.tv_sec;
+			left.tv_nsec = end.tv_nsec - now.tv_nsec;
+			if (left.tv_nsec < 0)
+			{
+				left.tv_sec--;
+				left.tv_nsec += 1000000000;
+			}
+			if (left.tv_sec < 0)
+			{
+				g_tADS1256.DrdyLate = 1;
+				return 0;
+			}
+			if (ppoll(&pfd, 1, &left, NULL) > 0)
+			{
+				while (read(g_tADS1256.DrdyFd, &ev, sizeof(ev)) == sizeof(ev))
+				{
+					edge = ev.timestamp;
+				}
+			}
+		}
+		g_tADS1256.DrdyTime = edge ? ADS1256_EventToRaw(edge) : ADS1256_NowRaw();
+		g_tADS1256.DrdyLate = 0;
+		return 1;
+	}
+
+	spin = g_tADS1256.DrdyLate ? 0 : (int64_t)20000000000LL / s_tabSpsTenths[g_tADS1256.DataRate] + 1000000;
+	g_tADS1256.DrdySince = 0;
+	for (;;)
+	{
+		since = ADS1256_NowRaw();
+		if (DRDY_IS_LOW())
+		{
+			break;
+		}
+		g_tADS1256.DrdySince = since;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		if ((now.tv_sec > end.tv_sec) || ((now.tv_sec == end.tv_sec) && (now.tv_nsec >= end.tv_nsec)))
+		{
+			g_tADS1256.DrdyLate = 1;
+			return 0;
+		}
+		if ((int64_t)(now.tv_sec - start.tv_sec) * 1000000000 + (now.tv_nsec - start.tv_nsec) >= spin)
+		{
+			nanosleep(&nap, NULL);
+		}
+	}
+	g_tADS1256.DrdyTime = ADS1256_NowRaw();
+	g_tADS1256.DrdyLate = 0;
+	return 1;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_NowRaw
+*	function: Sample timestamps use CLOCK_MONOTONIC_RAW: it is not slewed by NTP, so the spacing
+*			  between conversions follows the hardware clock
+*	parameter:  NULL
+*	The return value:  CLOCK_MONOTONIC_RAW in nanoseconds
+*********************************************************************************************************
+*/
+int64_t ADS1256_NowRaw(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+	return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_EventToRaw
+*	function: Convert a gpiochip line event timestamp to CLOCK_MONOTONIC_RAW. The kernel stamps
+*			  events with CLOCK_MONOTONIC since Linux 5.7 and with CLOCK_REALTIME before, so the
+*			  offset is taken against whichever of the two the timestamp is closer to.
+*	parameter:  _ts : gpioevent_data.timestamp, ns
+*	The return value:  the same instant in CLOCK_MONOTONIC_RAW ns
+*********************************************************************************************************
+*/
+static int64_t ADS1256_EventToRaw(uint64_t _ts)
+{
+	struct timespec mono, real;
+	int64_t raw, ref, alt;
+
+	clock_gettime(CLOCK_MONOTONIC, &mono);
+	raw = ADS1256_NowRaw();
+	clock_gettime(CLOCK_REALTIME, &real);
+
+	ref = (int64_t)mono.tv_sec * 1000000000 + mono.tv_nsec;
+	alt = (int64_t)real.tv_sec * 1000000000 + real.tv_nsec;
+	if (llabs(alt - (int64_t)_ts) < llabs(ref - (int64_t)_ts))
+	{
+		ref = alt;
+	}
+
+	return raw - (ref - (int64_t)_ts);
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_SetDrdyWait
+*	function: Select how DRDY is waited for. ADS1256_DRDY_EVENT requests the falling edge of the DRDY
+*			  line from the gpiochip character device, the pin is still read through the transport.
+*	parameter:  _mode : ADS1256_DRDY_POLL or ADS1256_DRDY_EVENT
+*			   _timeoutUs : timeout of every DRDY wait, microseconds
+*			   _chip : gpiochip device holding the DRDY line, e.g. "/dev/gpiochip0"
+*	The return value:  0 ok, otherwise an errno value
+*********************************************************************************************************
+*/
+int ADS1256_SetDrdyWait(uint8_t _mode, uint32_t _timeoutUs, const char *_chip)
+{
+	struct gpioevent_request req;
+	int chip;
+	int err;
+
+	if (g_tADS1256.DrdyFd >= 0)
+	{
+		close(g_tADS1256.DrdyFd);
+		g_tADS1256.DrdyFd = -1;
+	}
+	g_tADS1256.DrdyMode = ADS1256_DRDY_POLL;
+	g_tADS1256.DrdyTimeoutUs = _timeoutUs;
+
+	if (_mode != ADS1256_DRDY_EVENT)
+	{
+		return 0;
+	}
+	if (!g_tADS1256.Transport->DrdyEvents)
+	{
+		return ENODEV;
+	}
+
+	chip = open(_chip, O_RDONLY | O_CLOEXEC);
+	if (chip < 0)
+	{
+		return errno;
+	}
+
+	memset(&req, 0, sizeof(req));
+	req.lineoffset = g_tADS1256.DrdyPin;
+	req.handleflags = GPIOHANDLE_REQUEST_INPUT;
+	req.eventflags = GPIOEVENT_REQUEST_FALLING_EDGE;
+	strncpy(req.consumer_label, "ads1256-drdy", sizeof(req.consumer_label) - 1);
+
+	if (ioctl(chip, GPIO_GET_LINEEVENT_IOCTL, &req) < 0)
+	{
+		err = errno;
+		close(chip);
+		return err;
+	}
+	close(chip);
+
+	fcntl(req.fd, F_SETFL, fcntl(req.fd, F_GETFL) | O_NONBLOCK);
+	g_tADS1256.DrdyFd = req.fd;
+	g_tADS1256.DrdyMode = ADS1256_DRDY_EVENT;
+	return 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_Decode24
+*	function: Convert the 3 data bytes (MSB first) to a signed number
+*	parameter: _buf : bytes clocked out of DOUT
+*	The return value:  ADC vaule (signed number)
+*********************************************************************************************************
+*/
+static int32_t ADS1256_Decode24(const uint8_t *_buf)
+{
+	uint32_t read = 0;
+
+    read = ((uint32_t)_buf[0] << 16) & 0x00FF0000;
+    read |= ((uint32_t)_buf[1] << 8);  /* Pay attention to It is wrong   read |= (buf[1] << 8) */
+    read |= _buf[2];
+
+	/* Extend a signed number*/
+    if (read & 0x800000)
+    {
+	    read |= 0xFF000000;
+    }
+
+	return (int32_t)read;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_CycleHold
+*	function: ADS1256_CycleMux for a frame that does not fit in half a conversion at this SCLK.
+*			  SYNC goes first and holds the chip, so nothing converts while the MUX changes: the
+*			  result of the previous input is read in the hold, then the next input is selected
+*			  and WAKEUP starts it. The readout before WAKEUP costs that much rate, but no result
+*			  can mix the two inputs and none is dropped.
+*	parameter: _buf, _len : WREG built by ADS1256_MuxWrite
+*			   _gain : PGA of the next conversion
+*	The return value:  result of the previous conversion (signed number)
+*********************************************************************************************************
+*/
+static int32_t ADS1256_CycleHold(uint8_t *_buf, uint8_t _len, uint8_t _gain)
+{
+	const ADS1256_TIMING_T *t = &g_tADS1256.Timing;
+	uint8_t data[3];
+
+	CS_0();	/* SPI   cs = 0, held for the whole sequence */
+
+	ADS1256_Send8Bit(CMD_SYNC);
+	bsp_DelayUS(t->T11SyncUs);
+
+	ADS1256_Send8Bit(CMD_RDATA);
+	ADS1256_DelayDATA();
+
+	data[0] = data[1] = data[2] = 0xFF;
+	ADS1256_SendBurst(data, 3);
+	bsp_DelayUS(t->T11Us);
+
+	ADS1256_SendBurst(_buf, _len);
+	bsp_DelayUS(t->T11Us);
+	ADS1256_CalLoad(_gain);
+
+	ADS1256_Send8Bit(CMD_WAKEUP);
+	bsp_DelayUS(t->T11Us);
+
+	CS_1();	/* SPI   cs = 1 */
+
+	return ADS1256_Decode24(data);
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_CycleMux
+*	function: Cycle the input multiplexer, datasheet Figure 19. Called once DRDY is low, in a single
+*			  CS frame: WREG MUX selects the next input, SYNC and WAKEUP start its conversion, and
+*			  RDATA reads the conversion that has just completed on the previous input. The output
+*			  register is only replaced when the new conversion finishes, so the read is still valid
+*			  after WAKEUP. The chip keeps converting until SYNC: once the next DRDY is due (one
+*			  period after the one being served) a conversion may have ended on the new MUX, and
+*			  after the settling time from WAKEUP the new input is in the register. A frame held up
+*			  past either (thread preempted) is read to release DRDY but dropped
+*			  (Converting = ADS1256_CH_NONE, counted in Stats.Late), never mislabelled. The next DRDY
+*			  is timed from DrdySince; ADS1256_CycleHold is used instead when it is not known (DRDY
+*			  was already low) or when the bytes up to SYNC alone take half a period at this SCLK.
+*	parameter: _mux : MUX register value for the next conversion
+*			   _gain : PGA for the next conversion, written with the MUX when it changes
+*	The return value:  result of the previous conversion (signed number)
+*********************************************************************************************************
+*/
+static int32_t ADS1256_CycleMux(uint8_t _mux, uint8_t _gain)
+{
+	const ADS1256_TIMING_T *t = &g_tADS1256.Timing;
+	int64_t period = (int64_t)(10000000000LL / s_tabSpsTenths[g_tADS1256.DataRate]);
+	uint8_t buf[4];
+	uint8_t len;
+	uint8_t late;
+	int64_t wake;
+
+	len = ADS1256_MuxWrite(buf, _mux, _gain);
+	if ((g_tADS1256.DrdySince == 0) ||
+		(((int64_t)(len + 1) * 8000000000LL / (int64_t)t->SclkHz + (int64_t)t->T11Us * 1000) * 2 >= period))
+	{
+		return ADS1256_CycleHold(buf, len, _gain);
+	}
+
+	CS_0();	/* SPI   cs = 0, held for the whole sequence */
+
+	ADS1256_SendBurst(buf, len);
+	bsp_DelayUS(t->T11Us);
+	ADS1256_CalLoad(_gain);
+
+	ADS1256_Send8Bit(CMD_SYNC);
+	wake = ADS1256_NowRaw();	/* SYNC is in, WAKEUP not yet: bounds both from the safe side */
+	late = (wake - g_tADS1256.DrdySince >= period);
+	bsp_DelayUS(t->T11SyncUs);
+
+	ADS1256_Send8Bit(CMD_WAKEUP);
+	bsp_DelayUS(t->T11Us);
+
+	ADS1256_Send8Bit(CMD_RDATA);
+	if (late || (ADS1256_NowRaw() - wake >= (int64_t)s_tabSettleUs[g_tADS1256.DataRate] * 1000))
+	{
+		g_tADS1256.Converting = ADS1256_CH_NONE;	/* late: not known which input was read */
+		g_tADS1256.Stats.Late++;
+	}
+	ADS1256_DelayDATA();
+
+	buf[0] = buf[1] = buf[2] = 0xFF;
+	ADS1256_SendBurst(buf, 3);
+
+	CS_1();	/* SPI   cs = 1 */
+
+	return ADS1256_Decode24(buf);
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_SyncHold
+*	function: First half of ADS1256_CycleMux for boards that must restart together: read the
+*			  finished conversion, select the next input and send SYNC, all in one CS frame. The
+*			  chip then waits, without converting, for the WAKEUP the group thread sends to every
+*			  board back to back once all of them are held.
+*	parameter: _mux : MUX register value of the next conversion
+*			   _gain : PGA of the next conversion
+*	The return value: the 24-bit conversion that was pending (signed)
+*********************************************************************************************************
+*/
+static int32_t ADS1256_SyncHold(uint8_t _mux, uint8_t _gain)
+{
+	const ADS1256_TIMING_T *t = &g_tADS1256.Timing;
+	uint8_t buf[4];
+	uint8_t len;
+	int32_t value;
+
+	CS_0();	/* SPI   cs = 0, held for the whole sequence */
+
+	ADS1256_Send8Bit(CMD_RDATA);
+	ADS1256_DelayDATA();
+
+	buf[0] = buf[1] = buf[2] = 0xFF;
+	ADS1256_SendBurst(buf, 3);
+	value = ADS1256_Decode24(buf);
+	bsp_DelayUS(t->T11Us);
+
+	len = ADS1256_MuxWrite(buf, _mux, _gain);
+	ADS1256_SendBurst(buf, len);
+	bsp_DelayUS(t->T11Us);
+	ADS1256_CalLoad(_gain);
+
+	ADS1256_Send8Bit(CMD_SYNC);
+
+	CS_1();	/* SPI   cs = 1 */
+
+	return value;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_StartContinuous
+*	function: Select a fixed channel and enter Read Data Continuously (RDATAC) mode.
+*			  The first conversion is clocked out together with the RDATAC command.
+*	parameter:  _ch:  scan list entry (channel number 0--7 with the default list)
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_StartContinuous(uint8_t _ch)
+{
+	const ADS1256_SCAN_ENTRY_T *e = &g_tADS1256.ScanList[_ch];
+	uint8_t buf[4];
+	uint8_t len, gain;
+
+	if (g_tADS1256.Continuous)
+	{
+		ADS1256_StopContinuous();
+	}
+
+	gain = ADS1256_EntryPga(_ch);	/* An auto-ranged entry keeps its gain: no WREG in RDATAC mode */
+	len = ADS1256_MuxWrite(buf, e->Mux, gain);
+	CS_0();	/* SPI   cs = 0 */
+	ADS1256_SendBurst(buf, len);
+	bsp_DelayUS(g_tADS1256.Timing.T11Us);
+	ADS1256_CalLoad(gain);
+	CS_1();	/* SPI   cs = 1 */
+
+	ADS1256_WriteCmd(CMD_SYNC);
+	bsp_DelayUS(g_tADS1256.Timing.T11SyncUs);
+
+	ADS1256_WriteCmd(CMD_WAKEUP);
+
+	/* RDATAC must be issued after DRDY goes low, it then returns the current result */
+	ADS1256_WaitDRDY();
+
+	CS_0();	/* SPI   cs = 0 */
+	ADS1256_Send8Bit(CMD_RDATAC);
+	ADS1256_DelayDATA();	/* t6 before the first data byte */
+	buf[0] = buf[1] = buf[2] = 0xFF;
+	ADS1256_SendBurst(buf, 3);
+	CS_1();	/* SPI   cs = 1 */
+
+	g_tADS1256.Channel = _ch;
+	g_tADS1256.Converting = ADS1256_CH_NONE;
+	g_tADS1256.ConvPga = gain;
+	g_tADS1256.Continuous = 1;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_ReadContinuous
+*	function: Wait for the next DRDY falling edge and clock out the 24 bit result.
+*			  No command byte is sent, the chip is already in RDATAC mode.
+*	parameter: NULL
+*	The return value:  ADC vaule (signed number), the previous one if DRDY timed out (g_tADS1256.Fault)
+*********************************************************************************************************
+*/
+int32_t ADS1256_ReadContinuous(void)
+{
+	uint8_t buf[3] = { 0xFF, 0xFF, 0xFF };
+
+	if (ADS1256_WaitDRDY() != 0)
+	{
+		return g_tADS1256.AdcNow[g_tADS1256.Channel];	/* Nothing to clock out, the glue reports the fault */
+	}
+
+	CS_0();	/* SPI   cs = 0 */
+
+	/* DIN is held at 0xFF so the clocked out bytes are never decoded as SDATAC or RESET */
+	ADS1256_SendBurst(buf, 3);
+
+	CS_1();	/* SPI   cs = 1 */
+
+	g_tADS1256.AdcNow[g_tADS1256.Channel] = ADS1256_Decode24(buf);
+	if (g_tADS1256.ScanList[g_tADS1256.Channel].Gain == ADS1256_GAIN_AUTO)
+	{
+		g_tADS1256.AdcNow[g_tADS1256.Channel] *= 1 << (ADS1256_GAIN_64 - g_tADS1256.ConvPga);
+	}
+	g_tADS1256.AdcPga[g_tADS1256.Channel] = g_tADS1256.ConvPga;
+	g_tADS1256.AdcTime[g_tADS1256.Channel] = g_tADS1256.DrdyTime;
+
+	return g_tADS1256.AdcNow[g_tADS1256.Channel];
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_StopContinuous
+*	function: Leave Read Data Continuously mode so that register and scan commands work again
+*	parameter: NULL
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_StopContinuous(void)
+{
+	if (!g_tADS1256.Continuous)
+	{
+		return;
+	}
+
+	/* SDATAC is issued after DRDY goes low, before the next result is shifted out */
+	ADS1256_WaitDRDY();
+	ADS1256_WriteCmd(CMD_SDATAC);
+
+	g_tADS1256.Continuous = 0;
+	g_tADS1256.Channel = 0;
+	g_tADS1256.Converting = ADS1256_CH_NONE;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_Resync
+*	function: Bring the chip back after a DRDY time out: leave RDATAC mode, check that it still
+*			  answers, write the whole configuration again (a brown-out resets the registers) and
+*			  restart the conversions with SYNC/WAKEUP. The scan starts again from the first entry.
+*	parameter: NULL
+*	The return value:  0 ok, EIO if the chip ID does not read back (latched in g_tADS1256.Fault)
+*********************************************************************************************************
+*/
+int ADS1256_Resync(void)
+{
+	const ADS1256_TIMING_T *t = &g_tADS1256.Timing;
+	uint8_t buf[6];
+
+	g_tADS1256.Stats.Resyncs++;
+	g_tADS1256.Continuous = 0;
+	g_tADS1256.Channel = 0;
+	g_tADS1256.Repeat = 0;
+	g_tADS1256.Converting = ADS1256_CH_NONE;
+	g_tADS1256.CalPga = ADS1256_GAIN_DEFAULT;	/* ADS1256_CalLoad writes the cached coefficients again */
+
+	ADS1256_WriteCmd(CMD_SDATAC);
+	bsp_DelayUS(t->T11Us);
+	if ((ADS1256_ReadReg(REG_STATUS) >> 4) != 3)
+	{
+		g_tADS1256.Stats.DeviceErrors++;
+		g_tADS1256.Stats.LastError = EIO;
+		if (g_tADS1256.Fault == 0)
+		{
+			g_tADS1256.Fault = EIO;
+		}
+		return EIO;
+	}
+
+	/* STATUS, MUX, ADCON and DRATE in one WREG, as ADS1256_CfgADC */
+	buf[0] = CMD_WREG | 0;
+	buf[1] = 3;
+	buf[2] = g_tADS1256.Status;
+	buf[3] = g_tADS1256.ScanList[0].Mux;
+	buf[4] = g_tADS1256.Adcon | g_tADS1256.Pga;
+	buf[5] = s_tabDataRate[g_tADS1256.DataRate];
+	CS_0();	/* SPI   cs = 0 */
+	ADS1256_SendBurst(buf, 6);
+	CS_1();	/* SPI   cs = 1 */
+	bsp_DelayUS(t->T11Us);
+
+	ADS1256_WriteCmd(CMD_SYNC);
+	bsp_DelayUS(t->T11SyncUs);
+	ADS1256_WriteCmd(CMD_WAKEUP);
+	return 0;
+}
+
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_GetAdc
+*	function: read ADC value
+*	parameter:  scan list entry (channel number 0--7 with the default list)
+*	The return value:  ADC vaule (signed number)
+*********************************************************************************************************
+*/
+int32_t ADS1256_GetAdc(uint8_t _ch)
+{
+	int32_t iTemp;
+
+	if (_ch >= g_tADS1256.ScanCount)
+	{
+		return 0;
+	}
+
+	iTemp = g_tADS1256.AdcNow[_ch];
+
+	return iTemp;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_ISR
+*	function: Collection procedures. Called once DRDY is low: starts the conversion of the next
+*			  scan list entry and stores the one that has just completed, in one CS frame
+*			  (ADS1256_CycleMux). An entry with Repeat n is converted n times before moving on.
+*			  Results of auto-ranged entries pick the PGA of their next conversion (ADS1256_AutoRange).
+*	parameter: NULL
+*	The return value:  channel ID (scan list entry) of the result stored in AdcNow, -1 if the
+*			  conversion that completed was not started by the scan (first call after a MUX change)
+*********************************************************************************************************
+*/
+int ADS1256_ISR(void)
+{
+	const ADS1256_SCAN_ENTRY_T *e = &g_tADS1256.ScanList[g_tADS1256.Channel];
+	uint8_t pga = ADS1256_EntryPga(g_tADS1256.Channel);
+
+	return ADS1256_ScanNext(ADS1256_CycleMux(e->Mux, pga), pga);
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_ScanNext
+*	function: Bookkeeping of the scan once the conversion of the current entry has been started:
+*			  store the result that came out, and step to the next entry (or the next repeat)
+*	parameter: _value : result of the conversion that has just completed
+*			   _pga : PGA the conversion just started runs at
+*	The return value:  channel ID (scan list entry) of _value, -1 if it was not started by the scan
+*********************************************************************************************************
+*/
+static int ADS1256_ScanNext(int32_t _value, uint8_t _pga)
+{
+	const ADS1256_SCAN_ENTRY_T *e = &g_tADS1256.ScanList[g_tADS1256.Channel];
+	uint8_t next = g_tADS1256.Channel;
+	uint8_t done = g_tADS1256.Converting;
+	uint8_t donePga = g_tADS1256.ConvPga;
+	int32_t value = _value;
+
+	g_tADS1256.Converting = next;
+	g_tADS1256.ConvPga = _pga;
+
+	if (++g_tADS1256.Repeat >= e->Repeat)
+	{
+		g_tADS1256.Repeat = 0;
+		if (++g_tADS1256.Channel >= g_tADS1256.ScanCount)
+		{
+			g_tADS1256.Channel = 0;
+		}
+	}
+
+	if (done == ADS1256_CH_NONE)
+	{
+		return -1;
+	}
+	if (g_tADS1256.ScanList[done].Gain == ADS1256_GAIN_AUTO)
+	{
+		value = ADS1256_AutoRange(done, value, donePga);
+	}
+	g_tADS1256.AdcNow[done] = value;
+	g_tADS1256.AdcPga[done] = donePga;
+	g_tADS1256.AdcTime[done] = g_tADS1256.DrdyTime;
+	return done;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_ScanLength
+*	function: Number of conversions in one pass over the scan list
+*	parameter: NULL
+*	The return value:  sum of the repeat counts
+*********************************************************************************************************
+*/
+uint32_t ADS1256_ScanLength(void)
+{
+	uint32_t n = 0;
+	uint8_t i;
+
+	for (i = 0; i < g_tADS1256.ScanCount; i++)
+	{
+		n += g_tADS1256.ScanList[i].Repeat;
+	}
+	return n;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_Scan
+*	function: 
+*	parameter:NULL
+*	The return value:  1
+*********************************************************************************************************
+*/
+uint8_t ADS1256_Scan(void)
+{
+	if (DRDY_IS_LOW())
+	{
+		g_tADS1256.DrdyTime = ADS1256_NowRaw();
+		ADS1256_ISR();
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_RingSize
+*	function: Round a ring capacity up to a power of two, at least 16
+*	parameter: _size : requested capacity, 1 .. ADS1256_RING_MAX
+*	The return value:  number of slots, 0 if _size is out of range
+*********************************************************************************************************
+*/
+uint32_t ADS1256_RingSize(uint32_t _size)
+{
+	uint32_t size = 16;
+
+	if ((_size == 0) || (_size > ADS1256_RING_MAX))
+	{
+		return 0;
+	}
+	while (size < _size)
+	{
+		size <<= 1;
+	}
+	return size;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_RingInit
+*	function: Allocate the sample ring
+*	parameter: _ring : ring to initialise
+*			   _size : requested number of samples, rounded up to a power of two
+*	The return value:  0 ok, 1 out of range or out of memory
+*********************************************************************************************************
+*/
+int ADS1256_RingInit(ADS1256_RING_T *_ring, uint32_t _size)
+{
+	uint32_t size = ADS1256_RingSize(_size);
+
+	if ((size == 0) || ((size_t)size > SIZE_MAX / sizeof(ADS1256_SAMPLE_T)))
+	{
+		return 1;
+	}
+	_ring->Buf = malloc((size_t)size * sizeof(ADS1256_SAMPLE_T));
+	if (_ring->Buf == NULL)
+	{
+		return 1;
+	}
+	_ring->Size = size;
+	_ring->Head = 0;
+	_ring->Tail = 0;
+	_ring->Dropped = 0;
+	return 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_RingFree
+*	function: Release the sample ring, no thread may use it any more
+*	parameter: _ring : ring
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_RingFree(ADS1256_RING_T *_ring)
+{
+	free(_ring->Buf);
+	_ring->Buf = NULL;
+	_ring->Size = 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_RingPush
+*	function: Producer side. The slot is filled before Head is published with release ordering,
+*			  so the consumer never sees a half written sample. A full ring drops the new sample.
+*	parameter: _ring : ring
+*			   _s : sample to store
+*	The return value:  1 stored, 0 dropped
+*********************************************************************************************************
+*/
+static int ADS1256_RingPush(ADS1256_RING_T *_ring, const ADS1256_SAMPLE_T *_s)
+{
+	uint32_t head = _ring->Head;
+	uint32_t tail = __atomic_load_n(&_ring->Tail, __ATOMIC_ACQUIRE);
+
+	if (head - tail >= _ring->Size)
+	{
+		__atomic_fetch_add(&_ring->Dropped, 1, __ATOMIC_RELAXED);
+		return 0;
+	}
+
+	_ring->Buf[head & (_ring->Size - 1)] = *_s;
+	__atomic_store_n(&_ring->Head, head + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_RingCount
+*	function: Number of samples waiting in the ring
+*	parameter: _ring : ring
+*	The return value:  sample count
+*********************************************************************************************************
+*/
+uint32_t ADS1256_RingCount(ADS1256_RING_T *_ring)
+{
+	uint32_t head = __atomic_load_n(&_ring->Head, __ATOMIC_ACQUIRE);
+
+	return head - _ring->Tail;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_RingRead
+*	function: Consumer side. Copy up to _max samples out of the ring in one batch.
+*	parameter: _ring : ring
+*			   _out : destination, room for _max samples
+*			   _max : batch size limit
+*			   _consume : 1 drain the copied samples, 0 only peek at them
+*	The return value:  number of samples copied
+*********************************************************************************************************
+*/
+uint32_t ADS1256_RingRead(ADS1256_RING_T *_ring, ADS1256_SAMPLE_T *_out, uint32_t _max, int _consume)
+{
+	uint32_t head = __atomic_load_n(&_ring->Head, __ATOMIC_ACQUIRE);
+	uint32_t tail = _ring->Tail;
+	uint32_t n = head - tail;
+	uint32_t i;
+
+	if (n > _max)
+	{
+		n = _max;
+	}
+
+	for (i = 0; i < n; i++)
+	{
+		_out[i] = _ring->Buf[(tail + i) & (_ring->Size - 1)];
+	}
+
+	if (_consume)
+	{
+		__atomic_store_n(&_ring->Tail, tail + n, __ATOMIC_RELEASE);
+	}
+	return n;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_AcqThread
+*	function: Acquisition thread. Runs the ADS1256_ISR scan loop without stopping and pushes
+*			  every conversion, tagged with its channel ID and DRDY timestamp, into the ring.
+*			  An entry with a filter pushes only the filter outputs, stamped with the DRDY time of
+*			  the conversion that completed them. With a control loop set, each value of its entry
+*			  drives the DAC before it is pushed (ADS1256_AcqControl). With a trigger set only the
+*			  trigger windows are pushed (ADS1256_AcqTrigger). When DRDY stays high for the whole DRDY timeout
+*			  the chip is resynchronised (ADS1256_Resync) and the loop goes on.
+*	parameter: _arg : the device (ADS1256_DEV_T)
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+static void *ADS1256_AcqThread(void *_arg)
+{
+	ADS1256_SAMPLE_T sample;
+	uint32_t idle = 0;
+	int ch;
+
+	s_pDev = _arg;
+	while (g_tAcq.Running)
+	{
+		/* Short timeout so that a stop request is seen even when DRDY never comes */
+		if (!ADS1256_WaitDRDYTimeout(100000))
+		{
+			/* Nothing for the whole DRDY timeout: count it and bring the chip back, then keep trying */
+			idle += 100000;
+			if (idle >= g_tADS1256.DrdyTimeoutUs)
+			{
+				idle = 0;
+				DEV_LOCK();
+				g_tADS1256.Stats.Timeouts++;
+				g_tADS1256.Stats.LastError = ETIMEDOUT;
+				ADS1256_Resync();
+				DEV_UNLOCK();
+			}
+			continue;
+		}
+		idle = 0;
+
+		DEV_LOCK();
+		ch = ADS1256_ISR();
+		if (ch >= 0)
+		{
+			sample.Value = g_tADS1256.AdcNow[ch];
+			sample.TimeNs = g_tADS1256.AdcTime[ch];
+		}
+		DEV_UNLOCK();
+
+		/* The first conversion belongs to whatever input was selected before the thread started */
+		if (ch < 0)
+		{
+			continue;
+		}
+		if ((g_tAcq.Filter[ch].Kind != ADS1256_FILTER_NONE) && !ADS1256_FilterRun(&g_tAcq.Filter[ch], sample.Value, &sample.Value))
+		{
+			continue;
+		}
+
+		sample.Channel = ch;
+		if ((g_tAcq.Control.Kind != ADS1256_CONTROL_NONE) && (ch == g_tAcq.Control.Entry))
+		{
+			ADS1256_AcqControl(&sample);
+		}
+		if (g_tAcq.Trigger.Kind != ADS1256_TRIGGER_NONE)
+		{
+			ADS1256_AcqTrigger(&sample);
+			continue;
+		}
+		ADS1256_AcqPush(&sample, 1);
+	}
+	return NULL;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_AcqPush
+*	function: Pass samples of the acquisition thread on to the ring and, when it runs, the logger
+*	parameter: _s : samples
+*			   _n : how many
+*	The return value:  samples stored in the acquisition ring, the others were dropped
+*********************************************************************************************************
+*/
+static uint32_t ADS1256_AcqPush(const ADS1256_SAMPLE_T *_s, uint32_t _n)
+{
+	uint32_t i, n = 0;
+
+	for (i = 0; i < _n; i++)
+	{
+		n += ADS1256_RingPush(&g_tAcq.Ring, &_s[i]);
+	}
+
+	/* Under the device lock so that ADS1256_StopLog can take the ring away safely */
+	DEV_LOCK();
+	if (g_tLog.Active)
+	{
+		for (i = 0; i < _n; i++)
+		{
+			ADS1256_RingPush(&g_tLog.Ring, &_s[i]);
+		}
+	}
+	DEV_UNLOCK();
+	return n;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_AcqControl
+*	function: Run the control loop on a value of its entry and write the output to the DAC at
+*			  once. The time from DRDY to the end of the write is kept as the loop latency.
+*	parameter: _s : sample of the entry
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+static void ADS1256_AcqControl(const ADS1256_SAMPLE_T *_s)
+{
+	ADS1256_CONTROL_T *c = &g_tAcq.Control;
+	uint16_t code[2];
+
+	code[0] = ADS1256_ControlRun(c, _s->Value, _s->TimeNs);
+	code[1] = code[0];
+
+	ADS1256_DacOut(c->Channel, code);
+
+	c->LatencyNs = ADS1256_NowRaw() - _s->TimeNs;
+	if (c->LatencyNs > c->LatencyMaxNs)
+	{
+		c->LatencyMaxNs = c->LatencyNs;
+	}
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_AcqTrigger
+*	function: Run a sample through the trigger and pass on only the windows: the history when the
+*			  trigger fires, then the window itself. A complete window is queued in g_tAcq.Win with
+*			  the number of its samples the ring took, so that the reader can split the stream.
+*	parameter: _s : sample
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+static void ADS1256_AcqTrigger(const ADS1256_SAMPLE_T *_s)
+{
+	ADS1256_TRIGGER_T *t = &g_tAcq.Trigger;
+	ADS1256_WINDOW_T *w = &g_tAcq.WinNow;
+	ADS1256_SAMPLE_T batch[64];
+	uint32_t head = g_tAcq.WinHead;
+	uint32_t k, n;
+	int act;
+
+	/* A window only starts if its slot in the queue is free: the reader alone empties the queue */
+	act = ADS1256_TriggerRun(t, _s, head - __atomic_load_n(&g_tAcq.WinTail, __ATOMIC_ACQUIRE) < ADS1256_WINDOW_MAX);
+	if (act & ADS1256_TRIGGER_FIRE)
+	{
+		w->TimeNs = t->TimeNs;
+		w->Pre = 0;
+		for (k = 0; (n = ADS1256_TriggerHistory(t, k, batch, 64)) > 0; k += n)
+		{
+			w->Pre += ADS1256_AcqPush(batch, n);
+		}
+		w->Count = w->Pre;
+	}
+	if (act & ADS1256_TRIGGER_PASS)
+	{
+		w->Count += ADS1256_AcqPush(_s, 1);
+	}
+	if (act & ADS1256_TRIGGER_DONE)
+	{
+		g_tAcq.Win[head & (ADS1256_WINDOW_MAX - 1)] = *w;
+		__atomic_store_n(&g_tAcq.WinHead, head + 1, __ATOMIC_RELEASE);
+	}
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_StartAcq
+*	function: Start the background acquisition thread
+*	parameter: _size : ring capacity in samples
+*	The return value:  0 ok, 1 error
+*********************************************************************************************************
+*/
+int ADS1256_StartAcq(uint32_t _size)
+{
+	uint8_t i;
+
+	if (g_tAcq.Active)
+	{
+		return 1;
+	}
+	ADS1256_StopContinuous();
+
+	if (ADS1256_RingInit(&g_tAcq.Ring, _size) != 0)
+	{
+		return 1;
+	}
+	for (i = 0; i < ADS1256_SCAN_MAX; i++)
+	{
+		ADS1256_FilterReset(&g_tAcq.Filter[i]);
+	}
+	if (g_tAcq.Trigger.Kind != ADS1256_TRIGGER_NONE)
+	{
+		ADS1256_TriggerReset(&g_tAcq.Trigger);
+	}
+	if (g_tAcq.Control.Kind != ADS1256_CONTROL_NONE)
+	{
+		ADS1256_ControlReset(&g_tAcq.Control);
+	}
+	g_tAcq.WinHead = 0;
+	g_tAcq.WinTail = 0;
+
+	g_tAcq.Running = 1;
+	if (pthread_create(&g_tAcq.Thread, NULL, ADS1256_AcqThread, s_pDev) != 0)
+	{
+		g_tAcq.Running = 0;
+		ADS1256_RingFree(&g_tAcq.Ring);
+		return 1;
+	}
+	g_tAcq.Active = 1;
+	return 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_StopAcq
+*	function: Stop the acquisition thread and release its ring, or stop the group the device is in.
+*			  Must be called without the device lock, the thread takes it on every conversion.
+*	parameter: NULL
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_StopAcq(void)
+{
+	ADS1256_GROUP_T *group;
+
+	if (!g_tAcq.Active)
+	{
+		return;
+	}
+
+	/* A group member: stopping it stops the whole group. The group is looked up under s_GroupLock
+	   so that it cannot be stopped and freed in between. */
+	pthread_mutex_lock(&s_GroupLock);
+	DEV_LOCK();
+	group = g_tAcq.Group;
+	DEV_UNLOCK();
+	if (group != NULL)
+	{
+		ADS1256_GroupHalt(group);
+	}
+	pthread_mutex_unlock(&s_GroupLock);
+	if (group != NULL)
+	{
+		return;
+	}
+
+	/* The logger has nothing left to write without its feed */
+	ADS1256_StopLog();
+
+	g_tAcq.Running = 0;
+	pthread_join(g_tAcq.Thread, NULL);
+
+	DEV_LOCK();
+	ADS1256_RingFree(&g_tAcq.Ring);
+	g_tAcq.Active = 0;
+	DEV_UNLOCK();
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_GroupDevLock
+*	function: Take or release the device lock of every board of a group, in the group order.
+*			  The groups never share a board, so the group threads cannot take them crosswise.
+*	parameter: _g : group
+*			   _lock : 1 to take, 0 to release
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+static void ADS1256_GroupDevLock(ADS1256_GROUP_T *_g, int _lock)
+{
+	uint8_t i;
+
+	for (i = 0; i < _g->Count; i++)
+	{
+		if (_lock)
+		{
+			pthread_mutex_lock(&_g->Dev[i]->DevLock);
+		}
+		else
+		{
+			pthread_mutex_unlock(&_g->Dev[_g->Count - 1 - i]->DevLock);
+		}
+	}
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_GroupThread
+*	function: Group thread. Waits until every board of the group has a conversion ready, holds
+*			  each one on its next input (ADS1256_SyncHold) and sends WAKEUP to all of them back
+*			  to back, so their conversions start within a few SPI frames of each other. The
+*			  results of one pass over the scan lists make a frame, published whole to the ring.
+*			  A board silent for its whole DRDY timeout is resynchronised and every board starts
+*			  its scan over; the partial frame is dropped.
+*	parameter: _arg : the group (ADS1256_GROUP_T)
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+static void *ADS1256_GroupThread(void *_arg)
+{
+	ADS1256_GROUP_T *g = _arg;
+	const ADS1256_SCAN_ENTRY_T *e;
+	int32_t value[ADS1256_GROUP_MAX];
+	uint8_t pga[ADS1256_GROUP_MAX];
+	int32_t *frame = NULL;		/* Frame being filled, NULL while the ring is full */
+	int64_t *stamp = NULL;
+	int64_t lo = 0, hi = 0;
+	uint32_t idle = 0;
+	uint32_t head;
+	uint32_t step = 0;			/* Slot of the conversions the next WAKEUP starts */
+	int done = -1;				/* Slot of the conversions running, -1 until the boards are in step */
+	uint8_t i;
+	int ch;
+
+	while (g->Running)
+	{
+		/* Boards already done keep DRDY low while the others are waited for */
+		for (i = 0; i < g->Count; i++)
+		{
+			s_pDev = g->Dev[i];
+			if (!ADS1256_WaitDRDYTimeout(100000))
+			{
+				break;
+			}
+		}
+		if (i < g->Count)
+		{
+			idle += 100000;
+			if (idle >= g_tADS1256.DrdyTimeoutUs)
+			{
+				idle = 0;
+				ADS1256_GroupDevLock(g, 1);
+				g_tADS1256.Stats.Timeouts++;
+				g_tADS1256.Stats.LastError = ETIMEDOUT;
+				ADS1256_Resync();
+				for (i = 0; i < g->Count; i++)
+				{
+					g->Dev[i]->Var.Channel = 0;
+					g->Dev[i]->Var.Repeat = 0;
+				}
+				ADS1256_GroupDevLock(g, 0);
+				g->Restarts++;
+				frame = NULL;
+				stamp = NULL;
+				done = -1;
+				step = 0;
+			}
+			continue;
+		}
+		idle = 0;
+
+		/* The bus is held over the whole burst, so that no other frame gets between the WAKEUPs;
+		   each frame still takes it again and sets the clock of its own board */
+		ADS1256_GroupDevLock(g, 1);
+		BUS_LOCK();
+		for (i = 0; i < g->Count; i++)
+		{
+			s_pDev = g->Dev[i];
+			e = &g_tADS1256.ScanList[g_tADS1256.Channel];
+			pga[i] = ADS1256_EntryPga(g_tADS1256.Channel);
+			value[i] = ADS1256_SyncHold(e->Mux, pga[i]);
+		}
+		bsp_DelayUS(g_tADS1256.Timing.T11SyncUs);
+		for (i = 0; i < g->Count; i++)
+		{
+			s_pDev = g->Dev[i];
+			ADS1256_WriteCmd(CMD_WAKEUP);
+		}
+		BUS_UNLOCK();
+
+		for (i = 0; i < g->Count; i++)
+		{
+			s_pDev = g->Dev[i];
+			ch = ADS1256_ScanNext(value[i], pga[i]);
+			if ((i == 0) || (g_tADS1256.DrdyTime < lo))
+			{
+				lo = g_tADS1256.DrdyTime;
+			}
+			if ((i == 0) || (g_tADS1256.DrdyTime > hi))
+			{
+				hi = g_tADS1256.DrdyTime;
+			}
+			if ((frame != NULL) && (ch >= 0))
+			{
+				frame[i * g->Slots + done] = g_tADS1256.AdcNow[ch];
+				stamp[i * g->Slots + done] = g_tADS1256.AdcTime[ch];
+			}
+		}
+		ADS1256_GroupDevLock(g, 0);
+
+		if (done >= 0)
+		{
+			if (hi - lo > g->SkewNs)
+			{
+				g->SkewNs = hi - lo;
+			}
+			if ((uint32_t)done == g->Slots - 1)
+			{
+				g->Frames++;
+				if (frame != NULL)
+				{
+					__atomic_store_n(&g->Head, g->Head + 1, __ATOMIC_RELEASE);
+				}
+				else
+				{
+					g->Dropped++;
+				}
+			}
+		}
+
+		/* The conversions just started open a frame when they are the first of a pass */
+		done = step;
+		step = (step + 1 < g->Slots) ? step + 1 : 0;
+		if (done == 0)
+		{
+			head = g->Head;
+			if (head - __atomic_load_n(&g->Tail, __ATOMIC_ACQUIRE) < g->Size)
+			{
+				frame = g->Values + (size_t)(head & (g->Size - 1)) * g->Width;
+				stamp = g->Times + (size_t)(head & (g->Size - 1)) * g->Width;
+			}
+			else
+			{
+				frame = NULL;
+				stamp = NULL;
+			}
+		}
+	}
+	return NULL;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_GroupStart
+*	function: Take the boards of a group away from their own acquisition and start the group
+*			  thread. The boards must be started, idle, and have the same data rate and the same
+*			  number of conversions per pass; their scans restart from the first entry.
+*			  Must be called without the device locks.
+*	parameter: _g : group, Dev[] and Count filled in
+*			   _size : ring capacity in frames, rounded up to a power of two, ADS1256_RING_MAX at most
+*	The return value:  0 ok, ENODEV a board is not started, EBUSY a board is already acquiring,
+*			  EINVAL the boards differ or _size is out of range, ENOMEM, or EAGAIN the thread could not be created
+*********************************************************************************************************
+*/
+int ADS1256_GroupStart(ADS1256_GROUP_T *_g, uint32_t _size)
+{
+	ADS1256_DEV_T *caller = s_pDev;
+	uint32_t size = ADS1256_RingSize(_size);
+	uint8_t rate = 0;
+	uint8_t taken = 0;
+	uint8_t i;
+	int ret = 0;
+
+	if (size == 0)
+	{
+		return EINVAL;
+	}
+
+	pthread_mutex_lock(&s_GroupLock);
+	if (_g->Active)
+	{
+		pthread_mutex_unlock(&s_GroupLock);
+		return EBUSY;
+	}
+	for (i = 0; (i < _g->Count) && (ret == 0); i++)
+	{
+		s_pDev = _g->Dev[i];
+		DEV_LOCK();
+		if (!g_tADS1256.Opened)
+		{
+			ret = ENODEV;
+		}
+		else if (g_tAcq.Active)
+		{
+			ret = EBUSY;	/* Also a board given twice */
+		}
+		else if (g_tAcq.Control.Kind != ADS1256_CONTROL_NONE)
+		{
+			ret = EINVAL;	/* The control loop runs in the acquisition thread of the board only */
+		}
+		else if ((i > 0) && ((ADS1256_ScanLength() != _g->Slots) || (g_tADS1256.DataRate != rate)))
+		{
+			ret = EINVAL;
+		}
+		else
+		{
+			ADS1256_StopContinuous();
+			_g->Slots = ADS1256_ScanLength();
+			rate = g_tADS1256.DataRate;
+			g_tADS1256.Channel = 0;
+			g_tADS1256.Repeat = 0;
+			g_tAcq.Group = _g;
+			g_tAcq.Active = 1;
+			taken++;
+		}
+		DEV_UNLOCK();
+	}
+
+	if (ret == 0)
+	{
+		free(_g->Values);
+		free(_g->Times);
+		_g->Values = NULL;
+		_g->Times = NULL;
+		_g->Width = _g->Count * _g->Slots;
+		if ((size_t)size <= SIZE_MAX / _g->Width / sizeof(int64_t))
+		{
+			_g->Values = malloc((size_t)size * _g->Width * sizeof(int32_t));
+			_g->Times = malloc((size_t)size * _g->Width * sizeof(int64_t));
+		}
+		if ((_g->Values == NULL) || (_g->Times == NULL))
+		{
+			ret = ENOMEM;
+		}
+	}
+	if (ret == 0)
+	{
+		_g->Size = size;
+		_g->Head = 0;
+		_g->Tail = 0;
+		_g->Dropped = 0;
+		_g->Frames = 0;
+		_g->Restarts = 0;
+		_g->SkewNs = 0;
+		_g->Running = 1;
+		if (pthread_create(&_g->Thread, NULL, ADS1256_GroupThread, _g) != 0)
+		{
+			_g->Running = 0;
+			ret = EAGAIN;
+		}
+	}
+
+	if (ret != 0)
+	{
+		for (i = 0; i < taken; i++)
+		{
+			s_pDev = _g->Dev[i];
+			DEV_LOCK();
+			g_tAcq.Group = NULL;
+			g_tAcq.Active = 0;
+			DEV_UNLOCK();
+		}
+	}
+	else
+	{
+		_g->Active = 1;
+	}
+	pthread_mutex_unlock(&s_GroupLock);
+	s_pDev = caller;
+	return ret;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_GroupHalt
+*	function: Stop the group thread and give the boards back; the frames left in the ring can
+*			  still be read. The caller holds s_GroupLock and none of the device locks.
+*	parameter: _g : group
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+static void ADS1256_GroupHalt(ADS1256_GROUP_T *_g)
+{
+	ADS1256_DEV_T *caller = s_pDev;
+	uint8_t i;
+
+	if (!_g->Active)
+	{
+		return;
+	}
+
+	_g->Running = 0;
+	pthread_join(_g->Thread, NULL);
+
+	for (i = 0; i < _g->Count; i++)
+	{
+		s_pDev = _g->Dev[i];
+		DEV_LOCK();
+		g_tAcq.Group = NULL;
+		g_tAcq.Active = 0;
+		DEV_UNLOCK();
+	}
+	_g->Active = 0;
+	s_pDev = caller;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_GroupStop
+*	function: Stop a group, see ADS1256_GroupHalt. Does nothing if it is not running.
+*	parameter: _g : group
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_GroupStop(ADS1256_GROUP_T *_g)
+{
+	pthread_mutex_lock(&s_GroupLock);
+	ADS1256_GroupHalt(_g);
+	pthread_mutex_unlock(&s_GroupLock);
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_LogCut
+*	function: After a failed write, cut the file back to the header and its whole records, so that
+*			  record i still starts at HeaderSize + i * RecordSize, and drop the buffer. The samples
+*			  of the records lost are counted as dropped; a record whose head had already been
+*			  written is counted whole, only its tail is left in the buffer.
+*	parameter: _off : bytes of the buffer written before the error
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+static void ADS1256_LogCut(uint32_t _off)
+{
+	const int32_t *value;
+	uint32_t size = g_tLog.Header.RecordSize;
+	uint64_t end = g_tLog.FileBytes + _off;		/* What the file holds now */
+	uint64_t keep = end;
+	uint64_t pos;
+	uint32_t k;
+
+	if (end > ADS1256_LOG_HEADER_SIZE)
+	{
+		keep -= (end - ADS1256_LOG_HEADER_SIZE) % size;
+	}
+	if ((keep < end) && (ftruncate(g_tLog.Fd, keep) != 0))
+	{
+		keep = end;		/* The reader skips a partial last record anyway */
+	}
+
+	pos = (keep > ADS1256_LOG_HEADER_SIZE) ? keep : ADS1256_LOG_HEADER_SIZE;
+	for (; pos + size <= g_tLog.FileBytes + g_tLog.BufLen; pos += size)
+	{
+		if (pos < g_tLog.FileBytes)
+		{
+			g_tLog.Dropped += g_tLog.SeqLen;
+			continue;
+		}
+		value = (const int32_t *)(g_tLog.Buf + (pos - g_tLog.FileBytes) + g_tLog.Header.ValuesOffset);
+		for (k = 0; k < g_tLog.SeqLen; k++)
+		{
+			if (value[k] != ADS1256_LOG_MISSING)
+			{
+				g_tLog.Dropped++;
+			}
+		}
+	}
+
+	g_tLog.Written = g_tLog.Written - g_tLog.FileBytes + keep;
+	g_tLog.FileBytes = keep;
+	g_tLog.BufLen = 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_LogWrite
+*	function: Write the logger buffer to the current file. With O_DIRECT only whole
+*			  ADS1256_LOG_ALIGN blocks can go out; the rest stays in the buffer unless _final,
+*			  in which case O_DIRECT is dropped for the tail. A failed write, also after a short
+*			  one, leaves the file cut back to whole records (ADS1256_LogCut).
+*	parameter: _final : 1 before closing the file
+*	The return value:  0 ok, errno of the failed write
+*********************************************************************************************************
+*/
+static int ADS1256_LogWrite(int _final)
+{
+	uint32_t len = g_tLog.BufLen;
+	uint32_t off = 0;
+	ssize_t n;
+
+	if (g_tLog.Direct && !_final)
+	{
+		len -= len % ADS1256_LOG_ALIGN;
+	}
+	if (g_tLog.Direct && _final && (len % ADS1256_LOG_ALIGN))
+	{
+		fcntl(g_tLog.Fd, F_SETFL, fcntl(g_tLog.Fd, F_GETFL) & ~O_DIRECT);
+	}
+
+	while (off < len)
+	{
+		n = write(g_tLog.Fd, g_tLog.Buf + off, len - off);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			g_tLog.Errors++;
+			g_tLog.LastErrno = errno;
+			ADS1256_LogCut(off);
+			return g_tLog.LastErrno;
+		}
+		off += n;
+	}
+
+	g_tLog.FileBytes += off;
+	g_tLog.Written += off;
+	memmove(g_tLog.Buf, g_tLog.Buf + len, g_tLog.BufLen - len);
+	g_tLog.BufLen -= len;
+	return 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_LogOpen
+*	function: Open the next file of the rotation and put its header, padded to HeaderSize,
+*			  in the buffer
+*	parameter: NULL
+*	The return value:  0 ok, errno of open() otherwise
+*********************************************************************************************************
+*/
+static int ADS1256_LogOpen(void)
+{
+	char name[256];
+	int flags = O_WRONLY | O_CREAT | O_TRUNC;
+
+	if (g_tLog.Direct)
+	{
+		flags |= O_DIRECT;
+	}
+
+	g_tLog.FileStartNs = 0;
+	snprintf(name, sizeof(name), "%s-%06u.ads", g_tLog.Path, (unsigned)g_tLog.Files);
+	g_tLog.Fd = open(name, flags, 0644);
+	if (g_tLog.Fd < 0)
+	{
+		g_tLog.Errors++;
+		g_tLog.LastErrno = errno;
+		return errno;
+	}
+
+	g_tLog.Header.FileIndex = g_tLog.Files++;
+	g_tLog.FileBytes = 0;
+	memset(g_tLog.Buf, 0, ADS1256_LOG_HEADER_SIZE);
+	memcpy(g_tLog.Buf, &g_tLog.Header, sizeof(g_tLog.Header));
+	g_tLog.BufLen = ADS1256_LOG_HEADER_SIZE;
+	return 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_LogClose
+*	function: Write what is left in the buffer and close the current file
+*	parameter: NULL
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+static void ADS1256_LogClose(void)
+{
+	if (g_tLog.Fd < 0)
+	{
+		return;
+	}
+	ADS1256_LogWrite(1);
+	fdatasync(g_tLog.Fd);
+	close(g_tLog.Fd);
+	g_tLog.Fd = -1;
+	g_tLog.BufLen = 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_LogClearRec
+*	function: Reset the record being filled: every slot missing until a sample lands in it
+*	parameter: NULL
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+static void ADS1256_LogClearRec(void)
+{
+	int32_t *value = (int32_t *)(g_tLog.Rec + g_tLog.Header.ValuesOffset);
+	uint32_t k;
+
+	memset(g_tLog.Rec, 0, g_tLog.Header.RecordSize);
+	for (k = 0; k < g_tLog.SeqLen; k++)
+	{
+		value[k] = ADS1256_LOG_MISSING;
+	}
+	g_tLog.RecFill = 0;
+	g_tLog.SeqPos = 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_LogEmit
+*	function: Append the record being filled to the write buffer, rotating the file first if it
+*			  is due, and start a new record. Records never straddle two files. After a failed
+*			  write the capture goes on in the next file; if the failed one did not get a single
+*			  record (a full disk) the logger stops writing, as when a file cannot be opened.
+*	parameter: NULL
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+static void ADS1256_LogEmit(void)
+{
+	uint32_t size = g_tLog.Header.RecordSize;
+
+	if (g_tLog.FileStartNs != 0)
+	{
+		if (((g_tLog.RotateBytes != 0) && (g_tLog.FileBytes + g_tLog.BufLen + size > g_tLog.RotateBytes)) ||
+			((g_tLog.RotateNs != 0) && (g_tLog.RecStartNs - g_tLog.FileStartNs >= g_tLog.RotateNs)))
+		{
+			ADS1256_LogClose();
+			ADS1256_LogOpen();
+		}
+	}
+
+	if ((g_tLog.Fd >= 0) && (g_tLog.BufLen + size > g_tLog.BufSize) && (ADS1256_LogWrite(0) != 0))
+	{
+		if (g_tLog.FileBytes > ADS1256_LOG_HEADER_SIZE)
+		{
+			ADS1256_LogClose();
+			ADS1256_LogOpen();
+		}
+		else
+		{
+			close(g_tLog.Fd);
+			g_tLog.Fd = -1;
+			g_tLog.FileStartNs = 0;		/* No retry at the next rotation either */
+		}
+	}
+
+	if (g_tLog.Fd < 0)
+	{
+		g_tLog.Dropped += g_tLog.RecFill;	/* The next file could not be opened, see LastErrno */
+	}
+	else
+	{
+		if (g_tLog.FileStartNs == 0)
+		{
+			g_tLog.FileStartNs = g_tLog.RecStartNs;
+		}
+		memcpy(g_tLog.Buf + g_tLog.BufLen, g_tLog.Rec, size);
+		g_tLog.BufLen += size;
+	}
+
+	ADS1256_LogClearRec();
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_LogThread
+*	function: Writer thread. Places the samples from the logger ring in the slots of the current
+*			  record, moves complete records into the write buffer, writes the buffer out whenever
+*			  it is full and rotates the files. A sample that is not the one expected next means
+*			  the rings dropped some: the slots in between are left missing.
+*			  On stop it drains the ring and writes the partial record before closing the last file.
+*	parameter: _arg : the device (ADS1256_DEV_T)
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+static void *ADS1256_LogThread(void *_arg)
+{
+	ADS1256_SAMPLE_T batch[256];
+	struct timespec idle = { 0, 5000000 };	/* 5 ms, the ring absorbs the samples meanwhile */
+	int64_t *time;
+	int32_t *value;
+	uint32_t i, k, n;
+
+	s_pDev = _arg;
+	time = (int64_t *)g_tLog.Rec;
+	value = (int32_t *)(g_tLog.Rec + g_tLog.Header.ValuesOffset);
+	ADS1256_LogClearRec();
+
+	while (1)
+	{
+		n = ADS1256_RingRead(&g_tLog.Ring, batch, 256, 1);
+		if (n == 0)
+		{
+			if (!g_tLog.Running)
+			{
+				break;
+			}
+			nanosleep(&idle, NULL);
+			continue;
+		}
+
+		for (i = 0; i < n; i++)
+		{
+			for (k = 0; (k < g_tLog.SeqLen) && (g_tLog.Seq[g_tLog.SeqPos] != batch[i].Channel); k++)
+			{
+				if (++g_tLog.SeqPos == g_tLog.SeqLen)
+				{
+					if (g_tLog.RecFill != 0)
+					{
+						ADS1256_LogEmit();
+					}
+					g_tLog.SeqPos = 0;
+				}
+			}
+			if (k == g_tLog.SeqLen)
+			{
+				g_tLog.Dropped++;	/* Not an entry of the logged scan list */
+				continue;
+			}
+
+			if (g_tLog.RecFill++ == 0)
+			{
+				g_tLog.RecStartNs = batch[i].TimeNs;
+			}
+			time[g_tLog.SeqPos] = batch[i].TimeNs;
+			value[g_tLog.SeqPos] = batch[i].Value;
+			if (++g_tLog.SeqPos == g_tLog.SeqLen)
+			{
+				ADS1256_LogEmit();
+			}
+		}
+	}
+
+	if (g_tLog.RecFill != 0)
+	{
+		ADS1256_LogEmit();
+	}
+	ADS1256_LogClose();
+	return NULL;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_StartLog
+*	function: Start the binary logger on the running acquisition. The header records the
+*			  configuration at this moment: gain, DRATE, SPI clock, scan list and the time base.
+*	parameter: _path : base name of the files
+*			   _rotBytes : rotate past this file size, 0 = never
+*			   _rotNs : rotate after this much sample time, 0 = never
+*			   _direct : 1 to bypass the page cache with O_DIRECT
+*			   _bufSize : write buffer in bytes, rounded up to ADS1256_LOG_ALIGN and to at least
+*						  the header plus one record
+*			   _size : logger ring capacity in samples, ADS1256_RING_MAX at most
+*	The return value:  0 ok, EBUSY already logging, ESRCH acquisition not running or the device
+*			  is in a group, ENOMEM, or errno of opening the first file
+*********************************************************************************************************
+*/
+int ADS1256_StartLog(const char *_path, uint64_t _rotBytes, int64_t _rotNs, int _direct, uint32_t _bufSize, uint32_t _size)
+{
+	ADS1256_LOG_HEADER_T *h = &g_tLog.Header;
+	struct timespec real;
+	uint32_t len, minSize;
+	uint8_t i, r;
+	int ret;
+
+	if (g_tLog.Active || g_tLog.Running)
+	{
+		return EBUSY;
+	}
+	if (!g_tAcq.Active || (g_tAcq.Group != NULL))
+	{
+		return ESRCH;		/* Group frames do not go through the acquisition ring */
+	}
+
+	snprintf(g_tLog.Path, sizeof(g_tLog.Path), "%s", _path);
+	g_tLog.Direct = _direct;
+	g_tLog.RotateBytes = _rotBytes;
+	g_tLog.RotateNs = _rotNs;
+	len = ADS1256_ScanLength();
+	minSize = ADS1256_LOG_HEADER_SIZE + ADS1256_LOG_RECORD_SIZE(len);
+	if (_bufSize < minSize)
+	{
+		_bufSize = minSize;		/* Room for the header, or a partial block, and a whole record */
+	}
+	g_tLog.BufSize = (_bufSize + ADS1256_LOG_ALIGN - 1) / ADS1256_LOG_ALIGN * ADS1256_LOG_ALIGN;
+	g_tLog.BufLen = 0;
+	g_tLog.Written = 0;
+	g_tLog.Files = 0;
+	g_tLog.Errors = 0;
+	g_tLog.LastErrno = 0;
+	g_tLog.Dropped = 0;
+	g_tLog.SeqLen = 0;
+
+	memset(h, 0, sizeof(*h));
+	memcpy(h->Magic, ADS1256_LOG_MAGIC, sizeof(h->Magic));
+	h->ByteOrder = ADS1256_LOG_BYTE_ORDER;
+	h->Version = ADS1256_LOG_VERSION;
+	h->HeaderSize = ADS1256_LOG_HEADER_SIZE;
+	h->RecordSize = ADS1256_LOG_RECORD_SIZE(len);
+	h->ScanLength = len;
+	h->ValuesOffset = len * sizeof(int64_t);
+	h->Gain = g_tADS1256.Gain;
+	h->Drate = s_tabDataRate[g_tADS1256.DataRate];
+	h->SclkHz = g_tADS1256.Timing.SclkHz;
+	h->TimeBaseRawNs = ADS1256_NowRaw();
+	clock_gettime(CLOCK_REALTIME, &real);
+	h->TimeBaseRealNs = (int64_t)real.tv_sec * 1000000000 + real.tv_nsec;
+	h->VrefVolts = g_tADS1256.Vref;
+	h->ScanCount = g_tADS1256.ScanCount;
+	for (i = 0; i < g_tADS1256.ScanCount; i++)
+	{
+		h->Scan[i].Mux = g_tADS1256.ScanList[i].Mux;
+		h->Scan[i].Gain = g_tADS1256.ScanList[i].Gain;
+		h->Scan[i].Repeat = g_tADS1256.ScanList[i].Repeat;
+		for (r = 0; r < g_tADS1256.ScanList[i].Repeat; r++)
+		{
+			g_tLog.Seq[g_tLog.SeqLen++] = i;
+		}
+	}
+
+	if (posix_memalign((void **)&g_tLog.Buf, ADS1256_LOG_ALIGN, g_tLog.BufSize) != 0)
+	{
+		return ENOMEM;
+	}
+	g_tLog.Rec = malloc(h->RecordSize);
+	if ((g_tLog.Rec == NULL) || (ADS1256_RingInit(&g_tLog.Ring, _size) != 0))
+	{
+		free(g_tLog.Rec);
+		free(g_tLog.Buf);
+		return ENOMEM;
+	}
+
+	ret = ADS1256_LogOpen();
+	if (ret != 0)
+	{
+		ADS1256_RingFree(&g_tLog.Ring);
+		free(g_tLog.Rec);
+		free(g_tLog.Buf);
+		return ret;
+	}
+
+	g_tLog.Running = 1;
+	if (pthread_create(&g_tLog.Thread, NULL, ADS1256_LogThread, s_pDev) != 0)
+	{
+		g_tLog.Running = 0;
+		ADS1256_LogClose();
+		ADS1256_RingFree(&g_tLog.Ring);
+		free(g_tLog.Rec);
+		free(g_tLog.Buf);
+		return ENOMEM;
+	}
+	g_tLog.Active = 1;
+	return 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_StopLog
+*	function: Detach the logger from the acquisition thread, let the writer drain its ring,
+*			  close the last file and release the buffers.
+*			  Must be called without the device lock.
+*	parameter: NULL
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_StopLog(void)
+{
+	if (!g_tLog.Running)
+	{
+		return;
+	}
+
+	DEV_LOCK();
+	g_tLog.Active = 0;
+	DEV_UNLOCK();
+
+	g_tLog.Running = 0;
+	pthread_join(g_tLog.Thread, NULL);
+
+	g_tLog.Dropped += g_tLog.Ring.Dropped;
+	ADS1256_RingFree(&g_tLog.Ring);
+	free(g_tLog.Rec);
+	g_tLog.Rec = NULL;
+	free(g_tLog.Buf);
+	g_tLog.Buf = NULL;
+}
+
+/*
+*********************************************************************************************************
+*	name: Write_DAC8552
+*	function:  DAC send data, on the CS of the DAC8552 (it used to select the ADS1256).
+*			  The bus is switched to the DAC clock; the ADS1256 gets its own back when it
+*			  takes the bus next (ADS1256_BusOwn). Called with s_BusLock held.
+*	parameter: channel : control byte, DAC_BUF_B | DAC_LDA | DAC_LDB
+*			   data : output DAC value 
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void Write_DAC8552(uint8_t channel, uint16_t Data)
+{
+	uint8_t buf[3];
+
+	buf[0] = channel;
+	buf[1] = Data >> 8;
+	buf[2] = Data & 0xff;
+
+	if (!s_BusDac)
+	{
+		g_tADS1256.Transport->SetClock(ADS1256_DAC_SCLK_HZ);
+		s_pBusOwner = NULL;
+		s_BusDac = 1;
+	}
+
+	DAC_CS_0();
+	ADS1256_SendBurst(buf, 3);
+	DAC_CS_1();
+}
+/*
+*********************************************************************************************************
+*	name: Voltage_Convert
+*	function:  Voltage value conversion function
+*	parameter: Vref : The reference voltage 3.3V or 5V
+*			   voltage : output DAC value 
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+uint16_t Voltage_Convert(float Vref, float voltage)
+{
+	float _D_;
+	_D_ = 65536 * voltage / Vref;
+
+	/* Vref itself used to wrap around to 0 */
+	if (_D_ <= 0)
+	{
+		return 0;
+	}
+	if (_D_ >= 65535)
+	{
+		return 65535;
+	}
+	return (uint16_t)_D_;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_DacOut
+*	function: Load one frame in the outputs. With both channels A goes to its buffer first and B
+*			  loads both DACs, so the two outputs change together. The frame is one transaction on
+*			  the bus: it goes out between two frames of the ADCs, also while a read waits for DRDY.
+*	parameter: _channels : ADS1256_DAC_A, _B or _AB
+*			   _codes : one code, two for ADS1256_DAC_AB (A then B)
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+static void ADS1256_DacOut(uint8_t _channels, const uint16_t *_codes)
+{
+	pthread_mutex_lock(&s_BusLock);		/* The DAC runs the bus at its own clock, no ADS1256_BusOwn */
+	switch (_channels)
+	{
+	case ADS1256_DAC_A:
+		Write_DAC8552(DAC_LDA, _codes[0]);
+		g_tDac.Code[0] = _codes[0];
+		break;
+
+	case ADS1256_DAC_B:
+		Write_DAC8552(DAC_BUF_B | DAC_LDB, _codes[0]);
+		g_tDac.Code[1] = _codes[0];
+		break;
+
+	default:
+		Write_DAC8552(0, _codes[0]);
+		Write_DAC8552(DAC_BUF_B | DAC_LDA | DAC_LDB, _codes[1]);
+		g_tDac.Code[0] = _codes[0];
+		g_tDac.Code[1] = _codes[1];
+		break;
+	}
+	pthread_mutex_unlock(&s_BusLock);
+}
+
+static int64_t ADS1256_DacNow(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Sleep until ADS1256_DAC_SPIN_US before _at, CLOCK_MONOTONIC ns, then spin: the wake-up latency of
+   the scheduler is well above the period at the higher rates */
+static void ADS1256_DacSleep(int64_t _at)
+{
+	struct timespec ts;
+	int64_t wake = _at - ADS1256_DAC_SPIN_US * 1000;
+
+	if (ADS1256_DacNow() < wake)
+	{
+		ts.tv_sec = wake / 1000000000;
+		ts.tv_nsec = wake % 1000000000;
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+	}
+	while (ADS1256_DacNow() < _at);
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_DacPass
+*	function: End of a pass over the buffer playing: take the queued buffer over, start the same
+*			  one again when looping, or hold the outputs until a buffer is queued
+*	parameter: _pos : frame reached, at or past the end of the buffer
+*	The return value: frame to play next, CurLen while starved
+*********************************************************************************************************
+*/
+static uint32_t ADS1256_DacPass(uint32_t _pos)
+{
+	ADS1256_DAC_T *d = &g_tDac;
+
+	pthread_mutex_lock(&d->Lock);
+	if (d->Next != NULL)
+	{
+		_pos = d->Starved ? 0 : (_pos - d->CurLen);
+		d->Spent = d->Cur;
+		d->Cur = d->Next;
+		d->CurLen = d->NextLen;
+		d->Next = NULL;
+		d->Buffers++;
+		d->Starved = 0;
+		pthread_cond_broadcast(&d->Cond);
+		if (_pos >= d->CurLen)
+		{
+			_pos = 0;	/* Late by more than the whole new buffer */
+		}
+	}
+	else if (d->Loop)
+	{
+		_pos %= d->CurLen;
+	}
+	else
+	{
+		if (!d->Starved)
+		{
+			d->Underruns++;
+		}
+		d->Starved = 1;
+		_pos = d->CurLen;
+	}
+	pthread_mutex_unlock(&d->Lock);
+	return _pos;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_DacThread
+*	function: Playback thread. Writes one frame of the buffer every PeriodNs on an absolute
+*			  CLOCK_MONOTONIC schedule, so the rate does not drift with the time each write takes.
+*			  Frames that came due while the thread was held up are left out, keeping the waveform
+*			  in time, and counted as late. SCHED_FIFO is asked for and used if granted.
+*	parameter: _arg : the device (ADS1256_DEV_T)
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+static void *ADS1256_DacThread(void *_arg)
+{
+	ADS1256_DAC_T *d;
+	struct sched_param sp;
+	const uint16_t *codes;
+	uint32_t width, pos = 0;
+	int64_t next, skip;
+
+	s_pDev = _arg;
+	d = &g_tDac;
+	width = (d->Channels == ADS1256_DAC_AB) ? 2 : 1;
+
+	/* Needs root or CAP_SYS_NICE, like bcm2835 itself: without it the thread runs at normal priority */
+	sp.sched_priority = sched_get_priority_min(SCHED_FIFO) + 10;
+	d->Realtime = (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) == 0);
+
+	next = ADS1256_DacNow();
+	while (d->Running)
+	{
+		ADS1256_DacSleep(next);
+
+		skip = d->Starved ? 0 : (ADS1256_DacNow() - next) / d->PeriodNs;
+		if (skip > 0)
+		{
+			d->Late += skip;
+			next += skip * d->PeriodNs;
+			pos += skip;
+		}
+		if (pos >= d->CurLen)
+		{
+			pos = ADS1256_DacPass(pos);
+		}
+
+		if (!d->Starved)
+		{
+			codes = &d->Cur[pos * width];
+			ADS1256_DacOut(d->Channels, codes);
+			d->Frames++;
+			pos++;
+		}
+		next += d->PeriodNs;
+	}
+	return NULL;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_DacStart
+*	function: Start the playback thread on a buffer. The device must be open and must not be
+*			  playing; called with g_tDac.Lock held.
+*	parameter: _codes : _frames frames of 1 or 2 codes, malloc'ed: the thread owns it from now on
+*			   _frames : frames in _codes
+*			   _channels : ADS1256_DAC_A, _B or _AB
+*			   _periodNs : time between frames
+*			   _loop : 1 to repeat the buffer until another one is queued
+*	The return value:  0 ok, or the error of pthread_create (the buffer is then left to the caller)
+*********************************************************************************************************
+*/
+int ADS1256_DacStart(uint16_t *_codes, uint32_t _frames, uint8_t _channels, int64_t _periodNs, uint8_t _loop)
+{
+	ADS1256_DAC_T *d = &g_tDac;
+	int ret;
+
+	d->Cur = _codes;
+	d->CurLen = _frames;
+	d->Channels = _channels;
+	d->PeriodNs = _periodNs;
+	d->Loop = _loop;
+	d->Starved = 0;
+	d->Realtime = 0;
+	d->Frames = 0;
+	d->Late = 0;
+	d->Underruns = 0;
+	d->Buffers = 0;
+
+	d->Running = 1;
+	ret = pthread_create(&d->Thread, NULL, ADS1256_DacThread, s_pDev);
+	if (ret != 0)
+	{
+		d->Running = 0;
+		d->Cur = NULL;
+		return ret;
+	}
+	d->Active = 1;
+	return 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_DacQueue
+*	function: Queue the buffer that follows the one playing. Called with g_tDac.Lock held, which
+*			  a wait releases.
+*	parameter: _codes : frames in the layout of the playback, malloc'ed: owned by the thread once queued
+*			   _frames : frames in _codes
+*			   _wait : 1 to wait for the queue slot if a buffer is already queued
+*	The return value:  0 ok, ESRCH nothing playing, EAGAIN a buffer is already queued and _wait is 0
+*********************************************************************************************************
+*/
+int ADS1256_DacQueue(uint16_t *_codes, uint32_t _frames, int _wait)
+{
+	ADS1256_DAC_T *d = &g_tDac;
+
+	while (d->Running && (d->Next != NULL) && _wait)
+	{
+		pthread_cond_wait(&d->Cond, &d->Lock);
+	}
+	if (!d->Running)
+	{
+		return ESRCH;
+	}
+	if (d->Next != NULL)
+	{
+		return EAGAIN;
+	}
+
+	free(d->Spent);
+	d->Spent = NULL;
+	d->Next = _codes;
+	d->NextLen = _frames;
+	return 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_DacStop
+*	function: Stop the playback thread and free its buffers; the outputs keep the last frame.
+*			  Called without g_tDac.Lock and without the bus lock, the thread takes both.
+*	parameter: NULL
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_DacStop(void)
+{
+	ADS1256_DAC_T *d = &g_tDac;
+
+	pthread_mutex_lock(&d->Lock);
+	if (!d->Active || !d->Running)
+	{
+		pthread_mutex_unlock(&d->Lock);
+		return;		/* Not playing, or another caller is stopping it */
+	}
+	d->Running = 0;
+	pthread_cond_broadcast(&d->Cond);
+	pthread_mutex_unlock(&d->Lock);
+
+	pthread_join(d->Thread, NULL);
+
+	pthread_mutex_lock(&d->Lock);
+	free(d->Cur);
+	free(d->Next);
+	free(d->Spent);
+	d->Cur = NULL;
+	d->Next = NULL;
+	d->Spent = NULL;
+	d->Active = 0;
+	pthread_cond_broadcast(&d->Cond);
+	pthread_mutex_unlock(&d->Lock);
+}
+
+/*
+*********************************************************************************************************
+*	name: main
+*	function:  
+*	parameter: NULL
+*	The return value:  NULL
+*********************************************************************************************************
+*
+*   Desta parte para baixo, o codigo foi modificado por Fabio Franco de Oliveira. Email: fabioti6@gmail.com
+*   Foi necessaria a eliminacao do laco principal para leitura de todos os ADCs, sendo
+*   modificado para leitura de somente 1 ADC por vez mediante a passagem de parametros especificando qual 
+*   o canal, ganho e sample rate. Problemas envolvendo a sincronizacao do protocolo SPI precisaram ser 
+*   resolvidos para viabilizar a execução do "ads1256_test" fora do loop. 
+*   Ultima alteracao: 21/05/2016
+*
+*********************************************************************************************************
+*/
+
+// Posicao de um valor numa das tabelas de ajustes do driver, -1 se nao esta
+static int indice(const uint32_t *tabela, int n, long int valor){
+    int i;
+
+    for (i = 0; i < n; i++)
+        if ((long)tabela[i] == valor)
+            return i;
+    return -1;
+}
+
+
+static int codigoGanho(long int ganho){
+    if ((ganho < 1) || (ganho > 64))
+        return -1;
+    return s_tabGainPga[ganho] - 1;
+}
+
+
+// Erro guardado em g_tADS1256.Fault durante a operacao (chamar com a placa travada).
+// Depois de um timeout do DRDY o chip e ressincronizado; se ele nao responde mais o erro vira EIO
+static int falha(void){
+    int ret = g_tADS1256.Fault;
+
+    if (ret == ETIMEDOUT)
+    {
+        if (ADS1256_Resync() != 0)
+            ret = EIO;
+    }
+    g_tADS1256.Fault = 0;
+    return ret;
+}
+
+
+// Converte ate cada entrada de quais (bits da lista) receber um valor novo: ADS1256_CycleMux descarta
+// o resultado de um quadro atrasado. A lista inteira vai em passadas completas (mais uma conversao se
+// o pipeline esta vazio), algumas entradas param assim que chegam. Depois de 4 passadas o erro e
+// ETIME: a thread foi atrasada quadro apos quadro (chamar com a placa travada)
+static void varre(uint32_t quais){
+    uint32_t todas = (1u << g_tADS1256.ScanCount) - 1, feitas = 0, n, k;
+    int passada, ch;
+
+    for (passada = 0; (passada < 4) && ((feitas & quais) != quais) && (g_tADS1256.Fault == 0); passada++)
+    {
+        n = ADS1256_ScanLength() + ((g_tADS1256.Converting == ADS1256_CH_NONE) ? 1 : 0);
+        for (k = 0; (k < n) && (g_tADS1256.Fault == 0); k++)
+        {
+            if ((ADS1256_WaitDRDY() == 0) && ((ch = ADS1256_ISR()) >= 0))
+                feitas |= 1u << ch;
+            if ((quais != todas) && ((feitas & quais) == quais))
+                break;
+        }
+    }
+    if (((feitas & quais) != quais) && (g_tADS1256.Fault == 0))
+        g_tADS1256.Fault = ETIME;
+}
+
+
+// Saida do DAC8552 da placa. Os canais sao ADS1256_DAC_A, _B ou _AB; o barramento precisa estar aberto
+// (start), as escritas do DAC se intercalam com as conversoes do ADC. Retorna ENODEV sem start ou sem DAC
+static int dacAberto(void){
+    if (!g_tADS1256.Opened)
+        return ENODEV;
+    if (g_tDac.CsPin < 0)
+        return ENODEV;
+    return 0;
+}
+
+
+// 1 se a thread de aquisicao esta escrevendo no DAC pelo controle (chamar com a placa travada)
+static int dacControle(void){
+    return g_tAcq.Active && (g_tAcq.Control.Kind != ADS1256_CONTROL_NONE);
+}
+
+
+// Fecha o transporte da placa aberta (chamar com a placa travada). O bcm2835 e de todas as placas:
+// fecha com o barramento travado, e a proxima placa a usar o barramento acerta o clock dela
+static void fecha(void){
+    g_tADS1256.Opened = 0;      // antes do BUS_LOCK, que nao ajusta mais o clock desta placa
+    BUS_LOCK();
+    g_tADS1256.Transport->Close(g_tADS1256.CsPin, g_tADS1256.DrdyPin);
+    if (s_pBusOwner == s_pDev)
+        s_pBusOwner = NULL;
+    BUS_UNLOCK();
+}
+
+
+// ganho 1-64, sps e corrente do detector em decimos (2.5 SPS = 25, 0.5 uA = 5), clock de saida em Hz.
+// Retorna 0, EINVAL (ajuste invalido), ENODEV (o transporte nao abriu: bcm2835 sem root?),
+// EBUSY (aquisicao, grupo ou DAC rodando), EIO (o chip nao responde: ID errado) ou ETIMEDOUT
+// (o DRDY nao desce). Com erro o ADC fica parado. De novo com o ADC aberto so reconfigura o chip
+int  adcStart(ADS1256_DEV_T *dev, long int ganho, long int spsDec, long int sclk, int buffer, long int clkout, long int sdcsDec)
+{
+    uint8_t id;
+    uint32_t x;
+
+    int ads_gain;
+    int ads_sps;
+    int clk, sdcs;
+
+    s_pDev = dev;
+
+
+    // Todos os ajustes sao conferidos antes de mexer no chip
+    ads_gain = codigoGanho(ganho);
+    ads_sps = indice(s_tabSpsTenths, ADS1256_DRATE_MAX, spsDec);
+    clk = indice(s_tabClkOut, 4, clkout);
+    sdcs = indice(s_tabSdcsTenths, 4, sdcsDec);
+
+    // Clock SPI em Hz, 0 mantem o padrao antigo (divisor 1024). O ADS1256 aceita no maximo fCLKIN/4.
+    if (sclk == 0)
+        sclk = ADS1256_SCLK_DEFAULT_HZ;
+    if ((ads_gain < 0) || (ads_sps < 0) || (clk < 0) || (sdcs < 0) ||
+        (sclk < ADS1256_SCLK_MIN_HZ) || (sclk > ADS1256_SCLK_MAX_HZ))
+        return EINVAL;
+
+    DEV_LOCK();
+
+    // As threads usam o chip e o transporte: o start nao mexe neles por baixo delas
+    if (g_tAcq.Active || g_tDac.Active)
+    {
+        DEV_UNLOCK();
+        return EBUSY;
+    }
+
+    // SPI e pinos: bcm2835 na placa, ou o ADS1256 simulado. Abertos uma vez so, como o stop fecha uma vez.
+    // O transporte e de todas as placas: abre com o barramento travado
+    if (!g_tADS1256.Opened)
+    {
+        BUS_LOCK();
+        if (g_tADS1256.Transport->Init(g_tADS1256.CsPin, g_tADS1256.DrdyPin) == 0)
+        {
+            g_tADS1256.Opened = 1;
+
+            // O DAC8552 da placa fica no mesmo barramento, com o CS em 1 ate a primeira escrita
+            if (g_tDac.CsPin >= 0)
+                g_tADS1256.Transport->SetupCS(g_tDac.CsPin);
+        }
+        BUS_UNLOCK();
+        if (!g_tADS1256.Opened)
+        {
+            DEV_UNLOCK();
+            return ENODEV;
+        }
+    }
+
+    // Os atrasos do protocolo sao recalculados a partir do CLKIN junto com o clock
+    ADS1256_SetClock(sclk);
+    g_tADS1256.Fault = 0;
+    g_tADS1256.DrdyLate = 0;
+    
+    id = ADS1256_ReadChipID();
+   
+	if (id != 3)
+	{
+		// Placa desconectada ou sem alimentacao: o MISO le tudo em 1 (ou em 0)
+		g_tADS1256.Stats.DeviceErrors++;
+		g_tADS1256.Stats.LastError = EIO;
+		g_tADS1256.Fault = EIO;
+	}
+	else
+	{
+		g_tADS1256.Buffer = buffer ? 1 : 0;
+		g_tADS1256.Adcon = (clk << 5) | (sdcs << 3);
+		ADS1256_CfgADC(ads_gain, ads_sps);
+		ADS1256_StartScan(g_tADS1256.ScanMode);	// mantem a lista de varredura escolhida antes do start
+	}
+
+    if (g_tADS1256.Fault != 0)
+    {
+        int ret = g_tADS1256.Fault;
+
+        g_tADS1256.Fault = 0;
+        fecha();
+        DEV_UNLOCK();
+        return ret;
+    }
+
+    // Loop de inicialização: uma passada pela lista e mais uma conversao para o pipeline.
+    // Cada espera e limitada a ADS1256_WARMUP_US: nas taxas lentas a primeira leitura completa o resto
+    for (x = 0; x < ADS1256_ScanLength() + 1; x++)
+    {
+        if (!ADS1256_WaitDRDYTimeout(ADS1256_WARMUP_US))
+            break;
+        ADS1256_ISR();
+    }
+
+    DEV_UNLOCK();
+    return 0; // retorna zero para dizer iniciou ok
+}
+
+
+
+ // Funcao a qual o nome precisa bater com o wrapper
+ // Preenche um valor por entrada da lista de varredura (ADS1256_SCAN_MAX no maximo) e devolve quantos,
+ // ou -ENODEV (sem start), -ETIMEDOUT, -EIO (ver falha()), -ETIME (ver varre()).
+ // tempos (pode ser NULL) recebe o instante do DRDY de cada valor, CLOCK_MONOTONIC_RAW em ns
+long int readChannels(ADS1256_DEV_T *dev, long int *valorCanal, int64_t *tempos){
+    int i, ret;
+
+    s_pDev = dev;
+
+    DEV_LOCK();
+    if (!g_tADS1256.Opened)
+    {
+        DEV_UNLOCK();
+        return -ENODEV;
+    }
+
+    // Com a thread de aquisicao rodando ela e dona da placa: devolve os ultimos valores
+    if (g_tAcq.Active)
+    {
+        for (i = 0; i < g_tADS1256.ScanCount; i++)
+        {
+            valorCanal[i] = (long)ADS1256_GetAdc(i);
+            if (tempos)
+                tempos[i] = g_tADS1256.AdcTime[i];
+        }
+        DEV_UNLOCK();
+        return g_tADS1256.ScanCount;
+    }
+
+    // A leitura por varredura nao funciona com o chip em modo RDATAC
+    g_tADS1256.Fault = 0;
+    ADS1256_StopContinuous();
+
+    // Uma passada completa pela lista atualiza todas as entradas
+    varre((1u << g_tADS1256.ScanCount) - 1);
+    ret = falha();
+    if (ret != 0)
+    {
+        DEV_UNLOCK();
+        return -ret;
+    }
+
+	for (i = 0; i < g_tADS1256.ScanCount; i++)
+	{
+        valorCanal[i]=  (long)ADS1256_GetAdc(i); 
+        if (tempos)
+            tempos[i] = g_tADS1256.AdcTime[i];
+	}
+    DEV_UNLOCK();
+    return g_tADS1256.ScanCount;
+}
+
+
+// Valor novo da entrada ch em *valor: a varredura segue ate a conversao dela.
+// Retorna 0, EINVAL (ch fora da lista), ENODEV (sem start), ETIMEDOUT, EIO ou ETIME (ver varre())
+int readChannel(ADS1256_DEV_T *dev, long int ch, long int *valor){
+    uint32_t adc;
+    int ret;
+
+    s_pDev = dev;
+
+    DEV_LOCK();
+    if (!g_tADS1256.Opened)
+    {
+        DEV_UNLOCK();
+        return ENODEV;
+    }
+    if ((ch < 0) || (ch >= g_tADS1256.ScanCount))
+    {
+        DEV_UNLOCK();
+        return EINVAL;
+    }
+
+    if (g_tAcq.Active)
+    {
+        *valor = (long)ADS1256_GetAdc(ch);
+        DEV_UNLOCK();
+        return 0;
+    }
+
+    g_tADS1256.Fault = 0;
+    ADS1256_StopContinuous();
+
+    if (g_tADS1256.Fault == 0)
+        varre(1u << ch);
+    ret = falha();
+    if (ret != 0)
+    {
+        DEV_UNLOCK();
+        return ret;
+    }
+
+    adc = ADS1256_GetAdc(ch);
+    *valor = (long)(int32_t)adc;
+
+    DEV_UNLOCK();
+    return 0;
+}
+
+
+
+// Le n varreduras completas da lista direto para um buffer int32 (n x entradas), sem passar pelo Python.
+// cap e o tamanho do buffer em valores; devolve -EINVAL se nao couber. tempos (pode ser NULL, mesmo
+// tamanho) recebe o instante do DRDY de cada valor, CLOCK_MONOTONIC_RAW em ns.
+// Outros erros: -EBUSY (aquisicao rodando), -ENODEV (sem start), -ETIMEDOUT, -EIO, -ETIME
+long int readBlock(ADS1256_DEV_T *dev, int32_t *valores, int64_t *tempos, long int n, long int cap){
+    long int k;
+    int i, count, ret;
+
+    s_pDev = dev;
+
+    DEV_LOCK();
+    if (!g_tADS1256.Opened)
+    {
+        DEV_UNLOCK();
+        return -ENODEV;
+    }
+
+    // Com a thread de aquisicao rodando as varreduras ja estao no anel
+    if (g_tAcq.Active)
+    {
+        DEV_UNLOCK();
+        return -EBUSY;
+    }
+
+    // n * count pode estourar o long: compara por divisao
+    count = g_tADS1256.ScanCount;
+    if ((n < 0) || (count <= 0) || (n > cap / count))
+    {
+        DEV_UNLOCK();
+        return -EINVAL;
+    }
+
+    g_tADS1256.Fault = 0;
+    ADS1256_StopContinuous();
+
+    for (k = 0; (k < n) && (g_tADS1256.Fault == 0); k++)
+    {
+        varre((1u << count) - 1);
+        for (i = 0; i < count; i++)
+        {
+            valores[k * count + i] = ADS1256_GetAdc(i);
+            if (tempos)
+                tempos[k * count + i] = g_tADS1256.AdcTime[i];
+        }
+    }
+    ret = falha();
+
+    DEV_UNLOCK();
+    return (ret != 0) ? -ret : n;
+}
+
+
+
+// Leitura continua (RDATAC) de um unico canal: um resultado de 3 bytes por borda do DRDY.
+// Retorna 0, EINVAL (ch fora da lista), ENODEV (sem start), EBUSY (aquisicao), ETIMEDOUT ou EIO
+int adcStartContinuous(ADS1256_DEV_T *dev, long int ch){
+    int ret;
+
+    s_pDev = dev;
+
+    if (ch < 0)
+        return EINVAL;
+
+    DEV_LOCK();
+    if (!g_tADS1256.Opened)
+    {
+        DEV_UNLOCK();
+        return ENODEV;
+    }
+    if (g_tAcq.Active)
+    {
+        DEV_UNLOCK();
+        return EBUSY;
+    }
+    if (ch >= g_tADS1256.ScanCount)
+    {
+        DEV_UNLOCK();
+        return EINVAL;
+    }
+    g_tADS1256.Fault = 0;
+    ADS1256_StartContinuous(ch);
+    ret = falha();
+    DEV_UNLOCK();
+    return ret;
+}
+
+
+// Retorna 0, EINVAL (fora do modo continuo; tambem depois de um erro), ETIMEDOUT ou EIO
+long int readContinuous(ADS1256_DEV_T *dev, long int *valores, long int n){
+    long int i;
+    int ret;
+
+    s_pDev = dev;
+
+    DEV_LOCK();
+    if (!g_tADS1256.Continuous)
+    {
+        DEV_UNLOCK();
+        return EINVAL;
+    }
+
+    g_tADS1256.Fault = 0;
+    for (i = 0; (i < n) && (g_tADS1256.Fault == 0); i++)
+    {
+        valores[i] = (long)ADS1256_ReadContinuous();
+    }
+    ret = falha();     // a ressincronizacao sai do modo continuo
+    DEV_UNLOCK();
+    return ret;
+}
+
+
+int adcStopContinuous(ADS1256_DEV_T *dev){
+    int ret;
+
+    s_pDev = dev;
+
+    DEV_LOCK();
+    g_tADS1256.Fault = 0;
+    ADS1256_StopContinuous();
+    ret = falha();
+    DEV_UNLOCK();
+    return ret;
+}
+
+
+
+// Aquisicao em segundo plano: a thread varre os canais e guarda as amostras no anel
+int adcAcqStart(ADS1256_DEV_T *dev, long int capacidade){
+    int ret;
+
+    s_pDev = dev;
+
+    if ((capacidade <= 0) || (capacidade > (long)ADS1256_RING_MAX))
+        return EINVAL;
+
+    ACQ_LOCK();
+    DEV_LOCK();
+    // Com o controle ligado a thread escreve no DAC: ele precisa existir e nao estar tocando um buffer
+    ret = 0;
+    if ((g_tAcq.Control.Kind != ADS1256_CONTROL_NONE) && !g_tAcq.Active)
+    {
+        ret = dacAberto();
+        if ((ret == 0) && g_tDac.Active)
+            ret = EBUSY;
+    }
+    if (ret == 0)
+        ret = ADS1256_StartAcq(capacidade);
+    DEV_UNLOCK();
+    ACQ_UNLOCK();
+    return ret;
+}
+
+
+// Gravacao binaria em disco a partir da thread de aquisicao (ver ads1256_log.h).
+// rotacao por tamanho (MB) e/ou por tempo (s), 0 desliga; direto = O_DIRECT; buffer em KB
+int adcLogStart(ADS1256_DEV_T *dev, const char *caminho, long int rotMB, long int rotSeg, int direto, long int bufKB, long int capacidade){
+    int ret;
+
+    s_pDev = dev;
+
+    if ((rotMB < 0) || (rotSeg < 0) || (bufKB <= 0) || (capacidade <= 0) || (capacidade > (long)ADS1256_RING_MAX) ||
+        (strlen(caminho) >= sizeof(g_tLog.Path)))
+        return EINVAL;
+
+    ACQ_LOCK();
+    DEV_LOCK();
+    ret = ADS1256_StartLog(caminho, (uint64_t)rotMB << 20, (int64_t)rotSeg * 1000000000, direto, bufKB * 1024, capacidade);
+    DEV_UNLOCK();
+    ACQ_UNLOCK();
+    return ret;
+}
+
+
+int adcLogStop(ADS1256_DEV_T *dev){
+    s_pDev = dev;
+
+    ACQ_LOCK();
+    ADS1256_StopLog();
+    ACQ_UNLOCK();
+    return 0;
+}
+
+
+// bytes gravados, arquivos, amostras perdidas (anel do logger cheio), erros de escrita, ultimo errno
+int logStats(ADS1256_DEV_T *dev, long int *valores){
+    s_pDev = dev;
+
+    ACQ_LOCK();
+    valores[0] = (long)g_tLog.Written;
+    valores[1] = g_tLog.Files;
+    valores[2] = g_tLog.Dropped + (g_tLog.Running ? __atomic_load_n(&g_tLog.Ring.Dropped, __ATOMIC_RELAXED) : 0);
+    valores[3] = g_tLog.Errors;
+    valores[4] = g_tLog.LastErrno;
+    valores[5] = g_tLog.Running;
+    ACQ_UNLOCK();
+    return 0;
+}
+
+
+int adcAcqStop(ADS1256_DEV_T *dev){
+    s_pDev = dev;
+
+    ACQ_LOCK();
+    ADS1256_StopAcq();
+    ACQ_UNLOCK();
+    return 0;
+}
+
+
+long int acqAvailable(ADS1256_DEV_T *dev){
+    long int n = -1;
+
+    s_pDev = dev;
+
+    ACQ_LOCK();
+    if (g_tAcq.Active)
+        n = ADS1256_RingCount(&g_tAcq.Ring);
+    ACQ_UNLOCK();
+    return n;
+}
+
+
+long int acqRead(ADS1256_DEV_T *dev, ADS1256_SAMPLE_T *amostras, long int max, int consumir){
+    long int n = -1;
+
+    s_pDev = dev;
+
+    ACQ_LOCK();
+    if (g_tAcq.Active)
+        n = ADS1256_RingRead(&g_tAcq.Ring, amostras, max, consumir);
+    ACQ_UNLOCK();
+    return n;
+}
+
+
+long int acqDropped(ADS1256_DEV_T *dev){
+    long int n = 0;
+
+    s_pDev = dev;
+
+    ACQ_LOCK();
+    if (g_tAcq.Active)
+        n = __atomic_load_n(&g_tAcq.Ring.Dropped, __ATOMIC_RELAXED);
+    ACQ_UNLOCK();
+    return n;
+}
+
+
+// Grupo de placas convertendo juntas: uma thread manda SYNC/WAKEUP para todas e monta um quadro
+// por passada pelas listas de varredura (placa 0 inteira, depois a placa 1...). As placas precisam
+// de start, da mesma taxa e do mesmo numero de conversoes por passada.
+// Retorna 0, EINVAL, ENODEV (placa sem start), EBUSY (placa com aquisicao ou repetida) ou ENOMEM
+int adcGroupStart(ADS1256_GROUP_T **grupo, ADS1256_DEV_T **placas, long int n, long int capacidade){
+    ADS1256_GROUP_T *g = *grupo;
+    int ret;
+
+    if ((n < 1) || (n > ADS1256_GROUP_MAX) || (capacidade <= 0) || (capacidade > (long)ADS1256_RING_MAX))
+        return EINVAL;
+
+    // O grupo e reaproveitado de um start anterior (as placas nao mudam)
+    if (g == NULL)
+    {
+        g = calloc(1, sizeof(ADS1256_GROUP_T));
+        if (g == NULL)
+            return ENOMEM;
+        memcpy(g->Dev, placas, n * sizeof(ADS1256_DEV_T *));
+        g->Count = n;
+    }
+
+    ret = ADS1256_GroupStart(g, capacidade);
+    if ((ret != 0) && (*grupo == NULL))
+    {
+        free(g->Values);
+        free(g->Times);
+        free(g);
+        return ret;
+    }
+    *grupo = g;
+    return ret;
+}
+
+
+int adcGroupStop(ADS1256_GROUP_T *g){
+    ADS1256_GroupStop(g);
+    return 0;
+}
+
+
+void adcGroupFree(ADS1256_GROUP_T *g){
+    if (g == NULL)
+        return;
+    ADS1256_GroupStop(g);
+    free(g->Values);
+    free(g->Times);
+    free(g);
+}
+
+
+// Valores por quadro (placas x conversoes por passada), 0 antes do primeiro start
+long int groupWidth(ADS1256_GROUP_T *g){
+    return g->Width;
+}
+
+
+long int groupAvailable(ADS1256_GROUP_T *g){
+    long int n;
+
+    pthread_mutex_lock(&s_GroupLock);
+    n = __atomic_load_n(&g->Head, __ATOMIC_ACQUIRE) - g->Tail;
+    pthread_mutex_unlock(&s_GroupLock);
+    return n;
+}
+
+
+// Copia ate max quadros (max x groupWidth valores e tempos; tempos pode ser NULL).
+// consumir = 0 so espia. Continua lendo o que sobrou depois do stop
+long int groupRead(ADS1256_GROUP_T *g, int32_t *valores, int64_t *tempos, long int max, int consumir){
+    uint32_t head, tail, k, n;
+    size_t w;
+
+    pthread_mutex_lock(&s_GroupLock);
+    head = __atomic_load_n(&g->Head, __ATOMIC_ACQUIRE);
+    tail = g->Tail;
+    n = head - tail;
+    if ((long int)n > max)
+        n = (max > 0) ? max : 0;
+
+    w = g->Width;
+    for (k = 0; k < n; k++)
+    {
+        memcpy(valores + k * w, g->Values + ((tail + k) & (g->Size - 1)) * w, w * sizeof(int32_t));
+        if (tempos != NULL)
+            memcpy(tempos + k * w, g->Times + ((tail + k) & (g->Size - 1)) * w, w * sizeof(int64_t));
+    }
+    if (consumir)
+        __atomic_store_n(&g->Tail, tail + n, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&s_GroupLock);
+    return n;
+}
+
+
+// quadros, perdidos (buffer cheio), reinicios (DRDY parado numa placa) e maior defasagem entre
+// os DRDY das placas num mesmo passo, em ns
+void groupStats(ADS1256_GROUP_T *g, long int *valores){
+    valores[0] = g->Frames;
+    valores[1] = g->Dropped;
+    valores[2] = g->Restarts;
+    valores[3] = g->SkewNs;
+}
+
+
+
+// Modo de espera do DRDY: 0 = varredura do nivel do pino, 1 = evento de borda do gpiochip
+int adcSetDrdyWait(ADS1256_DEV_T *dev, int modo, long int timeout_us, const char *chip){
+    int ret;
+
+    s_pDev = dev;
+
+    if ((modo != ADS1256_DRDY_POLL) && (modo != ADS1256_DRDY_EVENT))
+        return EINVAL;
+    if (timeout_us <= 0)
+        return EINVAL;
+
+    DEV_LOCK();
+    ret = ADS1256_SetDrdyWait(modo, timeout_us, chip);
+    DEV_UNLOCK();
+    return ret;
+}
+
+
+
+// Transporte pelo nome ("bcm2835" ou "sim"), NULL se nao existe
+static const ADS1256_TRANSPORT_T *transporte(const char *nome){
+    if (strcmp(nome, g_tTransportSim.Name) == 0)
+        return &g_tTransportSim;
+#ifndef ADS1256_NO_BCM2835
+    if (strcmp(nome, g_tTransportBcm2835.Name) == 0)
+        return &g_tTransportBcm2835;
+#endif
+    return NULL;
+}
+
+
+// Novo dispositivo no transporte nome (NULL = o padrao) e nos pinos cs e drdy (-1 = os do transporte:
+// a placa AD/DA no bcm2835, o chip 0 no simulador). dac e o CS do DAC8552; -1 usa o do transporte
+// quando o cs tambem e o dele, senao a placa fica sem DAC. Nada e acessado antes do adcStart.
+// Retorna NULL com errno ENOENT (transporte desconhecido) ou ENOMEM
+ADS1256_DEV_T *adcNew(const char *nome, int cs, int drdy, int dac){
+    const ADS1256_TRANSPORT_T *t = &ADS1256_DEFAULT_TRANSPORT;
+    ADS1256_DEV_T *dev;
+
+    if ((nome != NULL) && ((t = transporte(nome)) == NULL))
+    {
+        errno = ENOENT;
+        return NULL;
+    }
+    dev = calloc(1, sizeof(ADS1256_DEV_T));
+    if (dev == NULL)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    // Os valores iniciais que eram do g_tADS1256 global
+    dev->Var.DrdyFd = -1;
+    dev->Var.DrdyTimeoutUs = ADS1256_DRDY_TIMEOUT_US;
+    dev->Var.Transport = t;
+    dev->Var.CsPin = (cs >= 0) ? cs : t->CsPin;
+    dev->Var.DrdyPin = (drdy >= 0) ? drdy : t->DrdyPin;
+    dev->Var.Converting = ADS1256_CH_NONE;
+    dev->Var.Vref = ADS1256_VREF_VOLTS;
+    dev->Var.CalPga = ADS1256_GAIN_DEFAULT;
+    dev->Log.Fd = -1;
+    dev->Dac.CsPin = (dac >= 0) ? dac : (((cs < 0) || (cs == t->CsPin)) ? t->DacCsPin : -1);
+    dev->Dac.Vref = ADS1256_DAC_VREF_VOLTS;
+    pthread_mutex_init(&dev->Dac.Lock, NULL);
+    pthread_cond_init(&dev->Dac.Cond, NULL);
+    pthread_mutex_init(&dev->AcqLock, NULL);
+    pthread_mutex_init(&dev->DevLock, NULL);
+    return dev;
+}
+
+
+// Para o dispositivo e libera tudo o que e dele
+void adcFree(ADS1256_DEV_T *dev){
+    int k;
+
+    adcStop(dev);
+    for (k = 0; k < ADS1256_SCAN_MAX; k++)
+        ADS1256_FilterFree(&dev->Acq.Filter[k]);
+    ADS1256_TriggerFree(&dev->Acq.Trigger);
+    ADS1256_ControlFree(&dev->Acq.Control);
+
+    DEV_LOCK();
+    ADS1256_SetDrdyWait(ADS1256_DRDY_POLL, g_tADS1256.DrdyTimeoutUs, NULL);     // fecha o fd de eventos
+    DEV_UNLOCK();
+
+    pthread_cond_destroy(&dev->Dac.Cond);
+    pthread_mutex_destroy(&dev->Dac.Lock);
+    pthread_mutex_destroy(&dev->AcqLock);
+    pthread_mutex_destroy(&dev->DevLock);
+    free(dev);
+}
+
+
+// Transporte e pinos do dispositivo
+const char *adcPins(ADS1256_DEV_T *dev, int *cs, int *drdy){
+    *cs = dev->Var.CsPin;
+    *drdy = dev->Var.DrdyPin;
+    return dev->Var.Transport->Name;
+}
+
+
+// Escolhe o transporte pelo nome ("bcm2835" ou "sim"), somente com o ADC parado.
+// Os pinos voltam aos do novo transporte
+int adcSetTransport(ADS1256_DEV_T *dev, const char *nome){
+    const ADS1256_TRANSPORT_T *t;
+    int ret = 0;
+
+    s_pDev = dev;
+
+    t = transporte(nome);
+    if (t == NULL)
+        return ENOENT;
+
+    DEV_LOCK();
+    if (g_tADS1256.Opened)
+        ret = EBUSY;
+    else
+    {
+        // O fd de eventos pertence ao DRDY do transporte anterior
+        ADS1256_SetDrdyWait(ADS1256_DRDY_POLL, g_tADS1256.DrdyTimeoutUs, NULL);
+        g_tADS1256.Transport = t;
+        g_tADS1256.CsPin = t->CsPin;
+        g_tADS1256.DrdyPin = t->DrdyPin;
+        g_tDac.CsPin = t->DacCsPin;
+    }
+    DEV_UNLOCK();
+    return ret;
+}
+
+
+
+// Lista de varredura: n entradas de 4 valores (AINP, AINN, ganho, repeticoes). AINCOM e a entrada 8,
+// ganho 0 usa o ganho do start(). n = 0 volta aos 8 canais contra AINCOM.
+// Retorna 0, EINVAL, EBUSY (aquisicao), ou ETIMEDOUT/EIO (a lista fica trocada mesmo assim)
+int adcSetScanList(ADS1256_DEV_T *dev, const long int *lista, long int n){
+    ADS1256_SCAN_ENTRY_T e[ADS1256_SCAN_MAX];
+    long int k;
+    int g, ret;
+
+    s_pDev = dev;
+
+    if ((n < 0) || (n > ADS1256_SCAN_MAX))
+        return EINVAL;
+
+    for (k = 0; k < n; k++)
+    {
+        const long int *p = &lista[k * 4];
+
+        if ((p[0] < 0) || (p[0] > ADS1256_AINCOM) || (p[1] < 0) || (p[1] > ADS1256_AINCOM) || (p[0] == p[1]))
+            return EINVAL;
+        if ((p[3] < 1) || (p[3] > 255))
+            return EINVAL;
+
+        e[k].Gain = ADS1256_GAIN_DEFAULT;
+        if (p[2] == -1)
+            e[k].Gain = ADS1256_GAIN_AUTO;
+        else if (p[2] != 0)
+        {
+            g = codigoGanho(p[2]);
+            if (g < 0)
+                return EINVAL;
+            e[k].Gain = g;
+        }
+        e[k].Mux = ADS1256_MuxPair(p[0], p[1]);
+        e[k].Repeat = p[3];
+    }
+
+    DEV_LOCK();
+    if (g_tAcq.Active)
+    {
+        DEV_UNLOCK();
+        return EBUSY;
+    }
+    g_tADS1256.Fault = 0;
+    ADS1256_StopContinuous();
+    ADS1256_SetScanList(e, n);
+    for (k = 0; k < ADS1256_SCAN_MAX; k++)
+        ADS1256_FilterFree(&g_tAcq.Filter[k]);     // os filtros eram das entradas antigas
+    ADS1256_TriggerFree(&g_tAcq.Trigger);          // e o gatilho tambem
+    ADS1256_ControlFree(&g_tAcq.Control);          // e o controle
+    ret = falha();
+    DEV_UNLOCK();
+    return ret;
+}
+
+
+// OFC0..FSC2 (LSB primeiro) para OFC com sinal e FSC
+static void coeficientes(const uint8_t *reg, long int *coef){
+    coef[0] = ((long)reg[2] << 16) | (reg[1] << 8) | reg[0];
+    if (coef[0] & 0x800000)
+        coef[0] -= 0x1000000;
+    coef[1] = ((long)reg[5] << 16) | (reg[4] << 8) | reg[3];
+}
+
+
+// Muda ganho, sps e/ou buffer sem reiniciar o chip: so os registradores alterados sao reescritos.
+// Mesmas unidades do adcStart; 0 (buffer -1) mantem o valor atual.
+// Retorna 0, EINVAL, ENODEV (sem start), EBUSY (aquisicao), ETIMEDOUT ou EIO
+int adcConfigure(ADS1256_DEV_T *dev, long int ganho, long int spsDec, int buffer){
+    int g, d, ret;
+
+    s_pDev = dev;
+
+    g = (ganho != 0) ? codigoGanho(ganho) : 0;
+    d = (spsDec != 0) ? indice(s_tabSpsTenths, ADS1256_DRATE_MAX, spsDec) : 0;
+    if ((g < 0) || (d < 0) || (buffer > 1))
+        return EINVAL;
+
+    DEV_LOCK();
+    if (!g_tADS1256.Opened)
+    {
+        DEV_UNLOCK();
+        return ENODEV;
+    }
+    if (g_tAcq.Active)
+    {
+        DEV_UNLOCK();
+        return EBUSY;
+    }
+    g_tADS1256.Fault = 0;
+    ADS1256_StopContinuous();
+    if (ganho == 0)
+        g = g_tADS1256.Gain;
+    if (spsDec == 0)
+        d = g_tADS1256.DataRate;
+    if (buffer < 0)
+        buffer = g_tADS1256.Buffer;
+    ret = ADS1256_Configure(g, d, buffer);
+    if (g_tADS1256.Fault != 0)
+        ret = falha();
+    DEV_UNLOCK();
+    return ret;
+}
+
+
+// Calibracao: tipo 0 = SELFCAL, 1 = SELFOCAL, 2 = SELFGCAL, 3 = SYSOCAL, 4 = SYSGCAL, nas entradas e
+// ganho da entrada da lista. coef recebe OFC (com sinal) e FSC. Retorna 0, EINVAL, ENODEV (sem start),
+// EBUSY (aquisicao rodando), ETIMEDOUT, EIO, ou o errno da gravacao do cache (coef preenchido mesmo assim)
+int adcCalibrate(ADS1256_DEV_T *dev, long int tipo, long int entrada, long int *coef){
+    static const uint8_t cmds[] = { CMD_SELFCAL, CMD_SELFOCAL, CMD_SELFGCAL, CMD_SYSOCAL, CMD_SYSGCAL };
+    uint8_t reg[6];
+    int ret = 0;
+
+    s_pDev = dev;
+
+    if ((tipo < 0) || (tipo > 4) || (entrada < 0))
+        return EINVAL;
+
+    DEV_LOCK();
+    if (!g_tADS1256.Opened)
+    {
+        DEV_UNLOCK();
+        return ENODEV;
+    }
+    if (g_tAcq.Active)
+    {
+        DEV_UNLOCK();
+        return EBUSY;
+    }
+    if (entrada >= g_tADS1256.ScanCount)
+    {
+        DEV_UNLOCK();
+        return EINVAL;
+    }
+    g_tADS1256.Fault = 0;
+    ADS1256_StopContinuous();
+    if (g_tADS1256.Fault == 0)
+        ret = ADS1256_Calibrate(cmds[tipo], entrada);
+    if (g_tADS1256.Fault != 0)
+        ret = falha();
+    ADS1256_ReadCal(reg);
+    DEV_UNLOCK();
+
+    coeficientes(reg, coef);
+    return ret;
+}
+
+
+// Le OFC (com sinal) e FSC do chip. Retorna 0, ENODEV, EBUSY, ETIMEDOUT ou EIO
+int adcReadCal(ADS1256_DEV_T *dev, long int *coef){
+    uint8_t reg[6];
+    int ret;
+
+    s_pDev = dev;
+
+    DEV_LOCK();
+    if (!g_tADS1256.Opened)
+    {
+        DEV_UNLOCK();
+        return ENODEV;
+    }
+    if (g_tAcq.Active || g_tADS1256.Continuous)
+    {
+        DEV_UNLOCK();
+        return EBUSY;
+    }
+    g_tADS1256.Fault = 0;
+    if (ADS1256_WaitDRDY() == 0)
+        ADS1256_ReadCal(reg);
+    ret = falha();
+    DEV_UNLOCK();
+    if (ret != 0)
+        return ret;
+
+    coeficientes(reg, coef);
+    return 0;
+}
+
+
+// Arquivo do cache de calibracao por (ganho, DRATE), lido agora e regravado a cada calibracao.
+// O start() seguinte usa os coeficientes do cache e desliga a auto-calibracao. NULL ou "" desliga o arquivo.
+// Retorna quantos ajustes foram carregados, ou -errno
+int adcSetCalCache(ADS1256_DEV_T *dev, const char *caminho){
+    int ret;
+
+    s_pDev = dev;
+
+    if ((caminho != NULL) && (strlen(caminho) >= sizeof(g_tCal.Path)))
+        return -ENAMETOOLONG;
+
+    DEV_LOCK();
+    ret = ADS1256_CalCacheLoad(caminho);
+    DEV_UNLOCK();
+    return ret;
+}
+
+
+// Tensao de referencia (VREFP - VREFN) usada na conversao para volts e gravada nos arquivos
+int adcSetVref(ADS1256_DEV_T *dev, double volts){
+    s_pDev = dev;
+
+    if ((volts < ADS1256_VREF_MIN) || (volts > ADS1256_VREF_MAX))
+        return EINVAL;
+
+    DEV_LOCK();
+    g_tADS1256.Vref = volts;
+    DEV_UNLOCK();
+    return 0;
+}
+
+
+// Volts por contagem: com ganho 0, uma escala por posicao de uma varredura (ganho de cada entrada);
+// senao uma so escala para o ganho dado. Retorna quantas escalas, -1 se o ganho for invalido
+long int voltScales(ADS1256_DEV_T *dev, double *escala, long int ganho){
+    long int n = 0;
+    uint8_t i, r, g;
+
+    s_pDev = dev;
+
+    if ((ganho != 0) && (codigoGanho(ganho) < 0))
+        return -1;
+
+    DEV_LOCK();
+    if (ganho != 0)
+    {
+        escala[n++] = 2.0 * g_tADS1256.Vref / (ganho * (double)ADS1256_FULL_SCALE);
+    }
+    else
+    {
+        for (i = 0; i < g_tADS1256.ScanCount; i++)
+        {
+            g = g_tADS1256.ScanList[i].Gain;
+            if (g == ADS1256_GAIN_DEFAULT)
+                g = g_tADS1256.Gain;
+            else if (g == ADS1256_GAIN_AUTO)
+                g = ADS1256_GAIN_64;    /* resultados normalizados para 64x */
+            for (r = 0; r < g_tADS1256.ScanList[i].Repeat; r++)
+                escala[n++] = 2.0 * g_tADS1256.Vref / ((1 << g) * (double)ADS1256_FULL_SCALE);
+        }
+    }
+    DEV_UNLOCK();
+    return n;
+}
+
+
+// Filtro da entrada para a aquisicao: tipo ADS1256_FILTER_*, n = janela, ordem, taps ou secoes,
+// decim = amostras por saida, coef = taps do FIR ou b0 b1 b2 a1 a2 por secao do IIR.
+// Retorna 0, EINVAL, ENOMEM ou EBUSY (aquisicao rodando)
+int adcSetFilter(ADS1256_DEV_T *dev, long int entrada, int tipo, long int n, long int decim, const double *coef){
+    int ret;
+
+    s_pDev = dev;
+
+    if ((n < 0) || (decim < 1) || (decim > ADS1256_FILTER_DECIM_MAX))
+        return EINVAL;
+
+    DEV_LOCK();
+    if ((entrada < 0) || (entrada >= g_tADS1256.ScanCount))
+    {
+        DEV_UNLOCK();
+        return EINVAL;
+    }
+    if (g_tAcq.Active)
+    {
+        DEV_UNLOCK();
+        return EBUSY;
+    }
+    ret = ADS1256_FilterInit(&g_tAcq.Filter[entrada], tipo, n, decim, coef);
+    DEV_UNLOCK();
+    return ret;
+}
+
+
+// Gatilho da aquisicao numa entrada da lista: tipo ADS1256_TRIGGER_* (NONE desliga), sentido
+// ADS1256_TRIGGER_UP/DOWN/BOTH, niveis em contagens (depois do filtro), pre e pos em amostras do
+// fluxo. So as janelas vao para o anel e para o disco. unico = uma janela e espera adcTriggerArm.
+// Retorna 0, EINVAL, ENOMEM ou EBUSY (aquisicao rodando)
+int adcSetTrigger(ADS1256_DEV_T *dev, long int entrada, int tipo, int sentido, long int nivel, long int nivel2, long int pre, long int pos, int unico){
+    int ret;
+
+    s_pDev = dev;
+
+    if ((pre < 0) || (pos < 0) || (pos > UINT32_MAX) || (nivel < INT32_MIN) || (nivel > INT32_MAX) ||
+        (nivel2 < INT32_MIN) || (nivel2 > INT32_MAX))
+        return EINVAL;
+
+    DEV_LOCK();
+    if ((tipo != ADS1256_TRIGGER_NONE) && ((entrada < 0) || (entrada >= g_tADS1256.ScanCount)))
+    {
+        DEV_UNLOCK();
+        return EINVAL;
+    }
+    if (g_tAcq.Active)
+    {
+        DEV_UNLOCK();
+        return EBUSY;
+    }
+    ret = ADS1256_TriggerInit(&g_tAcq.Trigger, tipo, entrada, sentido, nivel, nivel2,
+                              (pre > ADS1256_TRIGGER_PRE_MAX) ? ADS1256_TRIGGER_PRE_MAX + 1 : pre, pos, unico);
+    DEV_UNLOCK();
+    return ret;
+}
+
+
+// Arma de novo um gatilho de janela unica, tambem com a aquisicao rodando
+int adcTriggerArm(ADS1256_DEV_T *dev){
+    s_pDev = dev;
+
+    if (g_tAcq.Trigger.Kind == ADS1256_TRIGGER_NONE)
+        return EINVAL;
+    ADS1256_TriggerArm(&g_tAcq.Trigger);
+    return 0;
+}
+
+
+// Janelas completas esperando leitura (a primeira vai em w), -1 sem aquisicao
+long int trigPending(ADS1256_DEV_T *dev, ADS1256_WINDOW_T *w){
+    long int n = -1;
+    uint32_t tail;
+
+    s_pDev = dev;
+
+    ACQ_LOCK();
+    if (g_tAcq.Active)
+    {
+        tail = g_tAcq.WinTail;
+        n = __atomic_load_n(&g_tAcq.WinHead, __ATOMIC_ACQUIRE) - tail;
+        if (n > 0)
+            *w = g_tAcq.Win[tail & (ADS1256_WINDOW_MAX - 1)];
+    }
+    ACQ_UNLOCK();
+    return n;
+}
+
+
+// Retira a primeira janela: descricao em w e as amostras (ate cap) do anel da aquisicao.
+// Retorna o numero de amostras, 0 sem janela, -ENOSPC (cap pequeno, nada retirado) ou -ESRCH
+long int trigRead(ADS1256_DEV_T *dev, ADS1256_WINDOW_T *w, ADS1256_SAMPLE_T *amostras, long int cap){
+    long int n = 0;
+    uint32_t tail;
+
+    s_pDev = dev;
+
+    ACQ_LOCK();
+    if (!g_tAcq.Active)
+        n = -ESRCH;
+    else
+    {
+        tail = g_tAcq.WinTail;
+        if (__atomic_load_n(&g_tAcq.WinHead, __ATOMIC_ACQUIRE) != tail)
+        {
+            *w = g_tAcq.Win[tail & (ADS1256_WINDOW_MAX - 1)];
+            if (w->Count > cap)
+                n = -ENOSPC;
+            else
+            {
+                // as amostras da janela entram no anel antes dela na fila
+                n = ADS1256_RingRead(&g_tAcq.Ring, amostras, w->Count, 1);
+                __atomic_store_n(&g_tAcq.WinTail, tail + 1, __ATOMIC_RELEASE);
+            }
+        }
+    }
+    ACQ_UNLOCK();
+    return n;
+}
+
+
+// janelas disparadas, condicoes perdidas (fila de janelas cheia), janelas esperando leitura e
+// 1 se o gatilho esta armado (ou no meio de uma janela)
+void trigStats(ADS1256_DEV_T *dev, long int *valores){
+    s_pDev = dev;
+
+    ACQ_LOCK();
+    valores[0] = g_tAcq.Trigger.Fired;
+    valores[1] = g_tAcq.Trigger.Missed;
+    valores[2] = g_tAcq.Active ? __atomic_load_n(&g_tAcq.WinHead, __ATOMIC_ACQUIRE) - g_tAcq.WinTail : 0;
+    valores[3] = (g_tAcq.Trigger.Kind != ADS1256_TRIGGER_NONE) && (g_tAcq.Trigger.State != ADS1256_TRIGGER_IDLE);
+    ACQ_UNLOCK();
+}
+
+
+
+// Pino do CS do DAC8552, -1 se a placa nao tem DAC
+int adcDacPin(ADS1256_DEV_T *dev){
+    return dev->Dac.CsPin;
+}
+
+
+// Escreve um codigo (0-65535) no canal A ou B, que muda na hora. EBUSY durante uma reproducao
+int dacWrite(ADS1256_DEV_T *dev, long int canal, long int codigo){
+    uint16_t c = (uint16_t)codigo;
+    int ret;
+
+    s_pDev = dev;
+
+    if (((canal != ADS1256_DAC_A) && (canal != ADS1256_DAC_B)) || (codigo < 0) || (codigo > 65535))
+        return EINVAL;
+
+    pthread_mutex_lock(&g_tDac.Lock);
+    DEV_LOCK();
+    ret = dacAberto();
+    if ((ret == 0) && (g_tDac.Active || dacControle()))
+        ret = EBUSY;
+    if (ret == 0)
+        ADS1256_DacOut(canal, &c);
+    DEV_UNLOCK();
+    pthread_mutex_unlock(&g_tDac.Lock);
+    return ret;
+}
+
+
+// Referencia do DAC em volts (5 V na placa), para dacVolts
+int dacSetVref(ADS1256_DEV_T *dev, double volts){
+    if ((volts <= 0) || (volts > 5.5))
+        return EINVAL;
+
+    pthread_mutex_lock(&dev->Dac.Lock);
+    dev->Dac.Vref = volts;
+    pthread_mutex_unlock(&dev->Dac.Lock);
+    return 0;
+}
+
+
+// Codigo do DAC para uma tensao de 0 a Vref (Voltage_Convert), EDOM fora da faixa
+int dacVolts(ADS1256_DEV_T *dev, double volts, long int *codigo){
+    float vref;
+
+    pthread_mutex_lock(&dev->Dac.Lock);
+    vref = dev->Dac.Vref;
+    pthread_mutex_unlock(&dev->Dac.Lock);
+
+    if ((volts < 0) || (volts > vref))
+        return EDOM;
+    *codigo = Voltage_Convert(vref, volts);
+    return 0;
+}
+
+
+// Copia n codigos em quadros de 1 (A ou B) ou 2 (AB: A e depois B) para um buffer da thread
+static uint16_t *dacCopia(const uint16_t *codigos, long int n, int canais, uint32_t *quadros){
+    uint32_t largura = (canais == ADS1256_DAC_AB) ? 2 : 1;
+    uint16_t *buf;
+
+    if ((n < (long)largura) || (n % largura != 0) || (n > 0x7FFFFFFF)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    buf = malloc(n * sizeof(uint16_t));
+    if (buf == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    memcpy(buf, codigos, n * sizeof(uint16_t));
+    *quadros = n / largura;
+    return buf;
+}
+
+
+// Reproduz n codigos a taxa quadros/s (ate ADS1256_DAC_RATE_MAX) numa thread propria; repetir = volta
+// ao inicio ate um dacQueue. Retorna EINVAL, ENOMEM, ENODEV (sem start ou sem DAC) ou EBUSY (ja tocando)
+int dacPlay(ADS1256_DEV_T *dev, const uint16_t *codigos, long int n, int canais, double taxa, int repetir){
+    uint16_t *buf;
+    uint32_t quadros;
+    int ret;
+
+    s_pDev = dev;
+
+    if ((canais < ADS1256_DAC_A) || (canais > ADS1256_DAC_AB) || !(taxa > 0) || (taxa > ADS1256_DAC_RATE_MAX))
+        return EINVAL;
+    buf = dacCopia(codigos, n, canais, &quadros);
+    if (buf == NULL)
+        return errno;
+
+    // A placa fica travada ate a thread existir: o adcAcqStart confere o DAC com ela
+    pthread_mutex_lock(&g_tDac.Lock);
+    DEV_LOCK();
+    ret = dacAberto();
+    if ((ret == 0) && (g_tDac.Active || dacControle()))
+        ret = EBUSY;
+    if (ret == 0)
+        ret = ADS1256_DacStart(buf, quadros, canais, llround(1e9 / taxa), repetir ? 1 : 0);
+    DEV_UNLOCK();
+    pthread_mutex_unlock(&g_tDac.Lock);
+
+    if (ret != 0)
+        free(buf);
+    return ret;
+}
+
+
+// Poe na fila o buffer que segue o atual (no formato do dacPlay). esperar = 1 bloqueia ate a vez dele;
+// retorna ESRCH (nada tocando), EAGAIN (fila ocupada sem esperar), EINVAL ou ENOMEM
+int dacQueue(ADS1256_DEV_T *dev, const uint16_t *codigos, long int n, int esperar){
+    uint16_t *buf;
+    uint32_t quadros;
+    int ret;
+
+    s_pDev = dev;
+
+    pthread_mutex_lock(&g_tDac.Lock);
+    ret = g_tDac.Running ? 0 : ESRCH;
+    if (ret == 0) {
+        buf = dacCopia(codigos, n, g_tDac.Channels, &quadros);
+        if (buf == NULL)
+            ret = errno;
+    }
+    if (ret == 0) {
+        ret = ADS1256_DacQueue(buf, quadros, esperar);
+        if (ret != 0)
+            free(buf);
+    }
+    pthread_mutex_unlock(&g_tDac.Lock);
+    return ret;
+}
+
+
+// Para a reproducao; as saidas ficam no ultimo quadro
+int dacStop(ADS1256_DEV_T *dev){
+    s_pDev = dev;
+
+    ADS1256_DacStop();
+    return 0;
+}
+
+
+// quadros escritos, atrasados (pulados), faltas de buffer, buffers da fila tocados, 1 se ha buffer na fila,
+// 1 se parado sem buffer, 1 se a thread ganhou SCHED_FIFO, 1 se tocando, e os ultimos codigos de A e B
+void dacStats(ADS1256_DEV_T *dev, long int *valores){
+    s_pDev = dev;
+
+    pthread_mutex_lock(&g_tDac.Lock);
+    valores[0] = g_tDac.Frames;
+    valores[1] = g_tDac.Late;
+    valores[2] = g_tDac.Underruns;
+    valores[3] = g_tDac.Buffers;
+    valores[4] = (g_tDac.Next != NULL);
+    valores[5] = g_tDac.Starved;
+    valores[6] = g_tDac.Realtime;
+    valores[7] = g_tDac.Running;
+    pthread_mutex_lock(&s_BusLock);
+    valores[8] = g_tDac.Code[0];
+    valores[9] = g_tDac.Code[1];
+    pthread_mutex_unlock(&s_BusLock);
+    pthread_mutex_unlock(&g_tDac.Lock);
+}
+
+
+
+// Controle em malha fechada na thread de aquisicao: a cada valor da entrada, tipo PID ou filtro de
+// coeficientes sobre o erro (setpoint - valor, em contagens), saida no canal ADS1256_DAC_A ou _B.
+// So com a aquisicao parada; tipo ADS1256_CONTROL_NONE desliga. Retorna EINVAL, EBUSY ou ENODEV (sem DAC)
+int adcSetControl(ADS1256_DEV_T *dev, long int entrada, int tipo, int canal, long int setpoint, const ADS1256_CONTROL_PARAM_T *p){
+    int ret;
+
+    s_pDev = dev;
+
+    if ((setpoint < INT32_MIN) || (setpoint > INT32_MAX))
+        return EINVAL;
+    if ((tipo == ADS1256_CONTROL_FILTER) && (p->NB == 0))
+        return EINVAL;
+
+    DEV_LOCK();
+    if ((tipo != ADS1256_CONTROL_NONE) && ((entrada < 0) || (entrada >= g_tADS1256.ScanCount)))
+        ret = EINVAL;
+    else if (g_tAcq.Active)
+        ret = EBUSY;
+    else if ((tipo != ADS1256_CONTROL_NONE) && (g_tDac.CsPin < 0))
+        ret = ENODEV;
+    else
+        ret = ADS1256_ControlInit(&g_tAcq.Control, tipo, entrada, canal, setpoint, p);
+    DEV_UNLOCK();
+    return ret;
+}
+
+
+// Novo setpoint em contagens, tambem com a aquisicao rodando. ESRCH sem controle
+int controlSetpoint(ADS1256_DEV_T *dev, long int setpoint){
+    int ret = 0;
+
+    s_pDev = dev;
+
+    if ((setpoint < INT32_MIN) || (setpoint > INT32_MAX))
+        return EINVAL;
+
+    DEV_LOCK();
+    if (g_tAcq.Control.Kind == ADS1256_CONTROL_NONE)
+        ret = ESRCH;
+    else
+        ADS1256_ControlSetpoint(&g_tAcq.Control, setpoint);
+    DEV_UNLOCK();
+    return ret;
+}
+
+
+// Novos ganhos, coeficientes e limites da saida, tambem com a aquisicao rodando: o estado continua
+int controlTune(ADS1256_DEV_T *dev, const ADS1256_CONTROL_PARAM_T *p){
+    int ret = 0;
+
+    s_pDev = dev;
+
+    if (ADS1256_ControlCheck(p) != 0)
+        return EINVAL;
+
+    DEV_LOCK();
+    if (g_tAcq.Control.Kind == ADS1256_CONTROL_NONE)
+        ret = ESRCH;
+    else if ((g_tAcq.Control.Kind == ADS1256_CONTROL_FILTER) && (p->NB == 0))
+        ret = EINVAL;
+    else
+        ADS1256_ControlTune(&g_tAcq.Control, p);
+    DEV_UNLOCK();
+    return ret;
+}
+
+
+// Parametros atuais (os pendentes, se ainda nao foram usados) e em info a entrada, o canal e o
+// setpoint. Devolve o tipo, ADS1256_CONTROL_NONE sem controle
+int controlParam(ADS1256_DEV_T *dev, ADS1256_CONTROL_PARAM_T *p, long int *info){
+    ADS1256_CONTROL_T *c;
+    int tipo;
+
+    s_pDev = dev;
+    c = &g_tAcq.Control;
+
+    DEV_LOCK();
+    tipo = c->Kind;
+    if (tipo != ADS1256_CONTROL_NONE)
+    {
+        pthread_mutex_lock(&c->Lock);
+        *p = c->Update ? c->Pending : c->Param;
+        pthread_mutex_unlock(&c->Lock);
+        info[0] = c->Entry;
+        info[1] = c->Channel;
+        info[2] = __atomic_load_n(&c->Setpoint, __ATOMIC_RELAXED);
+    }
+    DEV_UNLOCK();
+    return tipo;
+}
+
+
+// passos, saidas saturadas, ultima medida, erro e codigo, latencia DRDY -> DAC da ultima e a maior (ns),
+// o setpoint e 1 se o controle esta rodando
+void controlStats(ADS1256_DEV_T *dev, long int *valores){
+    ADS1256_CONTROL_T *c;
+
+    s_pDev = dev;
+    c = &g_tAcq.Control;
+
+    DEV_LOCK();
+    valores[0] = c->Iterations;
+    valores[1] = c->Saturated;
+    valores[2] = c->Measured;
+    valores[3] = c->Error;
+    valores[4] = c->Output;
+    valores[5] = c->LatencyNs;
+    valores[6] = c->LatencyMaxNs;
+    valores[7] = c->Setpoint;
+    valores[8] = dacControle();
+    DEV_UNLOCK();
+}
+
+
+// Ganho (1-64) em que foi convertido o ultimo valor de cada entrada da lista; devolve o numero de entradas
+long int adcGains(ADS1256_DEV_T *dev, long int *ganhos){
+    long int n, i;
+
+    s_pDev = dev;
+
+    DEV_LOCK();
+    n = g_tADS1256.ScanCount;
+    for (i = 0; i < n; i++)
+        ganhos[i] = 1 << g_tADS1256.AdcPga[i];
+    DEV_UNLOCK();
+    return n;
+}
+
+
+long int scanCount(ADS1256_DEV_T *dev){
+    long int n;
+
+    s_pDev = dev;
+
+    DEV_LOCK();
+    n = g_tADS1256.ScanCount;
+    DEV_UNLOCK();
+    return n;
+}
+
+
+
+// Relogio dos tempos das amostras (CLOCK_MONOTONIC_RAW), em ns
+int64_t adcClock(void){
+    return ADS1256_NowRaw();
+}
+
+
+
+// Contadores de erro: timeouts do DRDY, ressincronizacoes, falhas do ID do chip e o ultimo errno.
+// zerar != 0 zera tudo depois da leitura
+int adcGetStats(ADS1256_DEV_T *dev, long int *valores, int zerar){
+    s_pDev = dev;
+
+    DEV_LOCK();
+    valores[0] = g_tADS1256.Stats.Timeouts;
+    valores[1] = g_tADS1256.Stats.Resyncs;
+    valores[2] = g_tADS1256.Stats.DeviceErrors;
+    valores[3] = g_tADS1256.Stats.LastError;
+    valores[4] = g_tADS1256.Stats.Late;
+    if (zerar)
+        memset(&g_tADS1256.Stats, 0, sizeof(g_tADS1256.Stats));
+    DEV_UNLOCK();
+    return 0;
+}
+
+
+
+// Clock SPI em uso e os atrasos derivados, em Hz e us
+int adcGetTiming(ADS1256_DEV_T *dev, long int *valores){
+    s_pDev = dev;
+
+    DEV_LOCK();
+    valores[0] = g_tADS1256.Timing.SclkHz;
+    valores[1] = g_tADS1256.Timing.T6Us;
+    valores[2] = g_tADS1256.Timing.T11Us;
+    valores[3] = g_tADS1256.Timing.T11SyncUs;
+    DEV_UNLOCK();
+    return 0;
+}
+
+
+
+int adcStop(ADS1256_DEV_T *dev){
+    s_pDev = dev;
+
+    ACQ_LOCK();
+    ADS1256_StopAcq();
+    ACQ_UNLOCK();
+    ADS1256_DacStop();
+
+    DEV_LOCK();
+    ADS1256_StopContinuous();
+    if (g_tADS1256.Opened)
+        fecha();
+    DEV_UNLOCK();
+    return 0;
+}
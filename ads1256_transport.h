@@ -0,0 +1,39 @@
+/*
+ * ads1256_transport.h:
+ *	Everything the ADS1256 driver needs from the board: SPI byte transfer and clock, chip select,
+ *	the DRDY level and delays. The DAC8552 of the board sits on the same bus with its own CS.
+ *	ads1256_bcm2835.c drives the real AD/DA board,
+ *	ads1256_sim.c emulates the chip so the driver runs on any Linux machine.
+ *	Several ADS1256 may share one transport, each on its own CS and DRDY pins.
+ *
+ */
+
+#ifndef ADS1256_TRANSPORT_H
+#define ADS1256_TRANSPORT_H
+
+#include <stdint.h>
+
+typedef struct
+{
+	const char *Name;
+	int CsPin;						/* CS and DRDY pins of the first board, used when none are given */
+	int DrdyPin;
+	uint8_t DrdyEvents;				/* 1 if DRDY pins are gpiochip line offsets that can raise events */
+	int DacCsPin;					/* CS pin of the DAC8552 of the first board */
+	int (*Init)(int _cs, int _drdy);	/* Open the bus and set up the pins of one board: 0 ok, 1 error */
+	void (*Close)(int _cs, int _drdy);	/* The bus is closed with the last board */
+	uint32_t (*SetClock)(uint32_t _hz);	/* Set SCLK to at most _hz, return the frequency actually set */
+	uint8_t (*Transfer)(uint8_t _data);	/* Clock one byte out and return the byte clocked in */
+	void (*Transfern)(uint8_t *_buf, uint32_t _len);	/* Same for _len bytes in one burst, in place */
+	void (*SetCS)(int _pin, uint8_t _level);	/* 0 selects the ADS1256 (or the DAC8552) on _pin */
+	void (*SetupCS)(int _pin);			/* Make _pin a CS output, high: the DAC8552 of an opened board */
+	uint8_t (*DrdyLevel)(int _pin);		/* 0 while a conversion result is ready */
+	void (*DelayUS)(uint64_t _micros);
+}ADS1256_TRANSPORT_T;
+
+#ifndef ADS1256_NO_BCM2835
+extern const ADS1256_TRANSPORT_T g_tTransportBcm2835;
+#endif
+extern const ADS1256_TRANSPORT_T g_tTransportSim;
+
+#endif
@@ -0,0 +1,302 @@
+/*
+ * ads1256_trigger.c:
+ *	Trigger of the acquisition stream. The acquisition thread feeds every sample, after its
+ *	filter, to ADS1256_TriggerRun and passes on only what it is told to: the history when the
+ *	trigger fires, then the samples of the window. The history is a ring of Pre samples, so
+ *	waiting for a trigger costs one copy per sample whatever the length of the window.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "ads1256_trigger.h"
+
+/*
+*********************************************************************************************************
+*	name: Trigger_Test
+*	function: Test the condition on a new value of the entry, against the previous one for the
+*			  kinds that need it (none before the first value)
+*	parameter: _t : trigger
+*			   _v : value of the entry
+*	The return value: 1 if the trigger fires
+*********************************************************************************************************
+*/
+static int Trigger_Test(const ADS1256_TRIGGER_T *_t, int32_t _v)
+{
+	int32_t p = _t->Prev;
+	int64_t d;
+	int up, down;
+	int in, wasIn;
+
+	if ((_t->Kind != ADS1256_TRIGGER_LEVEL) && !_t->HavePrev)
+	{
+		return 0;
+	}
+
+	switch (_t->Kind)
+	{
+	case ADS1256_TRIGGER_LEVEL:
+		up = (_v >= _t->Level);
+		down = (_v <= _t->Level);
+		break;
+
+	case ADS1256_TRIGGER_EDGE:
+		up = (p < _t->Level) && (_v >= _t->Level);
+		down = (p > _t->Level) && (_v <= _t->Level);
+		break;
+
+	case ADS1256_TRIGGER_WINDOW:
+		in = (_v >= _t->Level) && (_v <= _t->Level2);
+		wasIn = (p >= _t->Level) && (p <= _t->Level2);
+		up = wasIn && !in;		/* Leaves the window */
+		down = !wasIn && in;	/* Enters it */
+		break;
+
+	case ADS1256_TRIGGER_SLOPE:
+		d = (int64_t)_v - p;
+		up = (d >= _t->Level);
+		down = (d <= -(int64_t)_t->Level);
+		break;
+
+	default:
+		return 0;
+	}
+
+	return ((_t->Dir & ADS1256_TRIGGER_UP) && up) || ((_t->Dir & ADS1256_TRIGGER_DOWN) && down);
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_TriggerInit
+*	function: Set up a trigger. _t must be zeroed or previously initialised; the old setup is freed.
+*	parameter: _t : trigger
+*			   _kind : ADS1256_TRIGGER_*, NONE turns it off
+*			   _entry : scan list entry tested
+*			   _dir : ADS1256_TRIGGER_UP, DOWN or BOTH (not BOTH for a level)
+*			   _level : threshold, window edge or slope in counts (slope > 0)
+*			   _level2 : other window edge, unused by the other kinds
+*			   _pre : samples of the stream kept before the trigger, up to ADS1256_TRIGGER_PRE_MAX
+*			   _post : samples of the stream passed after the trigger
+*			   _single : 1 for one window, then idle until ADS1256_TriggerArm
+*	The return value: 0 ok, EINVAL, ENOMEM
+*********************************************************************************************************
+*/
+int ADS1256_TriggerInit(ADS1256_TRIGGER_T *_t, uint8_t _kind, uint8_t _entry, uint8_t _dir, int32_t _level,
+						int32_t _level2, uint32_t _pre, uint32_t _post, uint8_t _single)
+{
+	ADS1256_TriggerFree(_t);
+
+	if (_kind == ADS1256_TRIGGER_NONE)
+	{
+		return 0;
+	}
+	if ((_kind > ADS1256_TRIGGER_SLOPE) || (_dir < ADS1256_TRIGGER_UP) || (_dir > ADS1256_TRIGGER_BOTH) ||
+		(_pre > ADS1256_TRIGGER_PRE_MAX))
+	{
+		return EINVAL;
+	}
+	if ((_kind == ADS1256_TRIGGER_LEVEL) && (_dir == ADS1256_TRIGGER_BOTH))
+	{
+		return EINVAL;		/* Always true */
+	}
+	if ((_kind == ADS1256_TRIGGER_SLOPE) && (_level <= 0))
+	{
+		return EINVAL;
+	}
+
+	if (_pre > 0)
+	{
+		_t->Hist = malloc(_pre * sizeof(ADS1256_SAMPLE_T));
+		if (_t->Hist == NULL)
+		{
+			return ENOMEM;
+		}
+	}
+
+	_t->Kind = _kind;
+	_t->Entry = _entry;
+	_t->Dir = _dir;
+	_t->Level = (_kind == ADS1256_TRIGGER_WINDOW) && (_level2 < _level) ? _level2 : _level;
+	_t->Level2 = (_kind == ADS1256_TRIGGER_WINDOW) && (_level2 < _level) ? _level : _level2;
+	_t->Pre = _pre;
+	_t->Post = _post;
+	_t->Single = _single ? 1 : 0;
+	ADS1256_TriggerReset(_t);
+	return 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_TriggerReset
+*	function: Empty the history, clear the counters and arm. Called when an acquisition starts.
+*	parameter: _t : trigger
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_TriggerReset(ADS1256_TRIGGER_T *_t)
+{
+	_t->HistPos = 0;
+	_t->HistFill = 0;
+	_t->Clear = 0;
+	_t->State = ADS1256_TRIGGER_ARMED;
+	_t->Left = 0;
+	_t->HavePrev = 0;
+	_t->ArmRequest = 0;
+	_t->TimeNs = 0;
+	_t->Fired = 0;
+	_t->Missed = 0;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_TriggerFree
+*	function: Release the history and turn the trigger off
+*	parameter: _t : trigger
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_TriggerFree(ADS1256_TRIGGER_T *_t)
+{
+	free(_t->Hist);
+	memset(_t, 0, sizeof(*_t));
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_TriggerArm
+*	function: Arm a single shot trigger again. May be called from any thread while the
+*			  acquisition runs: the request is taken by the next ADS1256_TriggerRun.
+*	parameter: _t : trigger
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_TriggerArm(ADS1256_TRIGGER_T *_t)
+{
+	__atomic_store_n(&_t->ArmRequest, 1, __ATOMIC_RELEASE);
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_TriggerRun
+*	function: Feed one sample of the stream. While armed it goes into the history; when it fires
+*			  the trigger, the history is due first, then the sample itself and the next Post ones.
+*	parameter: _t : trigger, not ADS1256_TRIGGER_NONE
+*			   _s : sample
+*			   _allow : 0 if the caller cannot take a window now; a condition met is then only counted
+*	The return value: ADS1256_TRIGGER_PASS / FIRE / DONE flags, 0 if the sample is not passed on
+*********************************************************************************************************
+*/
+int ADS1256_TriggerRun(ADS1256_TRIGGER_T *_t, const ADS1256_SAMPLE_T *_s, int _allow)
+{
+	int hit = 0;
+
+	if (_t->Clear)
+	{
+		_t->Clear = 0;
+		_t->HistPos = 0;
+		_t->HistFill = 0;
+	}
+	if (__atomic_exchange_n(&_t->ArmRequest, 0, __ATOMIC_ACQUIRE) && (_t->State == ADS1256_TRIGGER_IDLE))
+	{
+		_t->State = ADS1256_TRIGGER_ARMED;
+	}
+
+	if (_s->Channel == _t->Entry)
+	{
+		hit = Trigger_Test(_t, _s->Value);
+		_t->Prev = _s->Value;
+		_t->HavePrev = 1;
+	}
+
+	switch (_t->State)
+	{
+	case ADS1256_TRIGGER_POST:
+		if (--_t->Left > 0)
+		{
+			return ADS1256_TRIGGER_PASS;
+		}
+		break;
+
+	case ADS1256_TRIGGER_ARMED:
+		if (hit && _allow)
+		{
+			_t->TimeNs = _s->TimeNs;
+			_t->Fired++;
+			if (_t->Post > 0)
+			{
+				_t->Left = _t->Post;
+				_t->State = ADS1256_TRIGGER_POST;
+				return ADS1256_TRIGGER_FIRE | ADS1256_TRIGGER_PASS;
+			}
+			_t->State = _t->Single ? ADS1256_TRIGGER_IDLE : ADS1256_TRIGGER_ARMED;
+			_t->Clear = 1;
+			return ADS1256_TRIGGER_FIRE | ADS1256_TRIGGER_PASS | ADS1256_TRIGGER_DONE;
+		}
+		if (hit)
+		{
+			_t->Missed++;
+		}
+		if (_t->Pre > 0)
+		{
+			_t->Hist[_t->HistPos] = *_s;
+			if (++_t->HistPos == _t->Pre)
+			{
+				_t->HistPos = 0;
+			}
+			if (_t->HistFill < _t->Pre)
+			{
+				_t->HistFill++;
+			}
+		}
+		return 0;
+
+	default:
+		return 0;
+	}
+
+	/* Last sample of the window: the next one starts a new history */
+	_t->State = _t->Single ? ADS1256_TRIGGER_IDLE : ADS1256_TRIGGER_ARMED;
+	_t->Clear = 1;
+	return ADS1256_TRIGGER_PASS | ADS1256_TRIGGER_DONE;
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_TriggerHistory
+*	function: Copy part of the history, oldest sample first. Valid from a FIRE until the next
+*			  ADS1256_TriggerRun after the window is DONE.
+*	parameter: _t : trigger
+*			   _from : first sample to copy, 0 = the oldest
+*			   _out : destination
+*			   _max : room in _out
+*	The return value: samples copied, 0 past the end of the history
+*********************************************************************************************************
+*/
+uint32_t ADS1256_TriggerHistory(const ADS1256_TRIGGER_T *_t, uint32_t _from, ADS1256_SAMPLE_T *_out, uint32_t _max)
+{
+	uint32_t pos, n, k;
+
+	if (_from >= _t->HistFill)
+	{
+		return 0;
+	}
+	n = _t->HistFill - _from;
+	if (n > _max)
+	{
+		n = _max;
+	}
+
+	/* The oldest sample sits at HistPos once the ring is full, at 0 before */
+	pos = (_t->HistFill < _t->Pre) ? _from : (_t->HistPos + _from) % _t->Pre;
+	for (k = 0; k < n; k++)
+	{
+		_out[k] = _t->Hist[pos];
+		if (++pos == _t->Pre)
+		{
+			pos = 0;
+		}
+	}
+	return n;
+}
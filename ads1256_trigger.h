@@ -0,0 +1,73 @@
+/*
+ * ads1256_trigger.h:
+ *	Trigger on one scan list entry of the acquisition stream. While armed, the last Pre samples
+ *	of the stream are kept in a circular history; when the entry meets the condition the history,
+ *	the trigger sample and the next Post samples make a window, and only windows are passed on
+ *	to the ring and the logger.
+ *
+ */
+
+#ifndef ADS1256_TRIGGER_H
+#define ADS1256_TRIGGER_H
+
+#include <stdint.h>
+#include "wrapper.h"
+
+#define ADS1256_TRIGGER_NONE	0
+#define ADS1256_TRIGGER_LEVEL	1		/* Value at or past Level */
+#define ADS1256_TRIGGER_EDGE	2		/* Value crosses Level */
+#define ADS1256_TRIGGER_WINDOW	3		/* Value leaves or enters [Level, Level2] */
+#define ADS1256_TRIGGER_SLOPE	4		/* Change from the previous value of the entry of Level or more */
+
+/* Direction flags: rising / leaving the window, falling / entering it */
+#define ADS1256_TRIGGER_UP		1
+#define ADS1256_TRIGGER_DOWN	2
+#define ADS1256_TRIGGER_BOTH	(ADS1256_TRIGGER_UP | ADS1256_TRIGGER_DOWN)
+
+#define ADS1256_TRIGGER_PRE_MAX		(1u << 20)
+
+/* What ADS1256_TriggerRun asks of the caller, flags */
+#define ADS1256_TRIGGER_PASS	1		/* Pass the sample on */
+#define ADS1256_TRIGGER_FIRE	2		/* The window starts: pass the history on first (ADS1256_TriggerHistory) */
+#define ADS1256_TRIGGER_DONE	4		/* The window ends with this sample */
+
+enum
+{
+	ADS1256_TRIGGER_IDLE = 0,	/* Single shot done, waiting for ADS1256_TriggerArm */
+	ADS1256_TRIGGER_ARMED,		/* Filling the history, testing the condition */
+	ADS1256_TRIGGER_POST,		/* Passing the samples after the trigger */
+};
+
+typedef struct
+{
+	uint8_t Kind;				/* ADS1256_TRIGGER_* */
+	uint8_t Dir;				/* ADS1256_TRIGGER_UP / DOWN / BOTH */
+	uint8_t Entry;				/* Scan list entry tested */
+	uint8_t Single;				/* 1: one window, then idle until armed again */
+	int32_t Level;				/* Threshold, window low edge or slope, in counts */
+	int32_t Level2;				/* Window high edge */
+	uint32_t Pre;				/* Samples of the stream kept before the trigger */
+	uint32_t Post;				/* Samples of the stream passed after it */
+	ADS1256_SAMPLE_T *Hist;		/* Pre slots */
+	uint32_t HistPos;			/* Next slot to write */
+	uint32_t HistFill;			/* Valid slots */
+	uint8_t Clear;				/* Empty the history on the next sample, the last window used it */
+	uint8_t State;
+	uint32_t Left;				/* Samples still due in the post window */
+	int32_t Prev;				/* Last value of the entry ... */
+	uint8_t HavePrev;			/* ... if there was one since the reset */
+	volatile uint8_t ArmRequest;	/* Set by ADS1256_TriggerArm from another thread */
+	int64_t TimeNs;				/* DRDY time of the last trigger sample */
+	uint32_t Fired;				/* Windows started */
+	uint32_t Missed;			/* Conditions met while the caller could not take a window */
+}ADS1256_TRIGGER_T;
+
+int ADS1256_TriggerInit(ADS1256_TRIGGER_T *_t, uint8_t _kind, uint8_t _entry, uint8_t _dir, int32_t _level,
+						int32_t _level2, uint32_t _pre, uint32_t _post, uint8_t _single);
+void ADS1256_TriggerReset(ADS1256_TRIGGER_T *_t);
+void ADS1256_TriggerFree(ADS1256_TRIGGER_T *_t);
+void ADS1256_TriggerArm(ADS1256_TRIGGER_T *_t);
+int ADS1256_TriggerRun(ADS1256_TRIGGER_T *_t, const ADS1256_SAMPLE_T *_s, int _allow);
+uint32_t ADS1256_TriggerHistory(const ADS1256_TRIGGER_T *_t, uint32_t _from, ADS1256_SAMPLE_T *_out, uint32_t _max);
+
+#endif
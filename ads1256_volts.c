@@ -0,0 +1,215 @@
+/*
+ * ads1256_volts.c:
+ *	Vectorised counts to volts conversion. Each kernel multiplies a run of int32 results by a
+ *	run of scale factors of the same length; ADS1256_CountsToVolts* repeat the scale pattern
+ *	over the block. The widest kernel the CPU supports is chosen on the first call.
+ *
+ */
+
+#include <stdint.h>
+#include "ads1256_volts.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VOLTS_X86
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define VOLTS_NEON
+#endif
+
+typedef void (*VOLTS_F32_T)(const int32_t *_in, float *_out, const float *_scale, uint32_t _n);
+typedef void (*VOLTS_F64_T)(const int32_t *_in, double *_out, const double *_scale, uint32_t _n);
+
+static VOLTS_F32_T s_pfVoltsF32;
+static VOLTS_F64_T s_pfVoltsF64;
+
+static void Volts_F32_Scalar(const int32_t *_in, float *_out, const float *_scale, uint32_t _n)
+{
+	uint32_t i;
+
+	for (i = 0; i < _n; i++)
+	{
+		_out[i] = (float)_in[i] * _scale[i];
+	}
+}
+
+static void Volts_F64_Scalar(const int32_t *_in, double *_out, const double *_scale, uint32_t _n)
+{
+	uint32_t i;
+
+	for (i = 0; i < _n; i++)
+	{
+		_out[i] = (double)_in[i] * _scale[i];
+	}
+}
+
+#ifdef VOLTS_X86
+/* SSE2 is part of x86-64; 24 bit results convert to float exactly */
+__attribute__((target("sse2")))
+static void Volts_F32_Sse2(const int32_t *_in, float *_out, const float *_scale, uint32_t _n)
+{
+	uint32_t i;
+
+	for (i = 0; i + 4 <= _n; i += 4)
+	{
+		__m128 v = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)(_in + i)));
+		_mm_storeu_ps(_out + i, _mm_mul_ps(v, _mm_loadu_ps(_scale + i)));
+	}
+	Volts_F32_Scalar(_in + i, _out + i, _scale + i, _n - i);
+}
+
+__attribute__((target("sse2")))
+static void Volts_F64_Sse2(const int32_t *_in, double *_out, const double *_scale, uint32_t _n)
+{
+	uint32_t i;
+
+	for (i = 0; i + 2 <= _n; i += 2)
+	{
+		__m128d v = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i *)(_in + i)));
+		_mm_storeu_pd(_out + i, _mm_mul_pd(v, _mm_loadu_pd(_scale + i)));
+	}
+	Volts_F64_Scalar(_in + i, _out + i, _scale + i, _n - i);
+}
+
+__attribute__((target("avx")))
+static void Volts_F32_Avx(const int32_t *_in, float *_out, const float *_scale, uint32_t _n)
+{
+	uint32_t i;
+
+	for (i = 0; i + 8 <= _n; i += 8)
+	{
+		__m256 v = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *)(_in + i)));
+		_mm256_storeu_ps(_out + i, _mm256_mul_ps(v, _mm256_loadu_ps(_scale + i)));
+	}
+	Volts_F32_Scalar(_in + i, _out + i, _scale + i, _n - i);
+}
+
+__attribute__((target("avx")))
+static void Volts_F64_Avx(const int32_t *_in, double *_out, const double *_scale, uint32_t _n)
+{
+	uint32_t i;
+
+	for (i = 0; i + 4 <= _n; i += 4)
+	{
+		__m256d v = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i *)(_in + i)));
+		_mm256_storeu_pd(_out + i, _mm256_mul_pd(v, _mm256_loadu_pd(_scale + i)));
+	}
+	Volts_F64_Scalar(_in + i, _out + i, _scale + i, _n - i);
+}
+#endif
+
+#ifdef VOLTS_NEON
+static void Volts_F32_Neon(const int32_t *_in, float *_out, const float *_scale, uint32_t _n)
+{
+	uint32_t i;
+
+	for (i = 0; i + 4 <= _n; i += 4)
+	{
+		float32x4_t v = vcvtq_f32_s32(vld1q_s32(_in + i));
+		vst1q_f32(_out + i, vmulq_f32(v, vld1q_f32(_scale + i)));
+	}
+	Volts_F32_Scalar(_in + i, _out + i, _scale + i, _n - i);
+}
+
+#ifdef __aarch64__
+/* 32 bit NEON has no double precision lanes, the scalar kernel is used there */
+static void Volts_F64_Neon(const int32_t *_in, double *_out, const double *_scale, uint32_t _n)
+{
+	uint32_t i;
+
+	for (i = 0; i + 2 <= _n; i += 2)
+	{
+		float64x2_t v = vcvtq_f64_s64(vmovl_s32(vld1_s32(_in + i)));
+		vst1q_f64(_out + i, vmulq_f64(v, vld1q_f64(_scale + i)));
+	}
+	Volts_F64_Scalar(_in + i, _out + i, _scale + i, _n - i);
+}
+#endif
+#endif
+
+/*
+*********************************************************************************************************
+*	name: Volts_Select
+*	function: Choose the kernels for this CPU, once
+*	parameter: NULL
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+static void Volts_Select(void)
+{
+	VOLTS_F32_T f32 = Volts_F32_Scalar;
+	VOLTS_F64_T f64 = Volts_F64_Scalar;
+
+	if (__atomic_load_n(&s_pfVoltsF32, __ATOMIC_ACQUIRE) != 0)
+	{
+		return;
+	}
+
+#if defined(VOLTS_X86)
+	if (__builtin_cpu_supports("avx"))
+	{
+		f32 = Volts_F32_Avx;
+		f64 = Volts_F64_Avx;
+	}
+	else if (__builtin_cpu_supports("sse2"))
+	{
+		f32 = Volts_F32_Sse2;
+		f64 = Volts_F64_Sse2;
+	}
+#elif defined(VOLTS_NEON)
+	f32 = Volts_F32_Neon;
+#ifdef __aarch64__
+	f64 = Volts_F64_Neon;
+#endif
+#endif
+
+	/* Callers running at the same time pick the same kernels, F32 last publishes both */
+	s_pfVoltsF64 = f64;
+	__atomic_store_n(&s_pfVoltsF32, f32, __ATOMIC_RELEASE);
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_CountsToVoltsF32
+*	function: Convert a block of results to single precision volts
+*	parameter: _in : results, _n of them
+*			   _out : volts, _n of them
+*			   _scale : volts per count of each position, repeated every _period results.
+*						A pattern of a few hundred values keeps the vector loop long.
+*			   _period : values in _scale
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_CountsToVoltsF32(const int32_t *_in, float *_out, uint32_t _n, const float *_scale, uint32_t _period)
+{
+	uint32_t off, len;
+
+	Volts_Select();
+	for (off = 0; off < _n; off += len)
+	{
+		len = (_n - off < _period) ? _n - off : _period;
+		s_pfVoltsF32(_in + off, _out + off, _scale, len);
+	}
+}
+
+/*
+*********************************************************************************************************
+*	name: ADS1256_CountsToVoltsF64
+*	function: Convert a block of results to double precision volts
+*	parameter: same as ADS1256_CountsToVoltsF32
+*	The return value:  NULL
+*********************************************************************************************************
+*/
+void ADS1256_CountsToVoltsF64(const int32_t *_in, double *_out, uint32_t _n, const double *_scale, uint32_t _period)
+{
+	uint32_t off, len;
+
+	Volts_Select();
+	for (off = 0; off < _n; off += len)
+	{
+		len = (_n - off < _period) ? _n - off : _period;
+		s_pfVoltsF64(_in + off, _out + off, _scale, len);
+	}
+}
@@ -0,0 +1,19 @@
+/*
+ * ads1256_volts.h:
+ *	Conversion of blocks of ADS1256 results (int32 counts) into volts, vectorised with
+ *	NEON on the Raspberry Pi and SSE2/AVX on x86. out[i] = in[i] * scale[i % period], where
+ *	scale[k] = 2 * VREF / (PGA * 0x7FFFFF) of the scan list slot k.
+ *
+ */
+
+#ifndef ADS1256_VOLTS_H
+#define ADS1256_VOLTS_H
+
+#include <stdint.h>
+
+#define ADS1256_FULL_SCALE		0x7FFFFF	/* Positive full-scale code, +2 VREF / PGA */
+
+void ADS1256_CountsToVoltsF32(const int32_t *_in, float *_out, uint32_t _n, const float *_scale, uint32_t _period);
+void ADS1256_CountsToVoltsF64(const int32_t *_in, double *_out, uint32_t _n, const double *_scale, uint32_t _period);
+
+#endif
@@ -0,0 +1,414 @@
+#include <Python.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ads1256_log.h"
+
+/*
+ * capture.c:
+ *	ads1256.Capture, the reader of the files written by log_start(). The file is mapped
+ *	read-only and its records are exported through the buffer interface as they are on disk,
+ *	so memoryview(c) or numpy.frombuffer(c, c.dtype) see the data without copying or parsing.
+ *
+ */
+
+typedef struct
+{
+    PyObject_HEAD
+    uint8_t *map;                       /* whole file, NULL once closed */
+    size_t mapSize;
+    const ADS1256_LOG_HEADER_T *hdr;    /* start of the map */
+    Py_ssize_t count;                   /* complete records mapped */
+    Py_ssize_t exports;                 /* buffers handed out and not released */
+    int fd;                             /* kept open for refresh() */
+} CaptureObject;
+
+static int capture_unmap(CaptureObject *self)
+{
+    if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "the capture is still exported (memoryview or numpy array alive)");
+        return -1;
+    }
+    if (self->map != NULL)
+        munmap(self->map, self->mapSize);
+    self->map = NULL;
+    self->hdr = NULL;
+    self->mapSize = 0;
+    self->count = 0;
+    return 0;
+}
+
+/* Map the file as it is now and check that it is a capture we can index */
+static int capture_map(CaptureObject *self)
+{
+    const ADS1256_LOG_HEADER_T *h;
+    struct stat st;
+    uint32_t slots = 0;
+    void *p;
+    uint8_t i;
+
+    if (fstat(self->fd, &st) != 0) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        return -1;
+    }
+    if ((size_t)st.st_size < sizeof(ADS1256_LOG_HEADER_T)) {
+        PyErr_SetString(PyExc_ValueError, "not an ads1256 capture: file shorter than the header");
+        return -1;
+    }
+
+    p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, self->fd, 0);
+    if (p == MAP_FAILED) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        return -1;
+    }
+    h = (const ADS1256_LOG_HEADER_T *)p;
+
+    if (memcmp(h->Magic, ADS1256_LOG_MAGIC, sizeof(h->Magic)) != 0) {
+        PyErr_SetString(PyExc_ValueError, "not an ads1256 capture: bad magic");
+        goto fail;
+    }
+    if (h->ByteOrder != ADS1256_LOG_BYTE_ORDER) {
+        PyErr_SetString(PyExc_ValueError, "the capture was written on a host of the other byte order");
+        goto fail;
+    }
+    if (h->Version != ADS1256_LOG_VERSION) {
+        PyErr_Format(PyExc_ValueError, "capture format version %d, this module reads version %d",
+                     h->Version, ADS1256_LOG_VERSION);
+        goto fail;
+    }
+    if ((h->ScanLength == 0) || (h->RecordSize != ADS1256_LOG_RECORD_SIZE(h->ScanLength)) ||
+        (h->ValuesOffset != h->ScanLength * sizeof(int64_t)) ||
+        (h->HeaderSize < sizeof(ADS1256_LOG_HEADER_T)) || ((size_t)st.st_size < h->HeaderSize) || (h->Gain > 6)) {
+        PyErr_SetString(PyExc_ValueError, "corrupt capture header");
+        goto fail;
+    }
+    /* The records are read in place as int64 and exported as such: they must start 8 byte aligned */
+    if (h->HeaderSize % sizeof(int64_t) != 0) {
+        PyErr_SetString(PyExc_ValueError, "corrupt capture header: the records are not 8 byte aligned");
+        goto fail;
+    }
+
+    /* slots and c[i] index the records by the scan list: its Repeat counts must add up to ScanLength */
+    if ((h->ScanCount == 0) || (h->ScanCount > ADS1256_LOG_SCAN_MAX)) {
+        PyErr_SetString(PyExc_ValueError, "corrupt capture header: scan list");
+        goto fail;
+    }
+    for (i = 0; i < h->ScanCount; i++)
+        slots += h->Scan[i].Repeat;
+    if (slots != h->ScanLength) {
+        PyErr_SetString(PyExc_ValueError, "corrupt capture header: the scan list does not match the record");
+        goto fail;
+    }
+
+    self->map = p;
+    self->mapSize = st.st_size;
+    self->hdr = h;
+    /* A record still being written by a running logger is not counted */
+    self->count = (st.st_size - h->HeaderSize) / h->RecordSize;
+    return 0;
+
+fail:
+    munmap(p, st.st_size);
+    return -1;
+}
+
+static int capture_check(CaptureObject *self)
+{
+    if (self->map == NULL) {
+        PyErr_SetString(PyExc_ValueError, "I/O operation on a closed capture");
+        return -1;
+    }
+    return 0;
+}
+
+static int Capture_init(CaptureObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"path", NULL};
+    const char *path;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s", kwlist, &path))
+        return -1;
+    if (capture_unmap(self) != 0)
+        return -1;
+    if (self->fd >= 0)
+        close(self->fd);
+
+    self->fd = open(path, O_RDONLY);
+    if (self->fd < 0) {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, (char *)path);
+        return -1;
+    }
+    if (capture_map(self) != 0) {
+        close(self->fd);
+        self->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject *Capture_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    CaptureObject *self = (CaptureObject *)type->tp_alloc(type, 0);
+
+    if (self != NULL)
+        self->fd = -1;
+    return (PyObject *)self;
+}
+
+static void Capture_dealloc(CaptureObject *self)
+{
+    /* No export can be alive here: every buffer holds a reference to the object */
+    if (self->map != NULL)
+        munmap(self->map, self->mapSize);
+    if (self->fd >= 0)
+        close(self->fd);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+/* Buffer interface: the records, from the end of the header to the last complete record */
+static int Capture_getbuffer(CaptureObject *self, Py_buffer *view, int flags)
+{
+    if (capture_check(self) != 0)
+        return -1;
+    if (PyBuffer_FillInfo(view, (PyObject *)self, self->map + self->hdr->HeaderSize,
+                          self->count * self->hdr->RecordSize, 1, flags) != 0)
+        return -1;
+    self->exports++;
+    return 0;
+}
+
+static void Capture_releasebuffer(CaptureObject *self, Py_buffer *view)
+{
+    self->exports--;
+}
+
+static PyBufferProcs Capture_as_buffer = {
+    (getbufferproc)Capture_getbuffer,
+    (releasebufferproc)Capture_releasebuffer,
+};
+
+/* len(c): complete records; c[i]: (times, values) of record i, missing slots as None */
+static Py_ssize_t Capture_length(CaptureObject *self)
+{
+    return (self->map == NULL) ? 0 : self->count;
+}
+
+static PyObject *Capture_item(CaptureObject *self, Py_ssize_t i)
+{
+    const int64_t *t;
+    const int32_t *v;
+    PyObject *times, *values;
+    Py_ssize_t k, n;
+
+    if (capture_check(self) != 0)
+        return NULL;
+    if ((i < 0) || (i >= self->count)) {
+        PyErr_SetString(PyExc_IndexError, "capture record out of range");
+        return NULL;
+    }
+
+    n = self->hdr->ScanLength;
+    t = (const int64_t *)(self->map + self->hdr->HeaderSize + i * self->hdr->RecordSize);
+    v = (const int32_t *)((const uint8_t *)t + self->hdr->ValuesOffset);
+    times = PyList_New(n);
+    values = PyList_New(n);
+    if ((times == NULL) || (values == NULL))
+        goto fail;
+    for (k = 0; k < n; k++) {
+        if (v[k] == ADS1256_LOG_MISSING) {
+            Py_INCREF(Py_None);
+            PyList_SET_ITEM(times, k, Py_None);
+            Py_INCREF(Py_None);
+            PyList_SET_ITEM(values, k, Py_None);
+            continue;
+        }
+        PyList_SET_ITEM(times, k, PyLong_FromLongLong(t[k]));
+        PyList_SET_ITEM(values, k, PyLong_FromLong(v[k]));
+        if ((PyList_GET_ITEM(times, k) == NULL) || (PyList_GET_ITEM(values, k) == NULL))
+            goto fail;
+    }
+    return Py_BuildValue("(NN)", times, values);
+
+fail:
+    Py_XDECREF(times);
+    Py_XDECREF(values);
+    return NULL;
+}
+
+static PySequenceMethods Capture_as_sequence = {
+    (lenfunc)Capture_length,
+    0,
+    0,
+    (ssizeargfunc)Capture_item,
+};
+
+static PyObject *Capture_refresh(CaptureObject *self, PyObject *args)
+{
+    if (self->fd < 0) {
+        PyErr_SetString(PyExc_ValueError, "I/O operation on a closed capture");
+        return NULL;
+    }
+    if (capture_unmap(self) != 0)
+        return NULL;
+    if (capture_map(self) != 0)
+        return NULL;
+    return PyLong_FromSsize_t(self->count);
+}
+
+static PyObject *Capture_close(CaptureObject *self, PyObject *args)
+{
+    if (capture_unmap(self) != 0)
+        return NULL;
+    if (self->fd >= 0)
+        close(self->fd);
+    self->fd = -1;
+    Py_RETURN_NONE;
+}
+
+static PyObject *Capture_enter(CaptureObject *self, PyObject *args)
+{
+    Py_INCREF(self);
+    return (PyObject *)self;
+}
+
+static PyObject *Capture_exit(CaptureObject *self, PyObject *args)
+{
+    return Capture_close(self, NULL);
+}
+
+static PyMethodDef Capture_methods[] = {
+    {"refresh", (PyCFunction)Capture_refresh, METH_NOARGS, "mapeia de novo o arquivo para ver os registros gravados desde a abertura; retorna o numero de registros"},
+    {"close", (PyCFunction)Capture_close, METH_NOARGS, "desfaz o mapeamento e fecha o arquivo"},
+    {"__enter__", (PyCFunction)Capture_enter, METH_NOARGS, NULL},
+    {"__exit__", (PyCFunction)Capture_exit, METH_VARARGS, NULL},
+    {NULL, NULL, 0, NULL}
+};
+
+/* Header fields */
+static PyObject *Capture_get_header(CaptureObject *self, void *closure)
+{
+    const ADS1256_LOG_HEADER_T *h = self->hdr;
+    PyObject *scan, *e;
+    uint8_t i, g;
+
+    if (capture_check(self) != 0)
+        return NULL;
+
+    /* Same (ainp, ainn, gain, repeat) tuples as set_scan_list(), gain 0 = the start() gain, -1 = GAIN_AUTO */
+    scan = PyList_New(h->ScanCount);
+    if (scan == NULL)
+        return NULL;
+    for (i = 0; i < h->ScanCount; i++) {
+        g = h->Scan[i].Gain;
+        e = Py_BuildValue("(iiii)", h->Scan[i].Mux >> 4, h->Scan[i].Mux & 0x0F,
+                          (g == 0xFF) ? 0 : (g == 0xFE) ? -1 : 1 << g, h->Scan[i].Repeat);
+        if (e == NULL) {
+            Py_DECREF(scan);
+            return NULL;
+        }
+        PyList_SET_ITEM(scan, i, e);
+    }
+
+    return Py_BuildValue("{s:i,s:i,s:i,s:i,s:i,s:i,s:i,s:I,s:I,s:L,s:L,s:d,s:N}",
+                         "version", h->Version, "header_size", h->HeaderSize, "record_size", (int)h->RecordSize,
+                         "scan_length", h->ScanLength, "values_offset", (int)h->ValuesOffset,
+                         "gain", 1 << h->Gain, "drate", h->Drate, "sclk_hz", (unsigned int)h->SclkHz,
+                         "file_index", (unsigned int)h->FileIndex, "time_base_raw", (PY_LONG_LONG)h->TimeBaseRawNs,
+                         "time_base_real", (PY_LONG_LONG)h->TimeBaseRealNs, "vref", (double)h->VrefVolts,
+                         "scan", scan);
+}
+
+/* Scan list entry of every slot of a record */
+static PyObject *Capture_get_slots(CaptureObject *self, void *closure)
+{
+    PyObject *slots, *e;
+    Py_ssize_t n = 0;
+    uint8_t i, r;
+
+    if (capture_check(self) != 0)
+        return NULL;
+    slots = PyList_New(self->hdr->ScanLength);
+    if (slots == NULL)
+        return NULL;
+    /* capture_map checked that the Repeat counts fill exactly ScanLength slots */
+    for (i = 0; i < self->hdr->ScanCount; i++)
+        for (r = 0; r < self->hdr->Scan[i].Repeat; r++) {
+            e = PyLong_FromLong(i);
+            if (e == NULL) {
+                Py_DECREF(slots);
+                return NULL;
+            }
+            PyList_SET_ITEM(slots, n++, e);
+        }
+    return slots;
+}
+
+/* numpy dtype of one record: numpy.frombuffer(c, c.dtype)['value'] is a (records, slots) int32 view */
+static PyObject *Capture_get_dtype(CaptureObject *self, void *closure)
+{
+    if (capture_check(self) != 0)
+        return NULL;
+    return Py_BuildValue("{s:[ss],s:[(si)(si)],s:[ii],s:i}",
+                         "names", "time", "value",
+                         "formats", "=i8", (int)self->hdr->ScanLength, "=i4", (int)self->hdr->ScanLength,
+                         "offsets", 0, (int)self->hdr->ValuesOffset,
+                         "itemsize", (int)self->hdr->RecordSize);
+}
+
+static PyObject *Capture_get_closed(CaptureObject *self, void *closure)
+{
+    return PyBool_FromLong(self->map == NULL);
+}
+
+static PyGetSetDef Capture_getset[] = {
+    {"header", (getter)Capture_get_header, NULL, "campos do cabecalho do arquivo", NULL},
+    {"slots", (getter)Capture_get_slots, NULL, "entrada da lista de varredura de cada posicao de um registro", NULL},
+    {"dtype", (getter)Capture_get_dtype, NULL, "descricao de um registro para numpy.dtype", NULL},
+    {"closed", (getter)Capture_get_closed, NULL, NULL, NULL},
+    {NULL}
+};
+
+PyTypeObject CaptureType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "ads1256.Capture",                          /* tp_name */
+    sizeof(CaptureObject),                      /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor)Capture_dealloc,                /* tp_dealloc */
+    0,                                          /* tp_vectorcall_offset */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    0,                                          /* tp_as_async */
+    0,                                          /* tp_repr */
+    0,                                          /* tp_as_number */
+    &Capture_as_sequence,                       /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    0,                                          /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    0,                                          /* tp_getattro */
+    0,                                          /* tp_setattro */
+    &Capture_as_buffer,                         /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                         /* tp_flags */
+    "Capture(path): arquivo gravado por log_start(), mapeado na memoria sem copia", /* tp_doc */
+    0,                                          /* tp_traverse */
+    0,                                          /* tp_clear */
+    0,                                          /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    0,                                          /* tp_iter */
+    0,                                          /* tp_iternext */
+    Capture_methods,                            /* tp_methods */
+    0,                                          /* tp_members */
+    Capture_getset,                             /* tp_getset */
+    0,                                          /* tp_base */
+    0,                                          /* tp_dict */
+    0,                                          /* tp_descr_get */
+    0,                                          /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    (initproc)Capture_init,                     /* tp_init */
+    0,                                          /* tp_alloc */
+    Capture_new,                                /* tp_new */
+};
@@ -1,5 +1,6 @@
 import ads1256                  # import the ads1256 lib                             
 import time                     # import the time lib
+import struct                   # import the struct lib, packs the values as int32
 from datetime import datetime   # import the datetime lib
 
 #Python example to use the ADS1256 as a Voltage Data Logger.  
@@ -23,7 +24,8 @@ filename = "ads1256-log-"+str(timest)+".csv"
 
 
 header =[]            
-header.extend(["Row_id","Channel 0","Channel 1","Channel 2","Channel 3","Channel 4","Channel 5","Channel 6","Channel 7","Timestamp"])   # Define a CSV header 
+header.extend(["Row_id","Channel 0","Channel 1","Channel 2","Channel 3","Channel 4","Channel 5","Channel 6","Channel 7","Timestamp",
+               "T0","T1","T2","T3","T4","T5","T6","T7"])   # Define a CSV header. Tx: DRDY time of channel x, seconds of ads1256.clock()
 
 
 with open(filename,"w") as file:        						# With the opened file...
@@ -45,18 +47,18 @@ with open(filename,"a") as file:           # Open the file into Append mode (ent
                 
                 row_id = i
 
-                ch = ads1256.read_all_channels()       # Fill the first list with all the ADC's absolute channel values 
+                ch, t = ads1256.read_all_channels(timestamps=True)   # Fill the first list with all the ADC's absolute channel values, and t with the moment each one was converted
                 
-                for x in range(0, 8):
-                    chv[x] = (((ch[x] * 100) /167.0)/int(gain))/1000000.0   # Fill the second list  with the voltage values
+                chv = ads1256.to_volts(bytearray(struct.pack("8i", *ch)))   # Fill the second list with the voltage values (gain and VREF of the ADC)
 
-                print str(chv[0]) + " " + str(chv[1]) + " " + str(chv[2]) + " " + str(chv[3]) + " " + str(chv[4]) + " " + str(chv[5]) + " " + str(chv[6])+ " " + str(chv[7])
+                print(str(chv[0]) + " " + str(chv[1]) + " " + str(chv[2]) + " " + str(chv[3]) + " " + str(chv[4]) + " " + str(chv[5]) + " " + str(chv[6])+ " " + str(chv[7]))
 
                 # Registra efetivamente no arquivo .CSV  (no padrao americano)
                 file.write(str(row_id) 
                 + ", " + str(chv[0]) + ", " + str(chv[1]) + ", " + str(chv[2]) 
                 + ", " + str(chv[3]) + ", " + str(chv[4]) + ", " + str(chv[5]) 
-                + ", " + str(chv[6]) + ", " + str(chv[7]) + ", " + str(datetime.now()) + "\r\n")
+                + ", " + str(chv[6]) + ", " + str(chv[7]) + ", " + str(datetime.now())
+                + ", " + ", ".join("%.6f" % x for x in t) + "\r\n")
 
                 time.sleep(0.1)   # That's the time the program will wait until the next read. To use higher SPS, use a lower sleep value, of miliseconds
                 i = i + 1
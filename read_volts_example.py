@@ -1,4 +1,5 @@
 import ads1256       # import this lib                             
+import struct        # packs the values as int32 for to_volts()
 
 gain = 1			 # ADC's Gain parameter
 sps = 25			 # ADC's SPS parameter
@@ -15,14 +16,13 @@ ads1256.start(str(gain),str(sps))
 # Fill the first list with all the ADC's absolute channel values
 AllChannelValues = ads1256.read_all_channels()        
                 
-for i in range(0, 8):
-	# Fill the second list  with the voltage values
-	AllChannelValuesVolts[i] = (((AllChannelValues[i] * 100) /167.0)/int(gain))/1000000.0   
+# Fill the second list with the voltage values, converted natively with the gain and VREF (2.5 V) in use
+AllChannelValuesVolts = ads1256.to_volts(bytearray(struct.pack("8i", *AllChannelValues)))
 
 
 for i in range(0, 8):     
     # Print all the absolute values
-    print AllChannelValues[i]              
+    print(AllChannelValues[i])
 
 
 # Print a new line
@@ -31,7 +31,7 @@ print ("\n");
 
 for i in range(0, 8):     
     # Print all the Volts values converted from the absolute values
-    print AllChannelValuesVolts[i]         
+    print(AllChannelValuesVolts[i])
 
 # Stop the use of the ADC
 ads1256.stop() 							   
@@ -1,7 +1,28 @@
-from distutils.core import setup, Extension
+import os
+import platform
+from setuptools import setup, Extension
 
-c_ext = Extension("ads1256", ["wrapper.c", "ads1256_test.c"], libraries = ['bcm2835'])
+sources = ["wrapper.c", "ads1256_test.c", "ads1256_bcm2835.c", "ads1256_sim.c", "capture.c", "ads1256_volts.c",
+           "ads1256_filter.c", "ads1256_trigger.c", "ads1256_control.c"]
+libraries = ['pthread']
+define_macros = []
+extra_compile_args = []
+
+# ADS1256_SIM_ONLY=1 builds without the bcm2835 library (e.g. on a PC): only the simulated chip is available
+if os.environ.get("ADS1256_SIM_ONLY"):
+    define_macros.append(("ADS1256_NO_BCM2835", None))
+else:
+    libraries.insert(0, 'bcm2835')
+
+# 32 bit ARMv7 (Pi 2 and later with a 32 bit OS) has NEON but gcc does not enable it by default;
+# the ARMv6 Pi 1 / Zero has none and uses the scalar volts and filter kernels
+if platform.machine() == "armv7l":
+    extra_compile_args.append("-mfpu=neon")
+
+c_ext = Extension("ads1256", sources, libraries = libraries, define_macros = define_macros,
+                  extra_compile_args = extra_compile_args)
 
 setup(
     ext_modules=[c_ext],
+    python_requires=">=3.9",
 )
@@ -0,0 +1,348 @@
+#!/usr/bin/env python3
+# Regression tests and timing of the driver against the simulated ADS1256, no board needed.
+# Build the module with ADS1256_SIM_ONLY=1 (see "make test") and run:  python3 sim_test.py
+# The simulator puts 0.25 V * x plus a 0.05 V, (x+1) Hz sine on AINx. Exits with 1 if a check fails.
+import ads1256
+import array, math, os, shutil, struct, sys, tempfile, threading, time
+
+VOLT = 0x7FFFFF / 5.0          # counts per volt at gain 1
+TOL = 0.07 * VOLT              # the sine plus the noise of the model
+failed = []
+
+
+def check(ok, what):
+    print(("  ok    " if ok else "  FAIL  ") + what)
+    if not ok:
+        failed.append(what)
+
+
+def near(value, volts, sines=1):
+    return abs(value - volts * VOLT) < TOL + (sines - 1) * 0.05 * VOLT    # a differential entry has two
+
+
+def board(chip=0):
+    return ads1256.ADS1256(cs=chip, drdy=chip, transport="sim")
+
+
+def test_scan_order():
+    print("scan order")
+    a = board()
+    a.set_scan_list([(5, ads1256.AINCOM), (2, ads1256.AINCOM), (7, ads1256.AINCOM), (4, 5)])
+    a.start(1, 1000)
+    a.get_stats(reset=True)
+    values, times = a.read_all_channels(timestamps=True)
+    check(len(values) == 4, "one value per scan list entry")
+    check(all(near(v, x, s) for v, x, s in zip(values, (1.25, 0.5, 1.75, -0.25), (1, 1, 1, 2))),
+          "values in scan list order %s" % values)
+    late = a.get_stats()["late"]   # an entry dropped late is read again on the next pass
+    check(late > 0 or all(t1 > t0 for t0, t1 in zip(times, times[1:])), "entries converted one after the other")
+    a.set_scan_list()
+    check(all(near(v, 0.25 * i) for i, v in enumerate(a.read_all_channels())), "default list is AIN0-AIN7")
+    a.stop()
+
+
+def test_read_block():
+    print("read_block")
+    a = board()
+    a.set_scan_list([(1, ads1256.AINCOM), (6, ads1256.AINCOM, 0, 2)])
+    a.start(1, 2000)
+    n, width = 50, 2           # one column per entry, the repeats of an entry share it
+    out = array.array('i', [0] * (n * width))
+    times = array.array('q', [0] * (n * width))
+    a.read_block(n, out, times)
+    check(all(near(out[k * width], 0.25) for k in range(n)), "entry 0 is AIN1 in every scan")
+    check(all(near(out[k * width + 1], 1.5) for k in range(n)), "entry 1 (AIN6, repeat 2) in every scan")
+    check(all(t1 > t0 for t0, t1 in zip(times, times[1:])), "timestamps increase through the block")
+    try:
+        a.read_block(n + 1, out)
+        check(False, "a block larger than the buffer is refused")
+    except ValueError:
+        check(True, "a block larger than the buffer is refused")
+    try:
+        a.read_block(2 ** 62, out)
+        check(False, "n * entries overflowing a long is refused")
+    except (ValueError, OverflowError):
+        check(True, "n * entries overflowing a long is refused")
+    a.stop()
+
+
+def test_acquisition():
+    print("acquisition ring")
+    a = board()
+    a.set_scan_list([(0, ads1256.AINCOM), (3, ads1256.AINCOM), (7, ads1256.AINCOM)])
+    a.start(1, 1000)
+    a.get_stats(reset=True)
+    a.acq_start(8192)
+    try:
+        a.start(1, 1000)
+        check(False, "start() is refused while the acquisition thread runs")
+    except RuntimeError:
+        check(True, "start() is refused while the acquisition thread runs")
+    time.sleep(0.5)
+    s = a.acq_drain()
+    a.acq_stop()
+    check(len(s) > 100, "%d samples in 0.5 s" % len(s))
+    skips = sum(1 for s0, s1 in zip(s, s[1:]) if s1[1] != (s0[1] + 1) % 3)
+    late = a.get_stats()["late"]
+    check(skips <= late, "channels follow the scan list, but for %d conversions counted late" % late)
+    check(all(s1[0] > s0[0] for s0, s1 in zip(s, s[1:])), "timestamps increase")
+    check(all(near(v, (0, 0.75, 1.75)[ch]) for t, ch, v in s), "values belong to their entries")
+    check(a.acq_dropped() == 0, "nothing dropped with a large ring")
+
+    a.acq_start(16)
+    time.sleep(0.2)
+    check(a.acq_dropped() > 0, "a full ring counts what it drops (%d)" % a.acq_dropped())
+    a.acq_stop()
+    for capacity in (0, 2 ** 24 + 1, 2 ** 62 + 1):
+        try:
+            a.acq_start(capacity)
+            a.acq_stop()
+            check(False, "a ring of %d samples is refused" % capacity)
+        except ValueError:
+            check(True, "a ring of %d samples is refused" % capacity)
+    a.stop()
+
+
+def test_late_mux():
+    print("late multiplexer frames")
+    for us in (100, 600):      # a WREG of MUX held that long at 2000 SPS, one conversion is 500 us
+        os.environ["ADS1256_SIM_FAULT"] = "slowmux:%d" % us
+        try:
+            a = board()
+            a.set_scan_list([(1, ads1256.AINCOM), (6, ads1256.AINCOM)])
+            a.start(1, 2000)
+        finally:
+            del os.environ["ADS1256_SIM_FAULT"]
+        if us < 500:
+            values = a.read_all_channels()
+            check(near(values[0], 0.25) and near(values[1], 1.5), "held %d us: both entries read %s" % (us, values))
+        else:
+            try:
+                a.read_all_channels()
+                check(False, "held %d us: a conversion that ran on both inputs is not stored" % us)
+            except ads1256.Error:
+                check(True, "held %d us: a conversion that ran on both inputs is not stored" % us)
+        a.acq_start(8192)
+        time.sleep(0.2)
+        s = a.acq_drain()
+        a.acq_stop()
+        good = all(near(v, (0.25, 1.5)[ch]) for t, ch, v in s)
+        if us < 500:
+            check(len(s) > 100 and good, "held %d us: %d samples" % (us, len(s)))
+        else:          # only the first one, of unknown age, is read with the chip held and kept
+            check(len(s) <= 2 and good and a.get_stats()["late"] > 100, "held %d us: %d stored, %d counted late" %
+                  (us, len(s), a.get_stats()["late"]))
+        a.stop()
+
+
+def test_default_rate():
+    print("default configuration at 30000 SPS")
+    a = board()
+    a.start(1, 30000)          # default SPI clock and scan list AIN0-AIN7
+    for i in range(3):
+        values = a.read_all_channels()
+        check(all(near(v, 0.25 * k) for k, v in enumerate(values)), "read_all_channels() %s" % values)
+    check(all(near(a.read_channel(k), 0.25 * k) for k in (0, 3, 7)), "read_channel() reads the entry asked for")
+    out = array.array('i', [0] * (100 * 8))
+    a.read_block(100, out)
+    check(all(near(v, 0.25 * (k % 8)) for k, v in enumerate(out)), "read_block() of 100 scans")
+    a.get_stats(reset=True)
+    a.acq_start(65536)
+    time.sleep(0.3)
+    s = a.acq_drain()
+    a.acq_stop()
+    late = a.get_stats()["late"]
+    check(len(s) > 500, "%d samples in 0.3 s, %d conversions counted late" % (len(s), late))
+    check(all(near(v, 0.25 * ch) for t, ch, v in s), "acquired values belong to their entries")
+    a.stop()
+
+
+def test_capture(tmp):
+    print("capture round-trip")
+    a = board()
+    scan = [(2, ads1256.AINCOM), (4, 5, 0, 2)]
+    a.set_scan_list(scan)
+    a.start(1, 2000)
+    a.acq_start(65536)
+    base = os.path.join(tmp, "cap")
+    try:
+        a.log_start(base, capacity=2 ** 62 + 1)
+        a.log_stop()
+        check(False, "a logger ring beyond 2^24 samples is refused")
+    except ValueError:
+        check(True, "a logger ring beyond 2^24 samples is refused")
+    a.log_start(base, rotate_s=1)
+    time.sleep(1.5)
+    a.log_stop()
+    drained = a.acq_drain()
+    a.acq_stop()
+    stats = a.log_stats()
+    a.stop()
+
+    files = sorted(f for f in os.listdir(tmp) if f.startswith("cap-"))
+    check(len(files) >= 2, "rotated into %d files" % len(files))
+    size = sum(os.path.getsize(os.path.join(tmp, f)) for f in files)
+    check(stats["bytes"] == size, "log_stats() bytes equal the files on disk")
+    logged = []
+    for f in files:
+        with ads1256.Capture(os.path.join(tmp, f)) as c:
+            h = c.header
+            check((size - 4096 * len(files)) % h["record_size"] == 0, "%s is whole records" % f)
+            check(c.slots == [0, 1, 1], "slots of %s follow the scan list" % f)
+            for i in range(len(c)):
+                logged.extend(s for s in zip(*c[i]) if s[1] is not None)    # the pass the logger started in is partial
+
+    # The files hold the stream of the ring from where the logger started, in ns instead of seconds
+    k = 0
+    while (k < len(drained)) and (abs(drained[k][0] * 1e9 - logged[0][0]) > 1000):
+        k += 1
+    same = sum(1 for (t, ch, v), (tt, vv) in zip(drained[k:], logged) if abs(t * 1e9 - tt) < 1000 and v == vv)
+    check(len(logged) > 0 and same == len(logged), "%d logged samples match the ring one by one" % len(logged))
+
+    # A corrupted scan list in the header must not map the records wrongly
+    bad = os.path.join(tmp, "bad.ads")
+    shutil.copy(os.path.join(tmp, files[0]), bad)
+    with open(bad, "r+b") as fp:
+        fp.seek(52)
+        fp.write(struct.pack("B", 200))
+    try:
+        ads1256.Capture(bad)
+        check(False, "a header with a bad scan count is refused")
+    except ValueError:
+        check(True, "a header with a bad scan count is refused")
+    shutil.copy(os.path.join(tmp, files[0]), bad)
+    with open(bad, "r+b") as fp:
+        fp.seek(14)
+        fp.write(struct.pack("=H", 4100))
+    try:
+        ads1256.Capture(bad)
+        check(False, "a header size that misaligns the records is refused")
+    except ValueError:
+        check(True, "a header size that misaligns the records is refused")
+
+
+def test_filter_trigger():
+    print("filter and trigger")
+    a = board()
+    a.set_scan_list([(0, ads1256.AINCOM), (3, ads1256.AINCOM)])
+    a.start(1, 2000)
+    a.set_filter(0, "mavg", 8, decimation=8)
+    a.set_filter(1, "cic", 2, decimation=8)
+    a.acq_start(8192)
+    time.sleep(0.6)
+    s = a.acq_drain()
+    a.acq_stop()
+    n0 = sum(1 for t, ch, v in s if ch == 0)
+    n1 = sum(1 for t, ch, v in s if ch == 1)
+    check(n0 > 10 and abs(n0 - n1) <= 2, "decimated by 8 on both entries (%d, %d)" % (n0, n1))
+    check(all(near(v, (0, 0.75)[ch]) for t, ch, v in s), "filtered values keep their level")
+
+    # AIN1 in a 2 Hz sine around 0.25 V: a rising edge through 0.25 V fires once per period
+    a.set_scan_list([(1, ads1256.AINCOM), (2, ads1256.AINCOM)])
+    level = int(0.25 * VOLT)
+    a.set_trigger(0, "edge", level, "rising", pre=10, post=20)
+    a.acq_start()
+    time.sleep(1.3)
+    w = a.trigger_read()
+    a.acq_stop()
+    check(len(w) >= 2, "%d windows in 1.3 s of a 2 Hz sine" % len(w))
+    ok = True
+    for t, pre, samples in w:  # the history starts empty, and again after each window: pre <= 10
+        ch0 = [v for tt, ch, v in samples[:pre + 1] if ch == 0]
+        ok = ok and pre <= 10 and len(samples) == pre + 21 and samples[pre][1] == 0
+        ok = ok and ch0[-1] >= level and (len(ch0) < 2 or level > ch0[-2])
+    check(ok, "each window has pre + 1 + post samples and crosses the level at samples[pre]")
+    a.stop()
+
+
+def test_rates():
+    print("data rates")
+    a = board()
+    a.set_scan_list([(0, ads1256.AINCOM)])
+    for sps, expected in ((10, 0.1), (50, 0.02), (100, 0.01)):
+        a.start(1, sps)
+        times = array.array('q', [0] * 7)
+        a.read_block(7, array.array('i', [0] * 7), times)
+        dt = sorted(t1 - t0 for t0, t1 in zip(times[1:], times[2:]))[2] / 1e9    # the median: one may be dropped late
+        check(abs(dt - expected) < 0.3 * expected, "%g SPS converts every %.2f ms" % (sps, dt * 1e3))
+    a.stop()
+
+
+def bench():
+    print("bench")
+    a = board()
+    a.start(1, 30000)
+    for entries in (1, 8):
+        a.set_scan_list([(i, ads1256.AINCOM) for i in range(entries)])
+        n = 3000 // entries
+        out = array.array('i', [0] * (n * entries))
+        t0 = time.time()
+        a.read_block(n, out)
+        dt = time.time() - t0
+        print("  read_block, %d entries: %.0f scans/s, %.0f conversions/s" % (entries, n / dt, n * entries / dt))
+    lat = []
+    for i in range(50):
+        v, t = a.read_all_channels(timestamps=True)
+        lat.append(ads1256.clock() - t[-1])
+    lat.sort()
+    print("  DRDY to Python: median %.0f us, max %.0f us" % (lat[25] * 1e6, lat[-1] * 1e6))
+    a.set_scan_list()
+    a.acq_start(65536)
+    time.sleep(1)
+    n = len(a.acq_drain())
+    a.acq_stop()
+    print("  acquisition thread: %d conversions/s, %d dropped" % (n, a.acq_dropped()))
+    a.stop()
+
+    # Two boards read from two threads convert side by side
+    boards = [board(0), board(1)]
+    for b in boards:
+        b.set_scan_list([(0, ads1256.AINCOM), (1, ads1256.AINCOM)])
+        b.start(1, 100)
+    block = lambda b: b.read_block(30, array.array('i', [0] * 60))
+    t0 = time.time()
+    block(boards[0])
+    alone = time.time() - t0
+    th = [threading.Thread(target=block, args=(b,)) for b in boards]
+    t0 = time.time()
+    [t.start() for t in th]
+    [t.join() for t in th]
+    both = time.time() - t0
+    print("  read_block(30) at 100 SPS: one board %.2f s, two boards in two threads %.2f s" % (alone, both))
+    check(both < 1.5 * alone, "two boards do not wait for each other's conversions")
+    boards[1].stop()
+
+    # DAC playback at 1 kHz keeps its schedule while a slow read waits for DRDY
+    a = boards[0]
+    a.configure(sps=10)
+    a.dac_play(array.array('H', [int(32768 + 30000 * math.sin(2 * math.pi * i / 100)) for i in range(100)]), 1000, loop=True)
+    time.sleep(0.2)
+    runs = []
+    for i in range(3):         # the fewest of three: a busy machine makes the thread late now and then
+        late = a.dac_stats()["late"]
+        t0 = time.time()
+        a.read_all_channels()
+        runs.append((a.dac_stats()["late"] - late, time.time() - t0))
+    late, dt = min(runs)
+    print("  read_all_channels at 10 SPS: %.2f s, %d DAC frames late" % (dt, late))
+    check(late < 0.05 * dt * 1000, "DAC playback is not held up by a blocking read")
+    a.dac_stop()
+    a.stop()
+
+
+if __name__ == "__main__":
+    tmp = tempfile.mkdtemp(prefix="ads1256-")
+    try:
+        test_scan_order()
+        test_read_block()
+        test_acquisition()
+        test_late_mux()
+        test_default_rate()
+        test_capture(tmp)
+        test_filter_trigger()
+        test_rates()
+        bench()
+    finally:
+        shutil.rmtree(tmp)
+    print("\n%d checks failed" % len(failed) if failed else "\nall checks passed")
+    sys.exit(1 if failed else 0)
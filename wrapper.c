@@ -1,102 +1,472 @@
 #include <Python.h>
+#include <math.h>
 #include "wrapper.h"
+#include "ads1256_volts.h"
+#include "ads1256_filter.h"
+#include "ads1256_trigger.h"
+#include "ads1256_control.h"
+
+extern PyTypeObject CaptureType;   /* capture.c */
+
+/* One ads1256.ADS1256: the driver state of a board, created and freed with the object */
+typedef struct
+{
+    PyObject_HEAD
+    ADS1256_DEV_T *Dev;
+    PyObject *Modulo;       /* the module, for the exceptions */
+} AdcObject;
+
+/* Module state (multi-phase init): the exceptions, the ADS1256 type and the board the module level
+   functions act on, created on the first call so that scripts written for one board keep working */
+typedef struct
+{
+    PyObject *Error, *TimeoutError, *DeviceError;
+    PyObject *AdcType, *GroupType;
+    PyObject *Default;
+} AdcModuleState;
+
+static AdcModuleState *adc_estado(PyObject *self);
+static ADS1256_DEV_T *adc_dev(PyObject *self);
+static PyObject *dac_erro(PyObject *self, int err);
 
 /* Docstrings */
 static char module_docstring[] =
-    "Esta biblioteca é um wrapper ";
+    "Esta biblioteca é um wrapper do ADS1256 da placa AD/DA da Waveshare. Cada ads1256.ADS1256(cs, drdy) "
+    "e uma placa; as funcoes do modulo usam a placa dos pinos padrao";
 
 /* Available functions */
 static PyObject *adc_read_channel(PyObject *self, PyObject *args);
-static PyObject *adc_read_all_channels(PyObject *self, PyObject *args);
-static PyObject *adc_start(PyObject *self, PyObject *args);
+static PyObject *adc_read_all_channels(PyObject *self, PyObject *args, PyObject *kwds);
+static PyObject *adc_read_block(PyObject *self, PyObject *args, PyObject *kwds);
+static PyObject *adc_start(PyObject *self, PyObject *args, PyObject *kwds);
 static PyObject *adc_stop(PyObject *self, PyObject *args);
+static PyObject *adc_configure(PyObject *self, PyObject *args, PyObject *kwds);
+static PyObject *adc_start_continuous(PyObject *self, PyObject *args);
+static PyObject *adc_read_continuous(PyObject *self, PyObject *args);
+static PyObject *adc_stop_continuous(PyObject *self, PyObject *args);
+static PyObject *adc_acq_start(PyObject *self, PyObject *args);
+static PyObject *adc_acq_stop(PyObject *self, PyObject *args);
+static PyObject *adc_acq_drain(PyObject *self, PyObject *args);
+static PyObject *adc_acq_peek(PyObject *self, PyObject *args);
+static PyObject *adc_acq_dropped(PyObject *self, PyObject *args);
+static PyObject *adc_set_drdy_wait(PyObject *self, PyObject *args, PyObject *kwds);
+static PyObject *adc_set_transport(PyObject *self, PyObject *args);
+static PyObject *adc_timing(PyObject *self, PyObject *args);
+static PyObject *adc_get_stats(PyObject *self, PyObject *args, PyObject *kwds);
+static PyObject *adc_set_scan_list(PyObject *self, PyObject *args);
+static PyObject *adc_gains(PyObject *self, PyObject *args);
+static PyObject *adc_set_filter(PyObject *self, PyObject *args, PyObject *kwds);
+static PyObject *adc_set_trigger(PyObject *self, PyObject *args, PyObject *kwds);
+static PyObject *adc_trigger_arm(PyObject *self, PyObject *args);
+static PyObject *adc_trigger_read(PyObject *self, PyObject *args);
+static PyObject *adc_trigger_stats(PyObject *self, PyObject *args);
+static PyObject *adc_dac_write(PyObject *self, PyObject *args);
+static PyObject *adc_dac_write_volts(PyObject *self, PyObject *args);
+static PyObject *adc_dac_set_vref(PyObject *self, PyObject *args);
+static PyObject *adc_dac_play(PyObject *self, PyObject *args, PyObject *kwds);
+static PyObject *adc_dac_queue(PyObject *self, PyObject *args, PyObject *kwds);
+static PyObject *adc_dac_stop(PyObject *self, PyObject *args);
+static PyObject *adc_dac_stats(PyObject *self, PyObject *args);
+static PyObject *adc_set_control(PyObject *self, PyObject *args, PyObject *kwds);
+static PyObject *adc_control_setpoint(PyObject *self, PyObject *args);
+static PyObject *adc_control_tune(PyObject *self, PyObject *args, PyObject *kwds);
+static PyObject *adc_control_stats(PyObject *self, PyObject *args);
+static PyObject *adc_clock(PyObject *self, PyObject *args);
+static PyObject *adc_log_start(PyObject *self, PyObject *args, PyObject *kwds);
+static PyObject *adc_log_stop(PyObject *self, PyObject *args);
+static PyObject *adc_log_stats(PyObject *self, PyObject *args);
+static PyObject *adc_set_vref(PyObject *self, PyObject *args);
+static PyObject *adc_to_volts(PyObject *self, PyObject *args, PyObject *kwds);
+static PyObject *adc_calibrate(PyObject *self, PyObject *args, PyObject *kwds);
+static PyObject *adc_read_calibration(PyObject *self, PyObject *args);
+static PyObject *adc_set_cal_cache(PyObject *self, PyObject *args);
 
-/* Module specification */
-static PyMethodDef module_methods[] = {
- //   {"chi2", chi2_chi2, METH_VARARGS, chi2_docstring},
+static PyObject *adc_enter(PyObject *self, PyObject *args);
+static PyObject *adc_exit(PyObject *self, PyObject *args);
+
+/* Methods of ADS1256; the module has the same functions (except __enter__/__exit__) on the default board */
+static PyMethodDef adc_methods[] = {
     {"read_channel", adc_read_channel, METH_VARARGS, {"lê o canal especificado do ads1256"}},
-    {"read_all_channels", adc_read_all_channels, METH_VARARGS, {"lê todos os 8 canais do ads1256"}},
-    {"start", adc_start, METH_VARARGS, {"inicia e configura o ads1256"}},
-    {"stop", adc_stop, 0, {"termina e fecha o ads1256"}},
+    {"read_all_channels", (PyCFunction)adc_read_all_channels, METH_VARARGS | METH_KEYWORDS, {"lê todos os canais da lista de varredura (8 canais por padrao); com timestamps=True devolve (valores, tempos)"}},
+    {"read_block", (PyCFunction)adc_read_block, METH_VARARGS | METH_KEYWORDS, {"lê n varreduras para um buffer int32 (n x entradas da lista) ja alocado, e opcionalmente os tempos em int64 ns"}},
+    {"start", (PyCFunction)adc_start, METH_VARARGS | METH_KEYWORDS, {"inicia e configura o ads1256: ganho (1-64), sps (2.5-30000, numero ou texto como '2d5'), clock SPI em Hz (sclk_hz), buffer de entrada, clock de saida no D0 em Hz (clock_out) e corrente do detector de sensor em uA (sensor_detect)"}},
+    {"stop", adc_stop, METH_NOARGS, {"termina e fecha o ads1256"}},
+    {"configure", (PyCFunction)adc_configure, METH_VARARGS | METH_KEYWORDS, {"muda ganho, sps e/ou buffer de entrada sem reiniciar: so os registradores alterados sao reescritos"}},
+    {"start_continuous", adc_start_continuous, METH_VARARGS, {"entra no modo de leitura continua (RDATAC) em um canal fixo"}},
+    {"read_continuous", adc_read_continuous, METH_VARARGS, {"lê n amostras consecutivas no modo continuo"}},
+    {"stop_continuous", adc_stop_continuous, METH_NOARGS, {"sai do modo de leitura continua (SDATAC)"}},
+    {"acq_start", adc_acq_start, METH_VARARGS, {"inicia a thread de aquisicao em segundo plano"}},
+    {"acq_stop", adc_acq_stop, METH_NOARGS, {"para a thread de aquisicao"}},
+    {"acq_drain", adc_acq_drain, METH_VARARGS, {"retira do anel as amostras (t, canal, valor) disponiveis"}},
+    {"acq_peek", adc_acq_peek, METH_VARARGS, {"copia as amostras do anel sem retira-las"}},
+    {"acq_dropped", adc_acq_dropped, METH_NOARGS, {"numero de amostras perdidas com o anel cheio"}},
+    {"log_start", (PyCFunction)adc_log_start, METH_VARARGS | METH_KEYWORDS, {"grava as amostras da aquisicao em arquivos binarios <path>-NNNNNN.ads, com rotacao por tamanho (MB) ou tempo (s)"}},
+    {"log_stop", adc_log_stop, METH_NOARGS, {"para a gravacao e fecha o ultimo arquivo"}},
+    {"log_stats", adc_log_stats, METH_NOARGS, {"bytes e arquivos gravados, amostras perdidas e erros da gravacao"}},
+    {"set_transport", adc_set_transport, METH_VARARGS, {"escolhe o transporte antes do start(): 'bcm2835' (placa) ou 'sim' (ADS1256 simulado); os pinos voltam aos padrao do transporte"}},
+    {"set_drdy_wait", (PyCFunction)adc_set_drdy_wait, METH_VARARGS | METH_KEYWORDS, {"escolhe a espera do DRDY: 'poll' (varredura) ou 'event' (borda via gpiochip) e o timeout em us"}},
+    {"timing", adc_timing, METH_NOARGS, {"clock SPI em uso e atrasos do protocolo derivados do CLKIN"}},
+    {"get_stats", (PyCFunction)adc_get_stats, METH_VARARGS | METH_KEYWORDS, {"contadores de erro: timeouts do DRDY, ressincronizacoes, falhas do ID do chip e o ultimo errno; reset=True zera"}},
+    {"set_scan_list", adc_set_scan_list, METH_VARARGS, {"define a lista de varredura: [(AINP, AINN[, ganho[, repeticoes]]), ...], AINCOM = 8, ganho GAIN_AUTO = faixa automatica; None volta aos 8 canais"}},
+    {"set_filter", (PyCFunction)adc_set_filter, METH_VARARGS | METH_KEYWORDS, {"filtro de uma entrada da lista na aquisicao: 'mavg' (media movel de n), 'cic' (ordem n), 'fir' (taps) ou 'iir' (secoes sos), com decimacao; None desliga"}},
+    {"set_trigger", (PyCFunction)adc_set_trigger, METH_VARARGS | METH_KEYWORDS, {"gatilho da aquisicao numa entrada da lista: 'level', 'edge', 'window' (level a level2) ou 'slope', em contagens; so as janelas de pre + 1 + post amostras vao para o anel e o disco; None desliga"}},
+    {"trigger_arm", adc_trigger_arm, METH_NOARGS, {"arma de novo um gatilho single=True, tambem com a aquisicao rodando"}},
+    {"trigger_read", adc_trigger_read, METH_VARARGS, {"retira ate max janelas (0 = todas) como [(t, pre, [(t, canal, valor), ...]), ...]"}},
+    {"trigger_stats", adc_trigger_stats, METH_NOARGS, {"janelas disparadas, condicoes perdidas com a fila cheia, janelas esperando leitura e se o gatilho esta armado"}},
+    {"dac_write", adc_dac_write, METH_VARARGS, {"escreve um codigo (0-65535) no canal 'A' ou 'B' do DAC8552"}},
+    {"dac_write_volts", adc_dac_write_volts, METH_VARARGS, {"escreve uma tensao de 0 a vref no canal 'A' ou 'B' do DAC8552"}},
+    {"dac_set_vref", adc_dac_set_vref, METH_VARARGS, {"define a referencia do DAC8552 em volts, 5.0 por padrao"}},
+    {"dac_play", (PyCFunction)adc_dac_play, METH_VARARGS | METH_KEYWORDS, {"reproduz um buffer de codigos uint16 a rate quadros/s numa thread propria: channels 'A', 'B' ou 'AB' (A e B intercalados, mudam juntos); loop=True repete ate o proximo dac_queue"}},
+    {"dac_queue", (PyCFunction)adc_dac_queue, METH_VARARGS | METH_KEYWORDS, {"poe na fila o buffer que segue o atual, no fim da passada; wait=True espera a vez dele, senao devolve False com a fila ocupada"}},
+    {"dac_stop", adc_dac_stop, METH_NOARGS, {"para a reproducao; as saidas ficam no ultimo quadro"}},
+    {"dac_stats", adc_dac_stats, METH_NOARGS, {"quadros escritos, atrasados, faltas de buffer, buffers da fila tocados e o estado da reproducao"}},
+    {"set_control", (PyCFunction)adc_set_control, METH_VARARGS | METH_KEYWORDS, {"controle em malha fechada na thread de aquisicao: a cada valor de uma entrada da lista, 'pid' (kp, ki, kd) ou 'filter' (coeficientes b, a sobre o erro) escreve o canal 'A' ou 'B' do DAC; setpoint em contagens; None desliga"}},
+    {"control_setpoint", adc_control_setpoint, METH_VARARGS, {"muda o setpoint do controle (contagens), tambem com a aquisicao rodando"}},
+    {"control_tune", (PyCFunction)adc_control_tune, METH_VARARGS | METH_KEYWORDS, {"muda ganhos, coeficientes, bias e limites do controle, tambem com a aquisicao rodando; os omitidos ficam como estao"}},
+    {"control_stats", adc_control_stats, METH_NOARGS, {"passos, saidas saturadas, ultima medida, erro e saida, latencia do DRDY ao DAC e o setpoint do controle"}},
+    {"gains", adc_gains, METH_NOARGS, {"ganho em que foi convertido o ultimo valor de cada entrada da lista"}},
+    {"set_vref", adc_set_vref, METH_VARARGS, {"define a tensao de referencia (VREFP - VREFN) em volts, 2.5 por padrao"}},
+    {"to_volts", (PyCFunction)adc_to_volts, METH_VARARGS | METH_KEYWORDS, {"converte um bloco int32 para volts em um buffer float32/float64 (ou devolve uma lista), com o ganho de cada entrada da lista ou um ganho fixo"}},
+    {"calibrate", (PyCFunction)adc_calibrate, METH_VARARGS | METH_KEYWORDS, {"calibra nas entradas e ganho de uma entrada da lista: 'self', 'self_offset', 'self_gain', 'system_offset' ou 'system_gain'; devolve OFC e FSC"}},
+    {"read_calibration", adc_read_calibration, METH_NOARGS, {"le os registradores de calibracao OFC e FSC do chip"}},
+    {"set_cal_cache", adc_set_cal_cache, METH_VARARGS, {"arquivo do cache de calibracao por (ganho, sps): o start() usa os coeficientes guardados e desliga a auto-calibracao; None desliga"}},
+    {"__enter__", adc_enter, METH_NOARGS, NULL},
+    {"__exit__", adc_exit, METH_VARARGS, NULL},
     {NULL, NULL, 0, NULL}
 };
 
-/* Initialize the module */
-PyMODINIT_FUNC initads1256(void)
+/* Module functions */
+static PyMethodDef module_methods[] = {
+    {"clock", adc_clock, METH_NOARGS, {"relogio dos tempos das amostras (CLOCK_MONOTONIC_RAW) em segundos"}},
+    {NULL, NULL, 0, NULL}
+};
+
+/* Errors every call on the bus can return. The glue has already resynchronised the chip after
+   a DRDY time out, so the next call may succeed; get_stats() counts them */
+static PyObject *adc_erro(PyObject *self, int err)
+{
+    AdcModuleState *st = adc_estado(self);
+
+    if (err == ETIMEDOUT)
+        PyErr_SetString(st->TimeoutError, "DRDY did not go low within the timeout of set_drdy_wait(): the ADS1256 stopped converting");
+    else if (err == EIO)
+        PyErr_SetString(st->DeviceError, "the ADS1256 does not answer (wrong chip ID): board disconnected or not powered?");
+    else if (err == ENODEV)
+        PyErr_SetString(st->Error, "the ADC is not started, call start() first");
+    else if (err == ETIME)
+        PyErr_SetString(st->Error, "every multiplexer frame came too late to be used: is the machine overloaded? See get_stats()['late']");
+    else {
+        errno = err;
+        PyErr_SetFromErrno(PyExc_OSError);
+    }
+    return NULL;
+}
+
+/* start() and configure() settings: a number, or a string as in the first versions ("16", "2d5").
+   The value is returned in tenths (2.5 -> 25) for the tables of the driver; one that is not a whole
+   number of tenths becomes -1, which no table holds */
+static int arg_decimos(PyObject *o, long int *dec)
 {
-    PyObject *m = Py_InitModule3("ads1256", module_methods, module_docstring);
-    if (m == NULL)
-        return;
+    char texto[32], *fim, *p;
+    double v;
 
+    if (PyUnicode_Check(o)) {
+        strncpy(texto, PyUnicode_AsUTF8(o), sizeof(texto) - 1);
+        texto[sizeof(texto) - 1] = 0;
+        p = strchr(texto, 'd');
+        if (p != NULL)
+            *p = '.';
+        v = strtod(texto, &fim);
+        if ((fim == texto) || (*fim != 0)) {
+            PyErr_Format(PyExc_ValueError, "'%s' is not a number", PyUnicode_AsUTF8(o));
+            return -1;
+        }
+    }
+    else {
+        v = PyFloat_AsDouble(o);
+        if ((v == -1.0) && PyErr_Occurred())
+            return -1;
+    }
+
+    *dec = -1;
+    if ((v >= 0) && (v <= 1e8) && (fabs(v * 10 - floor(v * 10 + 0.5)) < 1e-6))
+        *dec = (long)floor(v * 10 + 0.5);
+    return 0;
+}
+
+static int arg_ganho(PyObject *o, long int *ganho)
+{
+    long int dec;
+
+    if (arg_decimos(o, &dec) != 0)
+        return -1;
+    *ganho = ((dec > 0) && (dec % 10 == 0)) ? dec / 10 : -1;
+    return 0;
 }
-static PyObject *adc_start(PyObject *self, PyObject *args)
+
+static PyObject *adc_start(PyObject *self, PyObject *args, PyObject *kwds)
 {
+    ADS1256_DEV_T *dev;
+    static char *kwlist[] = {"gain", "sps", "sclk_hz", "buffer", "clock_out", "sensor_detect", NULL};
+    PyObject *gain_obj, *sps_obj, *sdcs_obj = NULL;
+    long int ganho, sps, sdcs = 0, sclk = 0, clkout = 0;
+    int buffer = 0;
+    int err;
 
-    char * ganho, *sps;
-    PyObject *yerr_obj;
-    double v[8];
-    int value ;
-                                         
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
 
     /* Parse the input tuple */
-    if (!PyArg_ParseTuple(args, "ss", &ganho, &sps,&yerr_obj))
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO|lilO", kwlist, &gain_obj, &sps_obj, &sclk,
+                                     &buffer, &clkout, &sdcs_obj))
+        return NULL;
+    if ((arg_ganho(gain_obj, &ganho) != 0) || (arg_decimos(sps_obj, &sps) != 0))
+        return NULL;
+    if ((sdcs_obj != NULL) && (arg_decimos(sdcs_obj, &sdcs) != 0))
         return NULL;
 
-    /* execute the code */ 
-    value = adcStart(4,"0",ganho,sps);
+    /* execute the code, other Python threads keep running while the chip settles */ 
+    Py_BEGIN_ALLOW_THREADS
+    err = adcStart(dev, ganho, sps, sclk, buffer, clkout, sdcs);
+    Py_END_ALLOW_THREADS
 
-    /* Build the output tuple */
-    PyObject *ret = Py_BuildValue("i",value);
-    return ret;
+    if (err == EINVAL) {
+        PyErr_SetString(PyExc_ValueError, "invalid setting: gain 1, 2, 4, 8, 16, 32 or 64; sps 2.5, 5, 10, 15, "
+                        "25, 30, 50, 60, 100, 500, 1000, 2000, 3750, 7500, 15000 or 30000; sclk_hz 4000 to 1920000; "
+                        "clock_out 0, 1920000, 3840000 or 7680000; sensor_detect 0, 0.5, 2 or 10 (uA)");
+        return NULL;
+    }
+    if (err == ENODEV) {
+        PyErr_SetString(PyExc_RuntimeError, "the transport did not open (the bcm2835 one needs root)");
+        return NULL;
+    }
+    if (err == EBUSY) {
+        PyErr_SetString(PyExc_RuntimeError, "start() cannot run while the acquisition thread, a group or the DAC "
+                        "playback uses the board: call acq_stop() or dac_stop() first, or use configure()");
+        return NULL;
+    }
+    if (err != 0)
+        return adc_erro(self, err);
+    return Py_BuildValue("i",0);
 }
 
-static PyObject *adc_read_channel(PyObject *self, PyObject *args)
+static PyObject *adc_configure(PyObject *self, PyObject *args, PyObject *kwds)
 {
+    ADS1256_DEV_T *dev;
+    static char *kwlist[] = {"gain", "sps", "buffer", NULL};
+    PyObject *gain_obj = Py_None, *sps_obj = Py_None, *buf_obj = Py_None;
+    long int ganho = 0, sps = 0;
+    int buffer = -1, err;
 
-    int ch;
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple, None keeps the current value */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OOO", kwlist, &gain_obj, &sps_obj, &buf_obj))
+        return NULL;
+    if ((gain_obj != Py_None) && (arg_ganho(gain_obj, &ganho) != 0))
+        return NULL;
+    if ((sps_obj != Py_None) && (arg_decimos(sps_obj, &sps) != 0))
+        return NULL;
+
+    if (buf_obj != Py_None) {
+        buffer = PyObject_IsTrue(buf_obj);
+        if (buffer < 0)
+            return NULL;
+    }
+
+    /* execute the code, a self-calibration takes up to about a second at the slowest rates */
+    Py_BEGIN_ALLOW_THREADS
+    err = adcConfigure(dev, ganho, sps, buffer);
+    Py_END_ALLOW_THREADS
+
+    if (err == EINVAL) {
+        PyErr_SetString(PyExc_ValueError, "gain and sps must be values accepted by start()");
+        return NULL;
+    }
+    if (err == EBUSY) {
+        PyErr_SetString(PyExc_RuntimeError, "cannot configure while the acquisition thread runs");
+        return NULL;
+    }
+    if (err == ETIMEDOUT) {
+        PyErr_SetString(adc_estado(self)->TimeoutError, "the self-calibration did not finish: DRDY timeout");
+        return NULL;
+    }
+    if (err != 0)
+        return adc_erro(self, err);
+    Py_RETURN_NONE;
+}
+
+static PyObject *adc_read_channel(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    int ch, err;
     long int retorno;
-    PyObject *yerr_obj;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
     
 
 
     /* Parse the input tuple */
-    if (!PyArg_ParseTuple(args, "i", &ch,&yerr_obj))
+    if (!PyArg_ParseTuple(args, "i", &ch))
         return NULL;
                                        
 
-    /* execute the code */ 
-    retorno = readChannel(ch);
+    /* execute the code without the GIL, the driver serialises the bus itself */ 
+    Py_BEGIN_ALLOW_THREADS
+    err = readChannel(dev, ch, &retorno);
+    Py_END_ALLOW_THREADS
+
+    if (err == EINVAL) {
+        PyErr_SetString(PyExc_ValueError, "channel is not an entry of the scan list");
+        return NULL;
+    }
+    if (err != 0)
+        return adc_erro(self, err);
     return Py_BuildValue("l",retorno);
 }
 
 
-static PyObject *adc_read_all_channels(PyObject *self, PyObject *args)
+static PyObject *adc_read_all_channels(PyObject *self, PyObject *args, PyObject *kwds)
 {
-    PyObject *yerr_obj;
-    long int v[8];
-                                         
+    ADS1256_DEV_T *dev;
+    static char *kwlist[] = {"timestamps", NULL};
+    long int v[ADS1256_SCAN_MAX];
+    int64_t t[ADS1256_SCAN_MAX];
+    long int n, i;
+    int tempos = 0;
+    PyObject *ret, *tl;
 
-    /* execute the code */ 
-    readChannels(v);
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
 
-    /* Build the output tuple */
-    PyObject *ret = Py_BuildValue("[l,l,l,l,l,l,l,l]",
-	 v[0],
-	 v[1],
-	 v[2],
-	 v[3],
-	 v[4],
-	 v[5],
-	 v[6],
-	 v[7]
-     );
-    return ret;
+    /* Parse the input tuple */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|i", kwlist, &tempos))
+        return NULL;
+
+    /* execute the code without the GIL, the driver serialises the bus itself */ 
+    Py_BEGIN_ALLOW_THREADS
+    n = readChannels(dev, v, t);
+    Py_END_ALLOW_THREADS
+
+    if (n < 0)
+        return adc_erro(self, -n);
+
+    /* Build the output list, one value per scan list entry */
+    ret = PyList_New(n);
+    if (ret == NULL)
+        return NULL;
+    for (i = 0; i < n; i++)
+        PyList_SET_ITEM(ret, i, PyLong_FromLong(v[i]));
+    if (!tempos)
+        return ret;
+
+    /* DRDY time of each value, seconds of ads1256.clock() */
+    tl = PyList_New(n);
+    if (tl == NULL) {
+        Py_DECREF(ret);
+        return NULL;
+    }
+    for (i = 0; i < n; i++)
+        PyList_SET_ITEM(tl, i, PyFloat_FromDouble(t[i] / 1e9));
+    return Py_BuildValue("(NN)", ret, tl);
+}
+
+static PyObject *adc_read_block(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    ADS1256_DEV_T *dev;
+    static char *kwlist[] = {"n", "out", "times", NULL};
+    long int n, ret, count, cap;
+    PyObject *out, *times = Py_None;
+    Py_buffer view, tview;
+    char kind;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "lO|O", kwlist, &n, &out, &times))
+        return NULL;
+
+    if (n < 0) {
+        PyErr_SetString(PyExc_ValueError, "n must not be negative");
+        return NULL;
+    }
+
+    /* bytearray, array.array('i') or a numpy int32 array, written in place */
+    if (PyObject_GetBuffer(out, &view, PyBUF_WRITABLE | PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) != 0)
+        return NULL;
+
+    kind = view.format ? view.format[strlen(view.format) - 1] : 'B';
+    if (!((view.itemsize == 1) || ((view.itemsize == 4) && ((kind == 'i') || (kind == 'l'))))) {
+        PyBuffer_Release(&view);
+        PyErr_SetString(PyExc_TypeError, "buffer must hold int32 items or raw bytes");
+        return NULL;
+    }
+    cap = (long)(view.len / sizeof(int32_t));
+
+    /* optional timestamps: bytearray or array/numpy of int64, same number of items */
+    tview.buf = NULL;
+    if (times != Py_None) {
+        if (PyObject_GetBuffer(times, &tview, PyBUF_WRITABLE | PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) != 0) {
+            PyBuffer_Release(&view);
+            return NULL;
+        }
+        kind = tview.format ? tview.format[strlen(tview.format) - 1] : 'B';
+        if (!((tview.itemsize == 1) || ((tview.itemsize == 8) && ((kind == 'q') || (kind == 'l'))))) {
+            PyBuffer_Release(&tview);
+            PyBuffer_Release(&view);
+            PyErr_SetString(PyExc_TypeError, "times buffer must hold int64 items or raw bytes");
+            return NULL;
+        }
+        if ((long)(tview.len / sizeof(int64_t)) < cap)
+            cap = (long)(tview.len / sizeof(int64_t));
+    }
+
+    /* execute the code without the GIL, the buffers stay exported until released */
+    Py_BEGIN_ALLOW_THREADS
+    ret = readBlock(dev, (int32_t *)view.buf, (int64_t *)tview.buf, n, cap);
+    Py_END_ALLOW_THREADS
+
+    if (tview.buf != NULL)
+        PyBuffer_Release(&tview);
+    PyBuffer_Release(&view);
+
+    if (ret == -EINVAL) {
+        count = scanCount(dev);
+        PyErr_Format(PyExc_ValueError, "buffer too small: %ld scans of %ld entries do not fit in %ld values",
+                     n, count, cap);
+        return NULL;
+    }
+    if (ret == -EBUSY) {
+        PyErr_SetString(PyExc_RuntimeError, "read_block() is not available while the acquisition thread runs");
+        return NULL;
+    }
+    if (ret < 0)
+        return adc_erro(self, -ret);
+    return Py_BuildValue("l",ret);
 }
 
 static PyObject *adc_stop(PyObject *self, PyObject *args)
 {
+    ADS1256_DEV_T *dev;
+    int value;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
     /* execute the code */ 
-    int value = adcStop();
+    Py_BEGIN_ALLOW_THREADS
+    value = adcStop(dev);
+    Py_END_ALLOW_THREADS
 
     /* Build the output tuple */
     PyObject *ret = Py_BuildValue("i",value);
@@ -104,3 +474,2044 @@ static PyObject *adc_stop(PyObject *self, PyObject *args)
 }
 
 
+static PyObject *adc_start_continuous(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    int ch;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTuple(args, "i", &ch))
+        return NULL;
+
+    int value;
+
+    /* execute the code */
+    Py_BEGIN_ALLOW_THREADS
+    value = adcStartContinuous(dev, ch);
+    Py_END_ALLOW_THREADS
+
+    if (value == EINVAL) {
+        PyErr_SetString(PyExc_ValueError, "channel is not an entry of the scan list");
+        return NULL;
+    }
+    if (value == EBUSY) {
+        PyErr_SetString(PyExc_RuntimeError, "continuous mode is not available while the acquisition thread runs");
+        return NULL;
+    }
+    if (value != 0)
+        return adc_erro(self, value);
+    return Py_BuildValue("i",value);
+}
+
+static PyObject *adc_read_continuous(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    long int n, i, ok;
+    long int *v;
+    PyObject *ret;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTuple(args, "l", &n))
+        return NULL;
+
+    if (n < 0) {
+        PyErr_SetString(PyExc_ValueError, "n must not be negative");
+        return NULL;
+    }
+
+    v = PyMem_New(long int, n ? n : 1);
+    if (v == NULL)
+        return PyErr_NoMemory();
+
+    /* execute the code without the GIL */
+    Py_BEGIN_ALLOW_THREADS
+    ok = readContinuous(dev, v, n);
+    Py_END_ALLOW_THREADS
+
+    if (ok == EINVAL) {
+        PyMem_Free(v);
+        PyErr_SetString(PyExc_RuntimeError, "continuous mode is not running, call start_continuous() first");
+        return NULL;
+    }
+    if (ok != 0) {
+        PyMem_Free(v);
+        return adc_erro(self, ok);
+    }
+
+    /* Build the output list */
+    ret = PyList_New(n);
+    if (ret == NULL) {
+        PyMem_Free(v);
+        return NULL;
+    }
+    for (i = 0; i < n; i++)
+        PyList_SET_ITEM(ret, i, PyLong_FromLong(v[i]));
+
+    PyMem_Free(v);
+    return ret;
+}
+
+static PyObject *adc_stop_continuous(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    int value;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* execute the code */
+    Py_BEGIN_ALLOW_THREADS
+    value = adcStopContinuous(dev);
+    Py_END_ALLOW_THREADS
+
+    if (value != 0)
+        return adc_erro(self, value);
+    return Py_BuildValue("i",value);
+}
+
+static PyObject *adc_acq_start(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    long int capacity = 65536;
+    int err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTuple(args, "|l", &capacity))
+        return NULL;
+
+    /* execute the code, it waits for a blocking read of another thread to finish */
+    Py_BEGIN_ALLOW_THREADS
+    err = adcAcqStart(dev, capacity);
+    Py_END_ALLOW_THREADS
+
+    if ((err == ENODEV) || (err == EBUSY))
+        return dac_erro(self, err);    /* the control loop needs the DAC */
+    if (err == EINVAL) {
+        PyErr_SetString(PyExc_ValueError, "capacity must be between 1 and 16777216 samples");
+        return NULL;
+    }
+    if (err != 0) {
+        PyErr_SetString(PyExc_RuntimeError, "could not start the acquisition thread");
+        return NULL;
+    }
+
+    return Py_BuildValue("i",0);
+}
+
+static PyObject *adc_acq_stop(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    int value;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* execute the code, joining the thread may take one conversion */
+    Py_BEGIN_ALLOW_THREADS
+    value = adcAcqStop(dev);
+    Py_END_ALLOW_THREADS
+
+    return Py_BuildValue("i",value);
+}
+
+/* Copy a batch out of the ring and build a list of (t, channel, value) tuples */
+static PyObject *acq_batch(PyObject *self, PyObject *args, int consume)
+{
+    ADS1256_DEV_T *dev;
+    long int max = 0, n, i;
+    ADS1256_SAMPLE_T *v;
+    PyObject *ret;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTuple(args, "|l", &max))
+        return NULL;
+
+    n = acqAvailable(dev);
+    if (n < 0) {
+        PyErr_SetString(PyExc_RuntimeError, "acquisition is not running, call acq_start() first");
+        return NULL;
+    }
+    if ((max > 0) && (n > max))
+        n = max;
+
+    v = PyMem_New(ADS1256_SAMPLE_T, n ? n : 1);
+    if (v == NULL)
+        return PyErr_NoMemory();
+
+    /* execute the code */
+    n = acqRead(dev, v, n, consume);
+
+    /* Build the output list */
+    ret = PyList_New(n < 0 ? 0 : n);
+    if (ret == NULL) {
+        PyMem_Free(v);
+        return NULL;
+    }
+    for (i = 0; i < n; i++)
+        PyList_SET_ITEM(ret, i, Py_BuildValue("(dil)", v[i].TimeNs / 1e9, (int)v[i].Channel, (long)v[i].Value));
+
+    PyMem_Free(v);
+    return ret;
+}
+
+static PyObject *adc_acq_drain(PyObject *self, PyObject *args)
+{
+    return acq_batch(self, args, 1);
+}
+
+static PyObject *adc_acq_peek(PyObject *self, PyObject *args)
+{
+    return acq_batch(self, args, 0);
+}
+
+static PyObject *adc_acq_dropped(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    return Py_BuildValue("l",acqDropped(dev));
+}
+
+static PyObject *adc_set_drdy_wait(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    ADS1256_DEV_T *dev;
+    static char *kwlist[] = {"mode", "timeout_us", "chip", NULL};
+    const char *mode;
+    const char *chip = "/dev/gpiochip0";
+    long int timeout_us = 2000000;
+    int modo, err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|ls", kwlist, &mode, &timeout_us, &chip))
+        return NULL;
+
+    if (strcmp(mode, "poll") == 0)
+        modo = 0;
+    else if (strcmp(mode, "event") == 0)
+        modo = 1;
+    else {
+        PyErr_Format(PyExc_ValueError, "mode must be 'poll' or 'event', not '%s'", mode);
+        return NULL;
+    }
+    if (timeout_us <= 0) {
+        PyErr_SetString(PyExc_ValueError, "timeout_us must be positive");
+        return NULL;
+    }
+
+    /* execute the code */
+    Py_BEGIN_ALLOW_THREADS
+    err = adcSetDrdyWait(dev, modo, timeout_us, chip);
+    Py_END_ALLOW_THREADS
+
+    if (err != 0) {
+        errno = err;
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, (char *)chip);
+    }
+    return Py_BuildValue("i",0);
+}
+
+static PyObject *adc_set_transport(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    const char *name;
+    int err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTuple(args, "s", &name))
+        return NULL;
+
+    /* execute the code */
+    err = adcSetTransport(dev, name);
+
+    if (err == ENOENT) {
+        PyErr_Format(PyExc_ValueError, "unknown transport '%s'", name);
+        return NULL;
+    }
+    if (err != 0) {
+        PyErr_SetString(PyExc_RuntimeError, "the transport can only be changed while the ADC is stopped");
+        return NULL;
+    }
+    return Py_BuildValue("i",0);
+}
+
+static PyObject *adc_timing(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    long int v[4];
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* execute the code */
+    adcGetTiming(dev, v);
+
+    /* Build the output dict */
+    return Py_BuildValue("{s:l,s:l,s:l,s:l}", "sclk_hz", v[0], "t6_us", v[1], "t11_us", v[2], "t11_sync_us", v[3]);
+}
+
+static PyObject *adc_get_stats(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    ADS1256_DEV_T *dev;
+    static char *kwlist[] = {"reset", NULL};
+    long int v[5];
+    int zerar = 0;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|i", kwlist, &zerar))
+        return NULL;
+
+    /* execute the code */
+    adcGetStats(dev, v, zerar);
+
+    /* Build the output dict, last_error is an errno value (errno.errorcode[] names it), 0 if none */
+    return Py_BuildValue("{s:l,s:l,s:l,s:l,s:l}", "timeouts", v[0], "resyncs", v[1], "device_errors", v[2],
+                         "last_error", v[3], "late", v[4]);
+}
+
+static PyObject *adc_set_scan_list(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    PyObject *lista = Py_None, *seq, *item;
+    long int v[ADS1256_SCAN_MAX * 4];
+    Py_ssize_t n, i;
+    int err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTuple(args, "|O", &lista))
+        return NULL;
+
+    n = 0;
+    if (lista != Py_None) {
+        seq = PySequence_Fast(lista, "scan list must be a sequence of (ainp, ainn[, gain[, repeat]]) tuples");
+        if (seq == NULL)
+            return NULL;
+        n = PySequence_Fast_GET_SIZE(seq);
+        if ((n < 1) || (n > ADS1256_SCAN_MAX)) {
+            Py_DECREF(seq);
+            PyErr_Format(PyExc_ValueError, "scan list must have 1 to %d entries", ADS1256_SCAN_MAX);
+            return NULL;
+        }
+        for (i = 0; i < n; i++) {
+            item = PySequence_Fast_GET_ITEM(seq, i);
+            v[i * 4 + 2] = 0;      /* gain of start() */
+            v[i * 4 + 3] = 1;      /* one conversion per pass */
+            if (!PyArg_ParseTuple(item, "ll|ll;scan list entries are (ainp, ainn[, gain[, repeat]])",
+                                  &v[i * 4], &v[i * 4 + 1], &v[i * 4 + 2], &v[i * 4 + 3])) {
+                Py_DECREF(seq);
+                return NULL;
+            }
+        }
+        Py_DECREF(seq);
+    }
+
+    /* execute the code */
+    Py_BEGIN_ALLOW_THREADS
+    err = adcSetScanList(dev, v, n);
+    Py_END_ALLOW_THREADS
+
+    if (err == EINVAL) {
+        PyErr_SetString(PyExc_ValueError, "invalid scan list entry: inputs 0-8 (8 = AINCOM) and different, "
+                        "gain 0, GAIN_AUTO or 1-64 in powers of two, repeat 1-255");
+        return NULL;
+    }
+    if (err == EBUSY) {
+        PyErr_SetString(PyExc_RuntimeError, "the scan list cannot be changed while the acquisition thread runs");
+        return NULL;
+    }
+    if (err != 0)
+        return adc_erro(self, err);
+    return Py_BuildValue("i",0);
+}
+
+static PyObject *adc_gains(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    long int g[ADS1256_SCAN_MAX];
+    long int n, i;
+    PyObject *ret;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* execute the code */
+    Py_BEGIN_ALLOW_THREADS
+    n = adcGains(dev, g);
+    Py_END_ALLOW_THREADS
+
+    ret = PyList_New(n);
+    if (ret == NULL)
+        return NULL;
+    for (i = 0; i < n; i++)
+        PyList_SET_ITEM(ret, i, PyLong_FromLong(g[i]));
+    return ret;
+}
+
+static PyObject *adc_set_filter(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    ADS1256_DEV_T *dev;
+    static char *kwlist[] = {"entry", "kind", "n", "decimation", "coefficients", NULL};
+    static const char *tipos[] = {"none", "mavg", "cic", "fir", "iir", NULL};
+    const char *kind = NULL;
+    long int entry, n = 0, decim = 1;
+    PyObject *coef_obj = Py_None, *seq = NULL, *linha;
+    double *coef = NULL, a0;
+    Py_ssize_t len = 0, i, k, m;
+    int tipo, err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "l|zllO", kwlist, &entry, &kind, &n, &decim, &coef_obj))
+        return NULL;
+
+    tipo = ADS1256_FILTER_NONE;
+    if (kind != NULL) {
+        for (tipo = 0; (tipos[tipo] != NULL) && (strcmp(tipos[tipo], kind) != 0); tipo++);
+        if (tipos[tipo] == NULL) {
+            PyErr_SetString(PyExc_ValueError, "kind must be None, 'mavg', 'cic', 'fir' or 'iir'");
+            return NULL;
+        }
+    }
+
+    /* FIR: the taps; IIR: (b0, b1, b2, a0, a1, a2) sections as scipy.signal returns them, or (b0, b1, b2, a1, a2) */
+    if ((tipo == ADS1256_FILTER_FIR) || (tipo == ADS1256_FILTER_IIR)) {
+        if (coef_obj == Py_None) {
+            PyErr_SetString(PyExc_ValueError, "fir and iir filters need coefficients");
+            return NULL;
+        }
+        seq = PySequence_Fast(coef_obj, "coefficients must be a sequence");
+        if (seq == NULL)
+            return NULL;
+        len = PySequence_Fast_GET_SIZE(seq);
+        if ((len < 1) || (len > ((tipo == ADS1256_FILTER_FIR) ? ADS1256_FILTER_FIR_MAX : ADS1256_FILTER_IIR_MAX))) {
+            Py_DECREF(seq);
+            PyErr_Format(PyExc_ValueError, "a filter takes 1 to %d %s", (tipo == ADS1256_FILTER_FIR) ?
+                         ADS1256_FILTER_FIR_MAX : ADS1256_FILTER_IIR_MAX, (tipo == ADS1256_FILTER_FIR) ? "taps" : "sections");
+            return NULL;
+        }
+        coef = PyMem_New(double, 5 * len);
+        if (coef == NULL) {
+            Py_DECREF(seq);
+            return PyErr_NoMemory();
+        }
+        n = len;
+        for (i = 0; i < len; i++) {
+            if (tipo == ADS1256_FILTER_FIR) {
+                coef[i] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(seq, i));
+                if (PyErr_Occurred())
+                    goto erro;
+                continue;
+            }
+            linha = PySequence_Fast(PySequence_Fast_GET_ITEM(seq, i), "iir sections must be sequences");
+            if (linha == NULL)
+                goto erro;
+            m = PySequence_Fast_GET_SIZE(linha);
+            a0 = 1.0;
+            if ((m == 6) && ((a0 = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(linha, 3))) == 0.0))
+                PyErr_SetString(PyExc_ValueError, "a0 of an iir section must not be 0");
+            else if ((m != 5) && (m != 6))
+                PyErr_SetString(PyExc_ValueError, "iir sections are (b0, b1, b2, a0, a1, a2) or (b0, b1, b2, a1, a2)");
+            for (k = 0; (k < 5) && !PyErr_Occurred(); k++)
+                coef[5 * i + k] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(linha, (m == 6 && k >= 3) ? k + 1 : k)) / a0;
+            Py_DECREF(linha);
+            if (PyErr_Occurred())
+                goto erro;
+        }
+    }
+
+    /* execute the code */
+    Py_BEGIN_ALLOW_THREADS
+    err = adcSetFilter(dev, entry, tipo, n, decim, coef);
+    Py_END_ALLOW_THREADS
+
+    PyMem_Free(coef);
+    Py_XDECREF(seq);
+
+    if (err == EINVAL) {
+        PyErr_Format(PyExc_ValueError, "invalid filter: entry must be in the scan list, decimation 1 to %d, "
+                     "mavg n 1 to %d, cic n (order) 1 to %d with decimation^n up to 2^32",
+                     ADS1256_FILTER_DECIM_MAX, ADS1256_FILTER_MAVG_MAX, ADS1256_FILTER_CIC_ORDER_MAX);
+        return NULL;
+    }
+    if (err == EBUSY) {
+        PyErr_SetString(PyExc_RuntimeError, "filters cannot be changed while the acquisition thread runs");
+        return NULL;
+    }
+    if (err != 0) {
+        errno = err;
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+    Py_RETURN_NONE;
+
+erro:
+    PyMem_Free(coef);
+    Py_DECREF(seq);
+    return NULL;
+}
+
+static PyObject *adc_set_trigger(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    ADS1256_DEV_T *dev;
+    static char *kwlist[] = {"entry", "kind", "level", "direction", "pre", "post", "level2", "single", NULL};
+    static const char *tipos[] = {"none", "level", "edge", "window", "slope", NULL};
+    static const char *sentidos[] = {"", "rising", "falling", "both", NULL};
+    static const char *janela[] = {"", "leave", "enter", "both", NULL};
+    PyObject *entry_obj;
+    const char *kind = "edge", *direction = NULL;
+    long int entry = 0, level = 0, level2 = 0, pre = 0, post = 0;
+    int single = 0, tipo = ADS1256_TRIGGER_NONE, sentido = ADS1256_TRIGGER_UP, err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple, set_trigger(None) turns the trigger off */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|slzllli", kwlist, &entry_obj, &kind, &level, &direction,
+                                     &pre, &post, &level2, &single))
+        return NULL;
+
+    if (entry_obj != Py_None) {
+        entry = PyLong_AsLong(entry_obj);
+        if ((entry == -1) && PyErr_Occurred())
+            return NULL;
+        for (tipo = 0; (tipos[tipo] != NULL) && (strcmp(tipos[tipo], kind) != 0); tipo++);
+        if ((tipos[tipo] == NULL) || (tipo == ADS1256_TRIGGER_NONE)) {
+            PyErr_SetString(PyExc_ValueError, "kind must be 'level', 'edge', 'window' or 'slope'");
+            return NULL;
+        }
+
+        /* rising/falling, or leave/enter for a window; level takes no 'both' */
+        if (direction != NULL) {
+            for (sentido = 1; (sentidos[sentido] != NULL) && (strcmp(sentidos[sentido], direction) != 0) &&
+                 (strcmp(janela[sentido], direction) != 0); sentido++);
+            if ((sentidos[sentido] == NULL) || ((tipo == ADS1256_TRIGGER_LEVEL) && (sentido == ADS1256_TRIGGER_BOTH))) {
+                PyErr_SetString(PyExc_ValueError, "direction must be 'rising', 'falling' or 'both' ('leave', 'enter' "
+                                "or 'both' for a window; no 'both' for a level)");
+                return NULL;
+            }
+        }
+    }
+
+    /* execute the code */
+    Py_BEGIN_ALLOW_THREADS
+    err = adcSetTrigger(dev, entry, tipo, sentido, level, level2, pre, post, single);
+    Py_END_ALLOW_THREADS
+
+    if (err == EINVAL) {
+        PyErr_Format(PyExc_ValueError, "invalid trigger: entry must be in the scan list, pre 0 to %u, post >= 0, "
+                     "levels within 32 bits and a slope above 0", ADS1256_TRIGGER_PRE_MAX);
+        return NULL;
+    }
+    if (err == EBUSY) {
+        PyErr_SetString(PyExc_RuntimeError, "the trigger cannot be changed while the acquisition thread runs");
+        return NULL;
+    }
+    if (err != 0) {
+        errno = err;
+        return PyErr_SetFromErrno(PyExc_OSError);
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *adc_trigger_arm(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    if (adcTriggerArm(dev) != 0) {
+        PyErr_SetString(PyExc_RuntimeError, "no trigger set, call set_trigger() first");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+/* Windows as a list of (t, pre, [(t, channel, value), ...]), t of the trigger sample in seconds */
+static PyObject *adc_trigger_read(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    ADS1256_WINDOW_T w;
+    ADS1256_SAMPLE_T *v = NULL;
+    long int max = 0, cap = 0, n, i;
+    PyObject *ret, *amostras, *janela;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTuple(args, "|l", &max))
+        return NULL;
+
+    if (trigPending(dev, &w) < 0) {
+        PyErr_SetString(PyExc_RuntimeError, "acquisition is not running, call acq_start() first");
+        return NULL;
+    }
+
+    ret = PyList_New(0);
+    while ((ret != NULL) && ((max <= 0) || (PyList_GET_SIZE(ret) < max)) && (trigPending(dev, &w) > 0)) {
+        if ((long int)w.Count > cap) {
+            PyMem_Free(v);
+            cap = w.Count;
+            v = PyMem_New(ADS1256_SAMPLE_T, cap);
+            if (v == NULL) {
+                Py_CLEAR(ret);
+                PyErr_NoMemory();
+                break;
+            }
+        }
+
+        /* execute the code */
+        n = trigRead(dev, &w, v, cap);
+        if (n < 0)
+            break;
+
+        /* Build the window */
+        amostras = PyList_New(n);
+        if (amostras == NULL) {
+            Py_CLEAR(ret);
+            break;
+        }
+        for (i = 0; i < n; i++)
+            PyList_SET_ITEM(amostras, i, Py_BuildValue("(dil)", v[i].TimeNs / 1e9, (int)v[i].Channel, (long)v[i].Value));
+        janela = Py_BuildValue("(dlN)", w.TimeNs / 1e9, (long)w.Pre, amostras);
+        if ((janela == NULL) || (PyList_Append(ret, janela) < 0))
+            Py_CLEAR(ret);
+        Py_XDECREF(janela);
+    }
+
+    PyMem_Free(v);
+    return ret;
+}
+
+static PyObject *adc_trigger_stats(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    long int v[4];
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* execute the code */
+    trigStats(dev, v);
+
+    /* Build the output dict */
+    return Py_BuildValue("{s:l,s:l,s:l,s:O}", "fired", v[0], "missed", v[1], "waiting", v[2],
+                         "armed", v[3] ? Py_True : Py_False);
+}
+
+/* 'A' or 'B', ADS1256_DAC_A / _B; 'AB' too when both is set. 0 with a ValueError if not */
+static int dac_canal(const char *nome, int ambos)
+{
+    if (strcmp(nome, "A") == 0)
+        return ADS1256_DAC_A;
+    if (strcmp(nome, "B") == 0)
+        return ADS1256_DAC_B;
+    if (ambos && (strcmp(nome, "AB") == 0))
+        return ADS1256_DAC_AB;
+    PyErr_SetString(PyExc_ValueError, ambos ? "channels must be 'A', 'B' or 'AB'" : "channel must be 'A' or 'B'");
+    return 0;
+}
+
+static PyObject *dac_erro(PyObject *self, int err)
+{
+    if (err == ENODEV)
+        return adc_erro(self, err);    /* also when the board was created without a DAC */
+    if (err == EBUSY) {
+        PyErr_SetString(PyExc_RuntimeError, "the DAC is in use: a buffer is playing (dac_stop()) or the control loop "
+                        "drives it (acq_stop())");
+        return NULL;
+    }
+    if (err == ESRCH) {
+        PyErr_SetString(PyExc_RuntimeError, "the DAC is not playing, call dac_play() first");
+        return NULL;
+    }
+    errno = err;
+    return PyErr_SetFromErrno(PyExc_OSError);
+}
+
+/* Codes of dac_play() and dac_queue(): any buffer of uint16 ('H'), or raw bytes in native order */
+static int dac_buffer(PyObject *o, Py_buffer *view)
+{
+    char kind;
+
+    if (PyObject_GetBuffer(o, view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) != 0)
+        return -1;
+    kind = view->format ? view->format[strlen(view->format) - 1] : 'B';
+    if (!(((view->itemsize == 1) && (view->len % 2 == 0)) || ((view->itemsize == 2) && (kind == 'H')))) {
+        PyErr_SetString(PyExc_TypeError, "the codes must be a buffer of uint16 ('H'), or bytes of an even length");
+        PyBuffer_Release(view);
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject *adc_dac_write(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    const char *nome;
+    long int codigo;
+    int canal, err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTuple(args, "sl", &nome, &codigo))
+        return NULL;
+    if ((canal = dac_canal(nome, 0)) == 0)
+        return NULL;
+    if ((codigo < 0) || (codigo > 65535)) {
+        PyErr_SetString(PyExc_ValueError, "the DAC8552 takes codes of 0 to 65535");
+        return NULL;
+    }
+
+    /* execute the code */
+    Py_BEGIN_ALLOW_THREADS
+    err = dacWrite(dev, canal, codigo);
+    Py_END_ALLOW_THREADS
+
+    if (err != 0)
+        return dac_erro(self, err);
+    Py_RETURN_NONE;
+}
+
+static PyObject *adc_dac_write_volts(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    const char *nome;
+    double volts;
+    long int codigo;
+    int canal, err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTuple(args, "sd", &nome, &volts))
+        return NULL;
+    if ((canal = dac_canal(nome, 0)) == 0)
+        return NULL;
+    if (dacVolts(dev, volts, &codigo) != 0) {
+        PyErr_SetString(PyExc_ValueError, "the DAC8552 outputs 0 V to its reference, see dac_set_vref()");
+        return NULL;
+    }
+
+    /* execute the code */
+    Py_BEGIN_ALLOW_THREADS
+    err = dacWrite(dev, canal, codigo);
+    Py_END_ALLOW_THREADS
+
+    if (err != 0)
+        return dac_erro(self, err);
+    return PyLong_FromLong(codigo);
+}
+
+static PyObject *adc_dac_set_vref(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    double volts;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTuple(args, "d", &volts))
+        return NULL;
+
+    if (dacSetVref(dev, volts) != 0) {
+        PyErr_SetString(PyExc_ValueError, "the DAC8552 accepts a reference above 0 and up to 5.5 V");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *adc_dac_play(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    ADS1256_DEV_T *dev;
+    static char *kwlist[] = {"codes", "rate", "channels", "loop", NULL};
+    PyObject *codes;
+    Py_buffer view;
+    const char *nome = "A";
+    double rate;
+    int canal, loop = 0, err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "Od|sp", kwlist, &codes, &rate, &nome, &loop))
+        return NULL;
+    if ((canal = dac_canal(nome, 1)) == 0)
+        return NULL;
+    if (dac_buffer(codes, &view) != 0)
+        return NULL;
+
+    /* execute the code: the codes are copied, the buffer may be reused at once */
+    Py_BEGIN_ALLOW_THREADS
+    err = dacPlay(dev, view.buf, view.len / 2, canal, rate, loop);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&view);
+
+    if (err == EINVAL) {
+        PyErr_Format(PyExc_ValueError, "rate must be above 0 and up to %d frames/s, with at least one frame "
+                     "(pairs of codes for 'AB')", ADS1256_DAC_RATE_MAX);
+        return NULL;
+    }
+    if (err != 0)
+        return dac_erro(self, err);
+    Py_RETURN_NONE;
+}
+
+static PyObject *adc_dac_queue(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    ADS1256_DEV_T *dev;
+    static char *kwlist[] = {"codes", "wait", NULL};
+    PyObject *codes;
+    Py_buffer view;
+    int wait = 1, err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|p", kwlist, &codes, &wait))
+        return NULL;
+    if (dac_buffer(codes, &view) != 0)
+        return NULL;
+
+    /* execute the code, waiting for the slot may take a whole pass of the buffer playing */
+    Py_BEGIN_ALLOW_THREADS
+    err = dacQueue(dev, view.buf, view.len / 2, wait);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&view);
+
+    if (err == EAGAIN)
+        Py_RETURN_FALSE;
+    if (err == EINVAL) {
+        PyErr_SetString(PyExc_ValueError, "the buffer needs at least one frame, pairs of codes for 'AB'");
+        return NULL;
+    }
+    if (err != 0)
+        return dac_erro(self, err);
+    Py_RETURN_TRUE;
+}
+
+static PyObject *adc_dac_stop(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* execute the code, the thread ends after its current frame */
+    Py_BEGIN_ALLOW_THREADS
+    dacStop(dev);
+    Py_END_ALLOW_THREADS
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *adc_dac_stats(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    long int v[10];
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* execute the code */
+    Py_BEGIN_ALLOW_THREADS
+    dacStats(dev, v);
+    Py_END_ALLOW_THREADS
+
+    /* Build the output dict */
+    return Py_BuildValue("{s:l,s:l,s:l,s:l,s:O,s:O,s:O,s:O,s:(ll)}", "frames", v[0], "late", v[1], "underruns", v[2],
+                         "buffers", v[3], "queued", v[4] ? Py_True : Py_False, "starved", v[5] ? Py_True : Py_False,
+                         "realtime", v[6] ? Py_True : Py_False, "playing", v[7] ? Py_True : Py_False,
+                         "codes", v[8], v[9]);
+}
+
+/* b and a of the coefficient filter as scipy.signal gives them, a0 first: both are divided by a0 */
+static int ctl_coef(PyObject *b_obj, PyObject *a_obj, ADS1256_CONTROL_PARAM_T *p)
+{
+    PyObject *b, *a = NULL;
+    Py_ssize_t i, nb, na = 1;
+    double a0 = 1.0;
+
+    b = PySequence_Fast(b_obj, "b must be a sequence");
+    if ((b == NULL) || ((a_obj != Py_None) && ((a = PySequence_Fast(a_obj, "a must be a sequence")) == NULL))) {
+        Py_XDECREF(b);
+        return -1;
+    }
+    nb = PySequence_Fast_GET_SIZE(b);
+    if (a != NULL) {
+        na = PySequence_Fast_GET_SIZE(a);
+        if (na > 0)
+            a0 = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(a, 0));
+    }
+    if (!PyErr_Occurred() && ((nb < 1) || (nb > ADS1256_CONTROL_ORDER_MAX + 1) || (na < 1) ||
+                              (na > ADS1256_CONTROL_ORDER_MAX + 1) || (a0 == 0)))
+        PyErr_Format(PyExc_ValueError, "b and a take 1 to %d coefficients, a[0] not 0", ADS1256_CONTROL_ORDER_MAX + 1);
+
+    for (i = 0; (i < nb) && !PyErr_Occurred(); i++)
+        p->B[i] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(b, i)) / a0;
+    for (i = 1; (i < na) && !PyErr_Occurred(); i++)
+        p->A[i] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(a, i)) / a0;
+    p->NB = nb;
+    p->NA = na - 1;
+
+    Py_DECREF(b);
+    Py_XDECREF(a);
+    return PyErr_Occurred() ? -1 : 0;
+}
+
+/* Gains, bias and limits given (not NULL) over those in p */
+static int ctl_valores(PyObject **obj, ADS1256_CONTROL_PARAM_T *p)
+{
+    double *dest[6] = {&p->Kp, &p->Ki, &p->Kd, &p->Bias, &p->OutMin, &p->OutMax};
+    double v;
+    int i;
+
+    for (i = 0; i < 6; i++) {
+        if (obj[i] == NULL)
+            continue;
+        v = PyFloat_AsDouble(obj[i]);
+        if ((v == -1.0) && PyErr_Occurred())
+            return -1;
+        *dest[i] = v;
+    }
+    return 0;
+}
+
+static PyObject *ctl_erro(PyObject *self, int err)
+{
+    if (err == EINVAL) {
+        PyErr_SetString(PyExc_ValueError, "invalid control loop: entry must be in the scan list, gains and coefficients "
+                        "finite, 0 <= out_min <= out_max <= 65535 and the setpoint within 32 bits");
+        return NULL;
+    }
+    if (err == EBUSY) {
+        PyErr_SetString(PyExc_RuntimeError, "the control loop cannot be set up while the acquisition thread runs");
+        return NULL;
+    }
+    if (err == ESRCH) {
+        PyErr_SetString(PyExc_RuntimeError, "no control loop set, call set_control() first");
+        return NULL;
+    }
+    if (err == ENODEV) {
+        PyErr_SetString(PyExc_RuntimeError, "the board has no DAC, see the dac_cs argument of ADS1256()");
+        return NULL;
+    }
+    errno = err;
+    return PyErr_SetFromErrno(PyExc_OSError);
+}
+
+static PyObject *adc_set_control(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    ADS1256_DEV_T *dev;
+    static char *kwlist[] = {"entry", "channel", "kind", "setpoint", "kp", "ki", "kd", "b", "a", "bias", "out_min",
+                             "out_max", NULL};
+    ADS1256_CONTROL_PARAM_T p;
+    PyObject *entry_obj, *b_obj = Py_None, *a_obj = Py_None;
+    PyObject *val[6] = {NULL, NULL, NULL, NULL, NULL, NULL};
+    const char *nome = "A", *kind = "pid";
+    long int entry = 0, setpoint = 0;
+    int tipo = ADS1256_CONTROL_NONE, canal = ADS1256_DAC_A, err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple, set_control(None) turns the loop off */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|sslOOOOOOOO", kwlist, &entry_obj, &nome, &kind, &setpoint,
+                                     &val[0], &val[1], &val[2], &b_obj, &a_obj, &val[3], &val[4], &val[5]))
+        return NULL;
+
+    memset(&p, 0, sizeof(p));
+    p.OutMax = 65535;
+    if (entry_obj != Py_None) {
+        entry = PyLong_AsLong(entry_obj);
+        if ((entry == -1) && PyErr_Occurred())
+            return NULL;
+        if ((canal = dac_canal(nome, 0)) == 0)
+            return NULL;
+        if (strcmp(kind, "pid") == 0)
+            tipo = ADS1256_CONTROL_PID;
+        else if (strcmp(kind, "filter") == 0)
+            tipo = ADS1256_CONTROL_FILTER;
+        else {
+            PyErr_SetString(PyExc_ValueError, "kind must be 'pid' or 'filter'");
+            return NULL;
+        }
+        if ((tipo == ADS1256_CONTROL_FILTER) && (b_obj == Py_None)) {
+            PyErr_SetString(PyExc_ValueError, "a 'filter' loop needs its coefficients b (and a)");
+            return NULL;
+        }
+        if ((b_obj != Py_None) && (ctl_coef(b_obj, a_obj, &p) != 0))
+            return NULL;
+        if (ctl_valores(val, &p) != 0)
+            return NULL;
+    }
+
+    /* execute the code */
+    Py_BEGIN_ALLOW_THREADS
+    err = adcSetControl(dev, entry, tipo, canal, setpoint, &p);
+    Py_END_ALLOW_THREADS
+
+    if (err != 0)
+        return ctl_erro(self, err);
+    Py_RETURN_NONE;
+}
+
+static PyObject *adc_control_setpoint(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    long int setpoint;
+    int err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTuple(args, "l", &setpoint))
+        return NULL;
+
+    /* execute the code */
+    err = controlSetpoint(dev, setpoint);
+    if (err != 0)
+        return ctl_erro(self, err);
+    Py_RETURN_NONE;
+}
+
+static PyObject *adc_control_tune(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    ADS1256_DEV_T *dev;
+    static char *kwlist[] = {"kp", "ki", "kd", "b", "a", "bias", "out_min", "out_max", NULL};
+    ADS1256_CONTROL_PARAM_T p;
+    PyObject *b_obj = Py_None, *a_obj = Py_None;
+    PyObject *val[6] = {NULL, NULL, NULL, NULL, NULL, NULL};
+    long int info[3];
+    int err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple, what is not given stays as it is */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|$OOOOOOOO", kwlist, &val[0], &val[1], &val[2], &b_obj, &a_obj,
+                                     &val[3], &val[4], &val[5]))
+        return NULL;
+
+    if (controlParam(dev, &p, info) == ADS1256_CONTROL_NONE)
+        return ctl_erro(self, ESRCH);
+    if ((b_obj != Py_None) && (ctl_coef(b_obj, a_obj, &p) != 0))
+        return NULL;
+    if (ctl_valores(val, &p) != 0)
+        return NULL;
+
+    /* execute the code */
+    err = controlTune(dev, &p);
+    if (err != 0)
+        return ctl_erro(self, err);
+    Py_RETURN_NONE;
+}
+
+static PyObject *adc_control_stats(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    long int v[9];
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* execute the code */
+    Py_BEGIN_ALLOW_THREADS
+    controlStats(dev, v);
+    Py_END_ALLOW_THREADS
+
+    /* Build the output dict, latencies in us */
+    return Py_BuildValue("{s:l,s:l,s:l,s:l,s:l,s:d,s:d,s:l,s:O}", "iterations", v[0], "saturated", v[1],
+                         "measured", v[2], "error", v[3], "output", v[4], "latency_us", v[5] / 1e3,
+                         "max_latency_us", v[6] / 1e3, "setpoint", v[7], "running", v[8] ? Py_True : Py_False);
+}
+
+static PyObject *adc_clock(PyObject *self, PyObject *args)
+{
+    return PyFloat_FromDouble(adcClock() / 1e9);
+}
+
+static PyObject *adc_log_start(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    ADS1256_DEV_T *dev;
+    static char *kwlist[] = {"path", "rotate_mb", "rotate_s", "direct", "buffer_kb", "capacity", NULL};
+    const char *path;
+    long int rotate_mb = 0, rotate_s = 0, buffer_kb = 1024, capacity = 65536;
+    int direct = 0, err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|llill", kwlist, &path, &rotate_mb, &rotate_s, &direct, &buffer_kb, &capacity))
+        return NULL;
+
+    /* execute the code */
+    Py_BEGIN_ALLOW_THREADS
+    err = adcLogStart(dev, path, rotate_mb, rotate_s, direct, buffer_kb, capacity);
+    Py_END_ALLOW_THREADS
+
+    if (err == EINVAL) {
+        PyErr_SetString(PyExc_ValueError, "rotate_mb and rotate_s must not be negative, buffer_kb must be positive and capacity between 1 and 16777216");
+        return NULL;
+    }
+    if (err == EBUSY) {
+        PyErr_SetString(PyExc_RuntimeError, "the logger is already running, call log_stop() first");
+        return NULL;
+    }
+    if (err == ESRCH) {
+        PyErr_SetString(PyExc_RuntimeError, "acquisition is not running, call acq_start() first");
+        return NULL;
+    }
+    if (err != 0) {
+        errno = err;
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, (char *)path);
+    }
+    return Py_BuildValue("i",0);
+}
+
+static PyObject *adc_log_stop(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    int value;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* execute the code, the writer drains its ring before the last file is closed */
+    Py_BEGIN_ALLOW_THREADS
+    value = adcLogStop(dev);
+    Py_END_ALLOW_THREADS
+    return Py_BuildValue("i",value);
+}
+
+static PyObject *adc_log_stats(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    long int v[6];
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* execute the code */
+    logStats(dev, v);
+
+    /* Build the output dict */
+    return Py_BuildValue("{s:l,s:l,s:l,s:l,s:l,s:O}", "bytes", v[0], "files", v[1], "dropped", v[2],
+                         "errors", v[3], "errno", v[4], "running", v[5] ? Py_True : Py_False);
+}
+
+static PyObject *adc_set_vref(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    double volts;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTuple(args, "d", &volts))
+        return NULL;
+
+    if (adcSetVref(dev, volts) != 0) {
+        PyErr_SetString(PyExc_ValueError, "the ADS1256 accepts a reference of 0.5 to 2.6 V");
+        return NULL;
+    }
+    return Py_BuildValue("i",0);
+}
+
+static PyObject *adc_to_volts(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    ADS1256_DEV_T *dev;
+    static char *kwlist[] = {"counts", "out", "gain", NULL};
+    PyObject *counts, *out = Py_None, *ret = NULL;
+    long int gain = 0, slots, period, n, i;
+    Py_buffer view, oview;
+    double *scale = NULL, *tmp = NULL;
+    float *scalef = NULL;
+    char kind, okind = 'd';
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|Ol", kwlist, &counts, &out, &gain))
+        return NULL;
+
+    /* int32 results as read_block() leaves them: bytearray, array.array('i'), numpy int32 */
+    if (PyObject_GetBuffer(counts, &view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) != 0)
+        return NULL;
+    kind = view.format ? view.format[strlen(view.format) - 1] : 'B';
+    if (!((view.itemsize == 1) || ((view.itemsize == 4) && ((kind == 'i') || (kind == 'l'))))) {
+        PyBuffer_Release(&view);
+        PyErr_SetString(PyExc_TypeError, "counts must hold int32 items or raw bytes");
+        return NULL;
+    }
+    n = (long)(view.len / sizeof(int32_t));
+
+    oview.buf = NULL;
+    if (out != Py_None) {
+        if (PyObject_GetBuffer(out, &oview, PyBUF_WRITABLE | PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) != 0)
+            goto done;
+        okind = oview.format ? oview.format[strlen(oview.format) - 1] : 'B';
+        if (!(((oview.itemsize == 4) && (okind == 'f')) || ((oview.itemsize == 8) && (okind == 'd')))) {
+            PyErr_SetString(PyExc_TypeError, "out must hold float32 or float64 items");
+            goto done;
+        }
+        if (oview.len / oview.itemsize < n) {
+            PyErr_Format(PyExc_ValueError, "out too small: %ld values need %ld items", n, n);
+            goto done;
+        }
+    }
+
+    /* volts per count of each slot, repeated to a pattern long enough for the vector loop */
+    scale = malloc(ADS1256_SLOT_MAX * sizeof(double));
+    if (scale == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+    slots = voltScales(dev, scale, gain);
+    if (slots < 0) {
+        PyErr_SetString(PyExc_ValueError, "gain must be 0 (the scan list gains) or 1, 2, 4, 8, 16, 32, 64");
+        goto done;
+    }
+    if (slots == 0) {
+        PyErr_SetString(PyExc_RuntimeError, "no scan list yet: call start() first or give the gain");
+        goto done;
+    }
+    period = slots * ((256 + slots - 1) / slots);
+    tmp = realloc(scale, period * sizeof(double));
+    if (tmp == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+    scale = tmp;
+    tmp = NULL;
+    for (i = slots; i < period; i++)
+        scale[i] = scale[i - slots];
+
+    if (okind == 'f') {
+        scalef = malloc(period * sizeof(float));
+        if (scalef == NULL) {
+            PyErr_NoMemory();
+            goto done;
+        }
+        for (i = 0; i < period; i++)
+            scalef[i] = (float)scale[i];
+        Py_BEGIN_ALLOW_THREADS
+        ADS1256_CountsToVoltsF32((const int32_t *)view.buf, (float *)oview.buf, n, scalef, period);
+        Py_END_ALLOW_THREADS
+        ret = Py_BuildValue("l", n);
+        goto done;
+    }
+
+    /* float64 into out, or into a temporary block that becomes a list */
+    tmp = (out != Py_None) ? (double *)oview.buf : malloc(n * sizeof(double) + 1);
+    if (tmp == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    ADS1256_CountsToVoltsF64((const int32_t *)view.buf, tmp, n, scale, period);
+    Py_END_ALLOW_THREADS
+
+    if (out != Py_None) {
+        tmp = NULL;
+        ret = Py_BuildValue("l", n);
+        goto done;
+    }
+    ret = PyList_New(n);
+    if (ret == NULL)
+        goto done;
+    for (i = 0; i < n; i++)
+        PyList_SET_ITEM(ret, i, PyFloat_FromDouble(tmp[i]));
+
+done:
+    if (out == Py_None)
+        free(tmp);
+    free(scalef);
+    free(scale);
+    if (oview.buf != NULL)
+        PyBuffer_Release(&oview);
+    PyBuffer_Release(&view);
+    return ret;
+}
+
+static PyObject *adc_calibrate(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    ADS1256_DEV_T *dev;
+    static char *kwlist[] = {"kind", "entry", NULL};
+    static const char *tipos[] = {"self", "self_offset", "self_gain", "system_offset", "system_gain", NULL};
+    const char *kind = "self";
+    long int entry = 0, coef[2];
+    int tipo, err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|sl", kwlist, &kind, &entry))
+        return NULL;
+
+    for (tipo = 0; (tipos[tipo] != NULL) && (strcmp(tipos[tipo], kind) != 0); tipo++);
+    if (tipos[tipo] == NULL) {
+        PyErr_SetString(PyExc_ValueError, "kind must be 'self', 'self_offset', 'self_gain', 'system_offset' or 'system_gain'");
+        return NULL;
+    }
+
+    /* execute the code, a calibration takes up to about a second at the slowest rates */
+    Py_BEGIN_ALLOW_THREADS
+    err = adcCalibrate(dev, tipo, entry, coef);
+    Py_END_ALLOW_THREADS
+
+    if (err == EINVAL) {
+        PyErr_SetString(PyExc_ValueError, "entry is not in the scan list");
+        return NULL;
+    }
+    if (err == EBUSY) {
+        PyErr_SetString(PyExc_RuntimeError, "cannot calibrate while the acquisition thread runs");
+        return NULL;
+    }
+    if (err == ETIMEDOUT) {
+        PyErr_SetString(adc_estado(self)->TimeoutError, "the calibration did not finish: DRDY timeout");
+        return NULL;
+    }
+    if (err != 0)
+        return adc_erro(self, err);
+    return Py_BuildValue("{s:l,s:l}", "ofc", coef[0], "fsc", coef[1]);
+}
+
+static PyObject *adc_read_calibration(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    long int coef[2];
+    int err;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* execute the code */
+    Py_BEGIN_ALLOW_THREADS
+    err = adcReadCal(dev, coef);
+    Py_END_ALLOW_THREADS
+
+    if (err == EBUSY) {
+        PyErr_SetString(PyExc_RuntimeError, "the registers cannot be read while the acquisition thread or continuous mode runs");
+        return NULL;
+    }
+    if (err != 0)
+        return adc_erro(self, err);
+    return Py_BuildValue("{s:l,s:l}", "ofc", coef[0], "fsc", coef[1]);
+}
+
+static PyObject *adc_set_cal_cache(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev;
+    const char *path = NULL;
+    int n;
+
+    dev = adc_dev(self);
+    if (dev == NULL)
+        return NULL;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTuple(args, "z", &path))
+        return NULL;
+
+    /* execute the code */
+    Py_BEGIN_ALLOW_THREADS
+    n = adcSetCalCache(dev, path);
+    Py_END_ALLOW_THREADS
+
+    if (n < 0) {
+        errno = -n;
+        return PyErr_SetFromErrnoWithFilename(PyExc_OSError, (char *)path);
+    }
+    return Py_BuildValue("i", n);
+}
+
+static PyObject *adc_enter(PyObject *self, PyObject *args)
+{
+    Py_INCREF(self);
+    return self;
+}
+
+/* with ads1256.ADS1256(...) as adc: stops the board (threads, logger and transport) at the end */
+static PyObject *adc_exit(PyObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev = ((AdcObject *)self)->Dev;
+
+    Py_BEGIN_ALLOW_THREADS
+    adcStop(dev);
+    Py_END_ALLOW_THREADS
+    Py_RETURN_FALSE;
+}
+
+/* The board a call acts on: the ADS1256 object itself, or for a module function the default board */
+static AdcModuleState *adc_estado(PyObject *self)
+{
+    if (PyModule_Check(self))
+        return (AdcModuleState *)PyModule_GetState(self);
+    return (AdcModuleState *)PyModule_GetState(((AdcObject *)self)->Modulo);
+}
+
+static ADS1256_DEV_T *adc_dev(PyObject *self)
+{
+    AdcModuleState *st;
+
+    if (!PyModule_Check(self))
+        return ((AdcObject *)self)->Dev;
+
+    st = adc_estado(self);
+    if (st->Default == NULL) {
+        st->Default = PyObject_CallObject(st->AdcType, NULL);
+        if (st->Default == NULL)
+            return NULL;
+    }
+    return ((AdcObject *)st->Default)->Dev;
+}
+
+static struct PyModuleDef adc_module;
+
+static PyObject *Adc_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"cs", "drdy", "transport", "dac_cs", NULL};
+    PyObject *cs_obj = Py_None, *drdy_obj = Py_None, *dac_obj = Py_None, *modulo = NULL, *m;
+    const char *transporte = NULL;
+    long int cs = -1, drdy = -1, dac = -1;
+    AdcObject *self;
+    Py_ssize_t i;
+
+    /* Parse the input tuple, None = the pins of the first board of the transport */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OOzO", kwlist, &cs_obj, &drdy_obj, &transporte, &dac_obj))
+        return NULL;
+    if ((cs_obj != Py_None) && ((cs = PyLong_AsLong(cs_obj)) == -1) && PyErr_Occurred())
+        return NULL;
+    if ((drdy_obj != Py_None) && ((drdy = PyLong_AsLong(drdy_obj)) == -1) && PyErr_Occurred())
+        return NULL;
+    if ((dac_obj != Py_None) && ((dac = PyLong_AsLong(dac_obj)) == -1) && PyErr_Occurred())
+        return NULL;
+    if (((cs_obj != Py_None) && (cs < 0)) || ((drdy_obj != Py_None) && (drdy < 0)) || ((dac_obj != Py_None) && (dac < 0)) ||
+        (cs > INT_MAX) || (drdy > INT_MAX) || (dac > INT_MAX)) {
+        PyErr_SetString(PyExc_ValueError, "cs, drdy and dac_cs are pin numbers of the transport");
+        return NULL;
+    }
+
+    /* The module of the type, also when it is subclassed in Python */
+    for (i = 0; (modulo == NULL) && (i < PyTuple_GET_SIZE(type->tp_mro)); i++) {
+        PyTypeObject *t = (PyTypeObject *)PyTuple_GET_ITEM(type->tp_mro, i);
+        m = PyType_HasFeature(t, Py_TPFLAGS_HEAPTYPE) ? ((PyHeapTypeObject *)t)->ht_module : NULL;
+        if ((m != NULL) && (PyModule_GetDef(m) == &adc_module))
+            modulo = m;
+    }
+    if (modulo == NULL) {
+        PyErr_SetString(PyExc_TypeError, "not an ads1256.ADS1256 type");
+        return NULL;
+    }
+
+    self = (AdcObject *)type->tp_alloc(type, 0);
+    if (self == NULL)
+        return NULL;
+    Py_INCREF(modulo);
+    self->Modulo = modulo;
+
+    /* Nothing is opened here, start() brings the board up */
+    self->Dev = adcNew(transporte, (int)cs, (int)drdy, (int)dac);
+    if (self->Dev == NULL) {
+        if (errno == ENOENT)
+            PyErr_Format(PyExc_ValueError, "unknown transport '%s'", transporte);
+        else
+            PyErr_NoMemory();
+        Py_DECREF(self);
+        return NULL;
+    }
+    return (PyObject *)self;
+}
+
+static void Adc_dealloc(AdcObject *self)
+{
+    PyTypeObject *tp = Py_TYPE(self);
+    ADS1256_DEV_T *dev = self->Dev;
+
+    PyObject_GC_UnTrack(self);
+
+    /* joining the threads may take one conversion */
+    if (dev != NULL) {
+        Py_BEGIN_ALLOW_THREADS
+        adcFree(dev);
+        Py_END_ALLOW_THREADS
+    }
+    Py_CLEAR(self->Modulo);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+/* The module keeps the default board, which keeps the module: the module breaks the cycle in adc_clear */
+static int Adc_traverse(AdcObject *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->Modulo);
+    Py_VISIT(Py_TYPE(self));
+    return 0;
+}
+
+static PyObject *Adc_repr(AdcObject *self)
+{
+    const char *nome;
+    int cs, drdy;
+
+    nome = adcPins(self->Dev, &cs, &drdy);
+    return PyUnicode_FromFormat("%s(cs=%d, drdy=%d, transport='%s')", Py_TYPE(self)->tp_name, cs, drdy, nome);
+}
+
+/* Pins and transport: fixed at creation, set_transport() goes back to the pins of the new transport */
+static PyObject *Adc_get_pin(AdcObject *self, void *closure)
+{
+    int cs, drdy;
+
+    adcPins(self->Dev, &cs, &drdy);
+    return PyLong_FromLong(closure ? drdy : cs);
+}
+
+static PyObject *Adc_get_dac_cs(AdcObject *self, void *closure)
+{
+    int pino = adcDacPin(self->Dev);
+
+    if (pino < 0)
+        Py_RETURN_NONE;
+    return PyLong_FromLong(pino);
+}
+
+static PyObject *Adc_get_transport(AdcObject *self, void *closure)
+{
+    int cs, drdy;
+
+    return PyUnicode_FromString(adcPins(self->Dev, &cs, &drdy));
+}
+
+static PyGetSetDef Adc_getset[] = {
+    {"cs", (getter)Adc_get_pin, NULL, "pino do CS da placa, no numero do transporte (GPIO no bcm2835, chip 0-3 no simulador)", NULL},
+    {"drdy", (getter)Adc_get_pin, NULL, "pino do DRDY da placa", (void *)1},
+    {"dac_cs", (getter)Adc_get_dac_cs, NULL, "pino do CS do DAC8552 da placa, None se ela nao tem DAC", NULL},
+    {"transport", (getter)Adc_get_transport, NULL, "transporte da placa: 'bcm2835' ou 'sim'", NULL},
+    {NULL}
+};
+
+static PyType_Slot Adc_slots[] = {
+    {Py_tp_new, Adc_new},
+    {Py_tp_dealloc, Adc_dealloc},
+    {Py_tp_traverse, Adc_traverse},
+    {Py_tp_repr, Adc_repr},
+    {Py_tp_methods, adc_methods},
+    {Py_tp_getset, Adc_getset},
+    {Py_tp_doc, "ADS1256(cs=None, drdy=None, transport=None, dac_cs=None): uma placa AD/DA no barramento SPI, com seus pinos "
+                "de CS e DRDY e o CS do DAC8552; None usa os pinos da placa da Waveshare (ou o chip 0 do simulador)"},
+    {0, NULL}
+};
+
+static PyType_Spec Adc_spec = {
+    "ads1256.ADS1256",
+    sizeof(AdcObject),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC,
+    Adc_slots,
+};
+
+/* One ads1256.Group: boards converting in step, a frame per pass over their scan lists */
+typedef struct
+{
+    PyObject_HEAD
+    ADS1256_GROUP_T *Grupo;     /* created by the first start() */
+    PyObject *Placas;           /* tuple of ADS1256, kept alive while the group thread uses them */
+} GroupObject;
+
+static PyObject *grp_erro(PyObject *self, int err)
+{
+    AdcModuleState *st = (AdcModuleState *)PyType_GetModuleState(Py_TYPE(self));
+
+    if (err == ENODEV)
+        PyErr_SetString(st->Error, "every board of the group must be started, call start() on each first");
+    else if (err == EBUSY)
+        PyErr_SetString(PyExc_RuntimeError, "a board is already acquiring, in another group or given twice");
+    else if (err == EINVAL)
+        PyErr_SetString(PyExc_ValueError, "the boards must have the same sps and the same number of conversions per pass over their scan lists, "
+                        "and no control loop (set_control)");
+    else {
+        errno = err;
+        PyErr_SetFromErrno(PyExc_OSError);
+    }
+    return NULL;
+}
+
+static PyObject *Group_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"boards", NULL};
+    AdcModuleState *st = (AdcModuleState *)PyType_GetModuleState(type);
+    PyObject *seq, *placas;
+    GroupObject *self;
+    Py_ssize_t i, n;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &seq))
+        return NULL;
+
+    placas = PySequence_Tuple(seq);
+    if (placas == NULL)
+        return NULL;
+    n = PyTuple_GET_SIZE(placas);
+    if ((n < 1) || (n > ADS1256_GROUP_MAX)) {
+        Py_DECREF(placas);
+        PyErr_Format(PyExc_ValueError, "a group has 1 to %d boards", ADS1256_GROUP_MAX);
+        return NULL;
+    }
+    for (i = 0; i < n; i++) {
+        if (!PyObject_TypeCheck(PyTuple_GET_ITEM(placas, i), (PyTypeObject *)st->AdcType)) {
+            Py_DECREF(placas);
+            PyErr_SetString(PyExc_TypeError, "boards must be ads1256.ADS1256 objects");
+            return NULL;
+        }
+    }
+
+    self = (GroupObject *)type->tp_alloc(type, 0);
+    if (self == NULL) {
+        Py_DECREF(placas);
+        return NULL;
+    }
+    self->Placas = placas;
+    return (PyObject *)self;
+}
+
+static void Group_dealloc(GroupObject *self)
+{
+    PyTypeObject *tp = Py_TYPE(self);
+    ADS1256_GROUP_T *g = self->Grupo;
+
+    PyObject_GC_UnTrack(self);
+
+    /* the thread is joined before the boards can go away */
+    if (g != NULL) {
+        Py_BEGIN_ALLOW_THREADS
+        adcGroupFree(g);
+        Py_END_ALLOW_THREADS
+    }
+    Py_CLEAR(self->Placas);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static int Group_traverse(GroupObject *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->Placas);
+    Py_VISIT(Py_TYPE(self));
+    return 0;
+}
+
+static PyObject *Group_start(GroupObject *self, PyObject *args)
+{
+    ADS1256_DEV_T *dev[ADS1256_GROUP_MAX];
+    long int capacity = 1024, n, i;
+    int ret;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTuple(args, "|l", &capacity))
+        return NULL;
+    if ((capacity <= 0) || (capacity > 16777216)) {
+        PyErr_SetString(PyExc_ValueError, "capacity must be between 1 and 16777216 frames");
+        return NULL;
+    }
+
+    n = PyTuple_GET_SIZE(self->Placas);
+    for (i = 0; i < n; i++)
+        dev[i] = ((AdcObject *)PyTuple_GET_ITEM(self->Placas, i))->Dev;
+
+    /* execute the code, the boards may be busy on the bus */
+    Py_BEGIN_ALLOW_THREADS
+    ret = adcGroupStart(&self->Grupo, dev, n, capacity);
+    Py_END_ALLOW_THREADS
+
+    if (ret != 0)
+        return grp_erro((PyObject *)self, ret);
+    Py_RETURN_NONE;
+}
+
+static PyObject *Group_stop(GroupObject *self, PyObject *args)
+{
+    ADS1256_GROUP_T *g = self->Grupo;
+
+    /* execute the code, joining the thread may take one conversion */
+    if (g != NULL) {
+        Py_BEGIN_ALLOW_THREADS
+        adcGroupStop(g);
+        Py_END_ALLOW_THREADS
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *Group_available(GroupObject *self, PyObject *args)
+{
+    return PyLong_FromLong(self->Grupo ? groupAvailable(self->Grupo) : 0);
+}
+
+/* Frames as a list of (t, [values]), t = DRDY time of the first value in seconds */
+static PyObject *Group_read(GroupObject *self, PyObject *args)
+{
+    long int max = 0, n, w, i, j;
+    int32_t *v;
+    int64_t *t;
+    PyObject *ret, *valores, *quadro;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTuple(args, "|l", &max))
+        return NULL;
+
+    if (self->Grupo == NULL)
+        return PyList_New(0);
+    n = groupAvailable(self->Grupo);
+    if ((max > 0) && (n > max))
+        n = max;
+    w = groupWidth(self->Grupo);
+
+    v = PyMem_New(int32_t, n * w + 1);
+    t = PyMem_New(int64_t, n * w + 1);
+    if ((v == NULL) || (t == NULL)) {
+        PyMem_Free(v);
+        PyMem_Free(t);
+        return PyErr_NoMemory();
+    }
+
+    /* execute the code */
+    n = groupRead(self->Grupo, v, t, n, 1);
+
+    /* Build the output list */
+    ret = PyList_New(n);
+    for (i = 0; (ret != NULL) && (i < n); i++) {
+        valores = PyList_New(w);
+        if (valores == NULL) {
+            Py_CLEAR(ret);
+            break;
+        }
+        for (j = 0; j < w; j++)
+            PyList_SET_ITEM(valores, j, PyLong_FromLong(v[i * w + j]));
+        quadro = Py_BuildValue("(dN)", t[i * w] / 1e9, valores);
+        if (quadro == NULL) {
+            Py_CLEAR(ret);
+            break;
+        }
+        PyList_SET_ITEM(ret, i, quadro);
+    }
+
+    PyMem_Free(v);
+    PyMem_Free(t);
+    return ret;
+}
+
+/* Frames straight into a buffer, as read_block() of a board */
+static PyObject *Group_read_block(GroupObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"out", "times", NULL};
+    PyObject *out, *times = Py_None;
+    Py_buffer view, tview;
+    long int cap, w, ret = 0;
+    char kind;
+
+    /* Parse the input tuple */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O", kwlist, &out, &times))
+        return NULL;
+
+    /* bytearray, array.array('i') or a numpy int32 array, written in place */
+    if (PyObject_GetBuffer(out, &view, PyBUF_WRITABLE | PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) != 0)
+        return NULL;
+
+    kind = view.format ? view.format[strlen(view.format) - 1] : 'B';
+    if (!((view.itemsize == 1) || ((view.itemsize == 4) && ((kind == 'i') || (kind == 'l'))))) {
+        PyBuffer_Release(&view);
+        PyErr_SetString(PyExc_TypeError, "buffer must hold int32 items or raw bytes");
+        return NULL;
+    }
+    cap = (long)(view.len / sizeof(int32_t));
+
+    /* optional timestamps: bytearray or array/numpy of int64, one per value */
+    tview.buf = NULL;
+    if (times != Py_None) {
+        if (PyObject_GetBuffer(times, &tview, PyBUF_WRITABLE | PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) != 0) {
+            PyBuffer_Release(&view);
+            return NULL;
+        }
+        kind = tview.format ? tview.format[strlen(tview.format) - 1] : 'B';
+        if (!((tview.itemsize == 1) || ((tview.itemsize == 8) && ((kind == 'q') || (kind == 'l'))))) {
+            PyBuffer_Release(&tview);
+            PyBuffer_Release(&view);
+            PyErr_SetString(PyExc_TypeError, "times buffer must hold int64 items or raw bytes");
+            return NULL;
+        }
+        if ((long)(tview.len / sizeof(int64_t)) < cap)
+            cap = (long)(tview.len / sizeof(int64_t));
+    }
+
+    /* execute the code: as many whole frames as fit */
+    w = self->Grupo ? groupWidth(self->Grupo) : 0;
+    if (w > 0)
+        ret = groupRead(self->Grupo, (int32_t *)view.buf, (int64_t *)tview.buf, cap / w, 1);
+
+    if (tview.buf != NULL)
+        PyBuffer_Release(&tview);
+    PyBuffer_Release(&view);
+
+    return PyLong_FromLong(ret);
+}
+
+static PyObject *Group_stats(GroupObject *self, PyObject *args)
+{
+    long int v[4] = {0, 0, 0, 0};
+
+    if (self->Grupo != NULL)
+        groupStats(self->Grupo, v);
+
+    return Py_BuildValue("{s:l,s:l,s:l,s:d}", "frames", v[0], "dropped", v[1], "restarts", v[2],
+                         "max_skew_us", v[3] / 1e3);
+}
+
+static PyObject *Group_enter(PyObject *self, PyObject *args)
+{
+    Py_INCREF(self);
+    return self;
+}
+
+/* with ads1256.Group(...) as g: stops the group at the end, the boards stay started */
+static PyObject *Group_exit(GroupObject *self, PyObject *args)
+{
+    PyObject *ret = Group_stop(self, NULL);
+
+    Py_XDECREF(ret);
+    if (ret == NULL)
+        return NULL;
+    Py_RETURN_FALSE;
+}
+
+static PyObject *Group_get_width(GroupObject *self, void *closure)
+{
+    return PyLong_FromLong(self->Grupo ? groupWidth(self->Grupo) : 0);
+}
+
+static PyObject *Group_get_boards(GroupObject *self, void *closure)
+{
+    Py_INCREF(self->Placas);
+    return self->Placas;
+}
+
+static PyMethodDef Group_methods[] = {
+    {"start", (PyCFunction)Group_start, METH_VARARGS, {"tira as placas (ja com start) da aquisicao propria e inicia a thread do grupo, com um buffer de capacity quadros"}},
+    {"stop", (PyCFunction)Group_stop, METH_NOARGS, {"para a thread do grupo; os quadros que sobraram ainda podem ser lidos"}},
+    {"available", (PyCFunction)Group_available, METH_NOARGS, {"quadros prontos no buffer"}},
+    {"read", (PyCFunction)Group_read, METH_VARARGS, {"retira ate max quadros (0 = todos) como [(t, [valores]), ...]: a placa 0 inteira, depois a placa 1..."}},
+    {"read_block", (PyCFunction)Group_read_block, METH_VARARGS | METH_KEYWORDS, {"retira quadros inteiros para um buffer int32 (quadros x width) ja alocado, e opcionalmente os tempos em int64 ns; devolve quantos"}},
+    {"stats", (PyCFunction)Group_stats, METH_NOARGS, {"quadros, perdidos com o buffer cheio, reinicios por DRDY parado e a maior defasagem entre os DRDY das placas em us"}},
+    {"__enter__", Group_enter, METH_NOARGS, NULL},
+    {"__exit__", (PyCFunction)Group_exit, METH_VARARGS, NULL},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef Group_getset[] = {
+    {"width", (getter)Group_get_width, NULL, "valores por quadro: placas x conversoes por passada (0 antes do start)", NULL},
+    {"boards", (getter)Group_get_boards, NULL, "as placas do grupo, na ordem dos quadros", NULL},
+    {NULL}
+};
+
+static PyType_Slot Group_slots[] = {
+    {Py_tp_new, Group_new},
+    {Py_tp_dealloc, Group_dealloc},
+    {Py_tp_traverse, Group_traverse},
+    {Py_tp_methods, Group_methods},
+    {Py_tp_getset, Group_getset},
+    {Py_tp_doc, "Group(boards): placas ADS1256 convertendo juntas (SYNC/WAKEUP para todas); cada quadro e "
+                "uma passada pelas listas de varredura de todas as placas"},
+    {0, NULL}
+};
+
+static PyType_Spec Group_spec = {
+    "ads1256.Group",
+    sizeof(GroupObject),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    Group_slots,
+};
+
+/* Add obj to the module, keeping the reference of the caller */
+static int adc_add(PyObject *m, const char *nome, PyObject *obj)
+{
+    Py_INCREF(obj);
+    if (PyModule_AddObject(m, nome, obj) < 0) {
+        Py_DECREF(obj);
+        return -1;
+    }
+    return 0;
+}
+
+/* Initialize the module (Py_mod_exec, once per import) */
+static int adc_exec(PyObject *m)
+{
+    AdcModuleState *st = (AdcModuleState *)PyModule_GetState(m);
+    PyMethodDef *def;
+    PyObject *nome, *f;
+
+    if ((PyModule_AddIntConstant(m, "AINCOM", 8) < 0) || (PyModule_AddIntConstant(m, "GAIN_AUTO", -1) < 0))
+        return -1;
+
+    st->Error = PyErr_NewException("ads1256.Error", PyExc_RuntimeError, NULL);
+    if ((st->Error == NULL) || (adc_add(m, "Error", st->Error) < 0))
+        return -1;
+    st->TimeoutError = PyErr_NewException("ads1256.TimeoutError", st->Error, NULL);
+    if ((st->TimeoutError == NULL) || (adc_add(m, "TimeoutError", st->TimeoutError) < 0))
+        return -1;
+    st->DeviceError = PyErr_NewException("ads1256.DeviceError", st->Error, NULL);
+    if ((st->DeviceError == NULL) || (adc_add(m, "DeviceError", st->DeviceError) < 0))
+        return -1;
+
+    st->AdcType = PyType_FromModuleAndSpec(m, &Adc_spec, NULL);
+    if ((st->AdcType == NULL) || (adc_add(m, "ADS1256", st->AdcType) < 0))
+        return -1;
+    st->GroupType = PyType_FromModuleAndSpec(m, &Group_spec, NULL);
+    if ((st->GroupType == NULL) || (adc_add(m, "Group", st->GroupType) < 0))
+        return -1;
+
+    /* The methods of ADS1256 as module functions, on the default board */
+    nome = PyModule_GetNameObject(m);
+    if (nome == NULL)
+        return -1;
+    for (def = adc_methods; def->ml_name != NULL; def++) {
+        if (def->ml_name[0] == '_')
+            continue;
+        f = PyCFunction_NewEx(def, m, nome);
+        if ((f == NULL) || (PyModule_AddObject(m, def->ml_name, f) < 0)) {
+            Py_XDECREF(f);
+            Py_DECREF(nome);
+            return -1;
+        }
+    }
+    Py_DECREF(nome);
+
+    if ((PyType_Ready(&CaptureType) < 0) || (adc_add(m, "Capture", (PyObject *)&CaptureType) < 0))
+        return -1;
+    return 0;
+}
+
+static int adc_traverse(PyObject *m, visitproc visit, void *arg)
+{
+    AdcModuleState *st = (AdcModuleState *)PyModule_GetState(m);
+
+    Py_VISIT(st->Error);
+    Py_VISIT(st->TimeoutError);
+    Py_VISIT(st->DeviceError);
+    Py_VISIT(st->AdcType);
+    Py_VISIT(st->GroupType);
+    Py_VISIT(st->Default);
+    return 0;
+}
+
+static int adc_clear(PyObject *m)
+{
+    AdcModuleState *st = (AdcModuleState *)PyModule_GetState(m);
+
+    Py_CLEAR(st->Default);
+    Py_CLEAR(st->GroupType);
+    Py_CLEAR(st->AdcType);
+    Py_CLEAR(st->DeviceError);
+    Py_CLEAR(st->TimeoutError);
+    Py_CLEAR(st->Error);
+    return 0;
+}
+
+static void adc_free(void *m)
+{
+    adc_clear((PyObject *)m);
+}
+
+static PyModuleDef_Slot adc_module_slots[] = {
+    {Py_mod_exec, adc_exec},
+    {0, NULL}
+};
+
+static struct PyModuleDef adc_module = {
+    PyModuleDef_HEAD_INIT,
+    "ads1256",
+    module_docstring,
+    sizeof(AdcModuleState),
+    module_methods,
+    adc_module_slots,
+    adc_traverse,
+    adc_clear,
+    adc_free,
+};
+
+PyMODINIT_FUNC PyInit_ads1256(void)
+{
+    return PyModuleDef_Init(&adc_module);
+}
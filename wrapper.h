@@ -1,4 +1,115 @@
-long int  readChannels(long int *);
-long int  readChannel(long int);
-int       adcStart(int argc, char*, char*, char *);
-int       adcStop(void);
+#ifndef WRAPPER_H
+#define WRAPPER_H
+
+#include <stdint.h>
+
+#define ADS1256_SCAN_MAX    16    /* entries in a scan list */
+#define ADS1256_SLOT_MAX    (ADS1256_SCAN_MAX * 255)    /* conversions in one pass over a scan list */
+
+/* One conversion delivered by the acquisition thread */
+typedef struct
+{
+    int64_t  TimeNs;      /* DRDY falling edge, CLOCK_MONOTONIC_RAW nanoseconds */
+    int32_t  Value;       /* signed 24 bit result */
+    uint8_t  Channel;     /* input the result belongs to */
+} ADS1256_SAMPLE_T;
+
+/* One trigger window in the acquisition ring: Count samples, the first Pre of them before the trigger */
+typedef struct
+{
+    int64_t  TimeNs;      /* DRDY time of the trigger sample */
+    uint32_t Pre;
+    uint32_t Count;
+} ADS1256_WINDOW_T;
+
+/* One board with its own CS and DRDY pins; the functions below act on the one they are given */
+typedef struct ADS1256_DEV ADS1256_DEV_T;
+
+ADS1256_DEV_T *adcNew(const char *, int, int, int);
+void      adcFree(ADS1256_DEV_T *);
+const char *adcPins(ADS1256_DEV_T *, int *, int *);
+int       adcDacPin(ADS1256_DEV_T *);
+
+/* DAC8552 of the board: single writes, or frames played from a thread at a fixed rate */
+#define ADS1256_DAC_A        1
+#define ADS1256_DAC_B        2
+#define ADS1256_DAC_AB       3    /* frames of two codes, A then B, the outputs change together */
+#define ADS1256_DAC_RATE_MAX 100000    /* frames per second */
+
+/* Control loop run by the acquisition thread on one scan list entry, output on the DAC */
+#define ADS1256_CONTROL_ORDER_MAX   8
+
+typedef struct
+{
+    double Kp, Ki, Kd;    /* PID: DAC codes per count of error; Ki per second, Kd in seconds */
+    double B[ADS1256_CONTROL_ORDER_MAX + 1];    /* Coefficient filter on the error: b0..bN ... */
+    double A[ADS1256_CONTROL_ORDER_MAX + 1];    /* ... and on the past outputs: a1..aN in A[1..], a0 = 1 */
+    uint8_t NB, NA;       /* Coefficients given in B, and in A from A[1] */
+    double Bias;          /* Output with no error, codes */
+    double OutMin, OutMax;    /* Output limits, codes, within 0 and 65535 */
+} ADS1256_CONTROL_PARAM_T;
+
+int       dacWrite(ADS1256_DEV_T *, long int, long int);
+int       dacSetVref(ADS1256_DEV_T *, double);
+int       dacVolts(ADS1256_DEV_T *, double, long int *);
+int       dacPlay(ADS1256_DEV_T *, const uint16_t *, long int, int, double, int);
+int       dacQueue(ADS1256_DEV_T *, const uint16_t *, long int, int);
+int       dacStop(ADS1256_DEV_T *);
+void      dacStats(ADS1256_DEV_T *, long int *);
+int       adcSetControl(ADS1256_DEV_T *, long int, int, int, long int, const ADS1256_CONTROL_PARAM_T *);
+int       controlSetpoint(ADS1256_DEV_T *, long int);
+int       controlTune(ADS1256_DEV_T *, const ADS1256_CONTROL_PARAM_T *);
+int       controlParam(ADS1256_DEV_T *, ADS1256_CONTROL_PARAM_T *, long int *);
+void      controlStats(ADS1256_DEV_T *, long int *);
+
+/* Boards converting in step: one thread restarts all of them together and assembles one frame
+   per pass over their scan lists */
+#define ADS1256_GROUP_MAX   8
+typedef struct ADS1256_GROUP ADS1256_GROUP_T;
+
+int       adcGroupStart(ADS1256_GROUP_T **, ADS1256_DEV_T **, long int, long int);
+int       adcGroupStop(ADS1256_GROUP_T *);
+void      adcGroupFree(ADS1256_GROUP_T *);
+long int  groupWidth(ADS1256_GROUP_T *);
+long int  groupAvailable(ADS1256_GROUP_T *);
+long int  groupRead(ADS1256_GROUP_T *, int32_t *, int64_t *, long int, int);
+void      groupStats(ADS1256_GROUP_T *, long int *);
+
+long int  readChannels(ADS1256_DEV_T *, long int *, int64_t *);
+int       readChannel(ADS1256_DEV_T *, long int, long int *);
+long int  readBlock(ADS1256_DEV_T *, int32_t *, int64_t *, long int, long int);
+int       adcStart(ADS1256_DEV_T *, long int, long int, long int, int, long int, long int);
+int       adcStop(ADS1256_DEV_T *);
+int       adcConfigure(ADS1256_DEV_T *, long int, long int, int);
+int       adcStartContinuous(ADS1256_DEV_T *, long int);
+long int  readContinuous(ADS1256_DEV_T *, long int *, long int);
+int       adcStopContinuous(ADS1256_DEV_T *);
+int       adcAcqStart(ADS1256_DEV_T *, long int);
+int       adcAcqStop(ADS1256_DEV_T *);
+long int  acqAvailable(ADS1256_DEV_T *);
+long int  acqRead(ADS1256_DEV_T *, ADS1256_SAMPLE_T *, long int, int);
+long int  acqDropped(ADS1256_DEV_T *);
+int       adcSetDrdyWait(ADS1256_DEV_T *, int, long int, const char *);
+int       adcSetTransport(ADS1256_DEV_T *, const char *);
+int       adcGetTiming(ADS1256_DEV_T *, long int *);
+int       adcGetStats(ADS1256_DEV_T *, long int *, int);
+int       adcSetScanList(ADS1256_DEV_T *, const long int *, long int);
+long int  scanCount(ADS1256_DEV_T *);
+long int  adcGains(ADS1256_DEV_T *, long int *);
+int       adcSetFilter(ADS1256_DEV_T *, long int, int, long int, long int, const double *);
+int       adcSetVref(ADS1256_DEV_T *, double);
+int       adcCalibrate(ADS1256_DEV_T *, long int, long int, long int *);
+int       adcReadCal(ADS1256_DEV_T *, long int *);
+int       adcSetCalCache(ADS1256_DEV_T *, const char *);
+long int  voltScales(ADS1256_DEV_T *, double *, long int);
+int64_t   adcClock(void);
+int       adcLogStart(ADS1256_DEV_T *, const char *, long int, long int, int, long int, long int);
+int       adcLogStop(ADS1256_DEV_T *);
+int       logStats(ADS1256_DEV_T *, long int *);
+int       adcSetTrigger(ADS1256_DEV_T *, long int, int, int, long int, long int, long int, long int, int);
+int       adcTriggerArm(ADS1256_DEV_T *);
+long int  trigPending(ADS1256_DEV_T *, ADS1256_WINDOW_T *);
+long int  trigRead(ADS1256_DEV_T *, ADS1256_WINDOW_T *, ADS1256_SAMPLE_T *, long int);
+void      trigStats(ADS1256_DEV_T *, long int *);
+
+#endif